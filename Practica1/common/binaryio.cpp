@@ -6,24 +6,22 @@
 #include <cstdint>
 #include <stdexcept>
 #include <cstring> // Para usar std::memcpy
+#include <algorithm>
 
 std::vector<uint8_t> BinaryIO::readBinaryFile(const std::string& filePath) {
-    std::ifstream file(filePath, std::ios::binary);
+    std::ifstream file(filePath, std::ios::binary | std::ios::ate);
     if (!file) {
         throw std::runtime_error("Error: No se puede abrir el archivo para lectura: " + filePath);
     }
 
-    file.seekg(0, std::ios::end);
+    // El archivo se abre posicionado al final para conocer su tamaño y se lee de una vez
     const auto fileSize = static_cast<std::vector<uint8_t>::size_type>(file.tellg());
     file.seekg(0, std::ios::beg);
 
     std::vector<uint8_t> buffer(fileSize);
-    for (std::vector<uint8_t>::size_type i = 0; i < fileSize; ++i) {
-        int const byte = file.get();
-        if (byte == EOF) {
-            throw std::runtime_error("Error: No se pudo leer el archivo completo: " + filePath);
-        }
-        buffer[i] = static_cast<uint8_t>(byte);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(fileSize))) {
+        throw std::runtime_error("Error: No se pudo leer el archivo completo: " + filePath);
     }
 
     return buffer;
@@ -35,11 +33,9 @@ void BinaryIO::writeBinaryFile(const std::string& filePath, const std::vector<ui
         throw std::runtime_error("Error: No se puede abrir el archivo para escritura: " + filePath);
     }
 
-    for (auto byte : data) {
-        file.put(static_cast<char>(byte));
-        if (file.fail()) {
-            throw std::runtime_error("Error: No se pudo escribir el archivo completo: " + filePath);
-        }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()))) {
+        throw std::runtime_error("Error: No se pudo escribir el archivo completo: " + filePath);
     }
 }
 
@@ -78,3 +74,98 @@ void BinaryIO::writeValue(std::ostream& output, const double& value) {
         throw std::runtime_error("Error: No se pudo escribir el valor double.");
     }
 }
+
+
+BinaryReader::BinaryReader(std::istream& input, const std::size_t bufferSize)
+    : input(input), buffer(std::max<std::size_t>(bufferSize, sizeof(std::uintmax_t))) {}
+
+void BinaryReader::refill() {
+    std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(position),
+              buffer.begin() + static_cast<std::ptrdiff_t>(available), buffer.begin());
+    available -= position;
+    position = 0;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    input.read(reinterpret_cast<char *>(std::span(buffer).subspan(available).data()), static_cast<std::streamsize>(buffer.size() - available));
+    available += static_cast<std::size_t>(input.gcount());
+}
+
+std::span<const uint8_t> BinaryReader::take(const std::size_t count) {
+    if (available - position < count) {
+        refill();
+        if (available - position < count) {
+            throw std::runtime_error("Error: No se pudo leer el valor.");
+        }
+    }
+    const std::span<const uint8_t> bytes = std::span(buffer).subspan(position, count);
+    position += count;
+    return bytes;
+}
+
+void BinaryReader::read(std::span<uint8_t> destination) {
+    // Primero lo que ya está en el búfer
+    const std::size_t desdeBufer = std::min(destination.size(), available - position);
+    std::copy_n(buffer.begin() + static_cast<std::ptrdiff_t>(position), desdeBufer, destination.begin());
+    position += desdeBufer;
+    std::span<uint8_t> resto = destination.subspan(desdeBufer);
+    if (resto.empty()) {
+        return;
+    }
+
+    // Un resto grande va directo al destino; uno pequeño pasa por el búfer
+    if (resto.size() >= buffer.size()) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (!input.read(reinterpret_cast<char *>(resto.data()), static_cast<std::streamsize>(resto.size()))) {
+            throw std::runtime_error("Error: No se pudo leer el bloque.");
+        }
+        return;
+    }
+    const std::span<const uint8_t> bytes = take(resto.size());
+    std::copy(bytes.begin(), bytes.end(), resto.begin());
+}
+
+bool BinaryReader::atEnd() {
+    if (position == available) {
+        refill();
+    }
+    return position == available;
+}
+
+BinaryWriter::BinaryWriter(std::ostream& output, const std::size_t bufferSize)
+    : output(output), buffer(std::max<std::size_t>(bufferSize, sizeof(std::uintmax_t))) {}
+
+std::span<uint8_t> BinaryWriter::append(const std::size_t count) {
+    if (buffer.size() - used < count) {
+        flush();
+        if (buffer.size() < count) {
+            buffer.resize(count);
+        }
+    }
+    const std::span<uint8_t> bytes = std::span(buffer).subspan(used, count);
+    used += count;
+    return bytes;
+}
+
+void BinaryWriter::write(std::span<const uint8_t> data) {
+    if (data.size() >= buffer.size()) {
+        flush();
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (!output.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()))) {
+            throw std::runtime_error("Error: No se pudo escribir el bloque.");
+        }
+        return;
+    }
+    const std::span<uint8_t> destino = append(data.size());
+    std::copy(data.begin(), data.end(), destino.begin());
+}
+
+void BinaryWriter::flush() {
+    if (used == 0) {
+        return;
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!output.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(used))) {
+        throw std::runtime_error("Error: No se pudo escribir el bloque.");
+    }
+    used = 0;
+}
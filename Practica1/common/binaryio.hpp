@@ -1,34 +1,40 @@
 #ifndef PRACTICA1_BINARYIO_HPP
 #define PRACTICA1_BINARYIO_HPP
 
+#include <array>
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <istream>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 #include <type_traits> // Para std::enable_if y std::is_integral
 
+// Tamaño por defecto del búfer interno de BinaryReader y BinaryWriter
+constexpr std::size_t BINARY_BUFFER_SIZE = static_cast<std::size_t>(1) << 20;
+
 // Clase BinaryIO para operaciones de E/S en binario
 class BinaryIO {
 public:
-    // Lee un archivo binario y devuelve el contenido en un vector de bytes
+    // Lee un archivo binario completo con una sola lectura del tamaño del archivo
     static std::vector<uint8_t> readBinaryFile(const std::string& filePath);
 
-    // Escribe el contenido de un vector de bytes en un archivo binario
+    // Escribe el contenido de un vector de bytes en un archivo binario con una sola escritura
     static void writeBinaryFile(const std::string& filePath, const std::vector<uint8_t>& data);
 
     // Lee un valor de tipo T desde un flujo binario (solo para tipos enteros)
     template <typename T>
     static T
     readValue(std::istream& input) requires std::is_integral_v<T> {
-        T value = 0;
-        std::vector<char> buffer(sizeof(T));
+        std::array<char, sizeof(T)> buffer{};
         if (!input.read(buffer.data(), sizeof(T))) {
             throw std::runtime_error("Error: No se pudo leer el valor.");
         }
 
         // Copiar bytes a `value` usando desplazamiento de bits
+        T value = 0;
         for (size_t i = 0; i < sizeof(T); ++i) {
             constexpr int BYTE_SHIFT = 8;
             value |= static_cast<T>(static_cast<unsigned char>(buffer[i])) << (BYTE_SHIFT * i);
@@ -41,7 +47,7 @@ public:
     template <typename T>
     static void
     writeValue(std::ostream& output, const T& value) requires std::is_integral_v<T> {
-        std::vector<char> buffer(sizeof(T));
+        std::array<char, sizeof(T)> buffer{};
         constexpr uint8_t BYTE_MASK = 0xFF;
         for (size_t i = 0; i < sizeof(T); ++i) {
             constexpr int BYTE_SHIFT = 8;
@@ -64,4 +70,98 @@ public:
     static void writeValue(std::ostream& output, const double& value);
 };
 
+// Lector binario con búfer propio: el flujo se lee por bloques grandes y los valores se
+// decodifican desde el búfer sin reservar memoria por lectura.
+class BinaryReader {
+public:
+    explicit BinaryReader(std::istream& input, std::size_t bufferSize = BINARY_BUFFER_SIZE);
+
+    // Entero almacenado con el byte menos significativo primero
+    template <typename T>
+    T readLE() requires std::is_integral_v<T> {
+        const std::span<const uint8_t> bytes = take(sizeof(T));
+        std::make_unsigned_t<T> value = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            value = static_cast<std::make_unsigned_t<T>>(value | (static_cast<std::make_unsigned_t<T>>(bytes[i]) << (BYTE_SHIFT * i)));
+        }
+        return static_cast<T>(value);
+    }
+
+    // Entero almacenado con el byte más significativo primero
+    template <typename T>
+    T readBE() requires std::is_integral_v<T> {
+        const std::span<const uint8_t> bytes = take(sizeof(T));
+        std::make_unsigned_t<T> value = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            value = static_cast<std::make_unsigned_t<T>>((static_cast<std::make_unsigned_t<T>>(value) << BYTE_SHIFT) | bytes[i]);
+        }
+        return static_cast<T>(value);
+    }
+
+    // Llena `destination` por completo; los bloques grandes se leen directamente del flujo
+    void read(std::span<uint8_t> destination);
+
+    // Indica si no quedan bytes ni en el búfer ni en el flujo
+    [[nodiscard]] bool atEnd();
+
+private:
+    static constexpr int BYTE_SHIFT = 8;
+
+    // Devuelve los siguientes `count` bytes contiguos del búfer, rellenándolo si hace falta
+    std::span<const uint8_t> take(std::size_t count);
+
+    // Mueve lo pendiente al principio del búfer y lo completa desde el flujo
+    void refill();
+
+    std::istream& input;
+    std::vector<uint8_t> buffer;
+    std::size_t position = 0;
+    std::size_t available = 0;
+};
+
+// Escritor binario con búfer propio: los valores se acumulan y se escriben por bloques
+// grandes. Lo pendiente se escribe con flush(), que el llamante debe invocar al terminar;
+// el destructor no lo hace para no ocultar errores de escritura.
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::ostream& output, std::size_t bufferSize = BINARY_BUFFER_SIZE);
+
+    // Entero con el byte menos significativo primero
+    template <typename T>
+    void writeLE(const T value) requires std::is_integral_v<T> {
+        const std::span<uint8_t> bytes = append(sizeof(T));
+        const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<uint8_t>(bits >> (BYTE_SHIFT * i));
+        }
+    }
+
+    // Entero con el byte más significativo primero
+    template <typename T>
+    void writeBE(const T value) requires std::is_integral_v<T> {
+        const std::span<uint8_t> bytes = append(sizeof(T));
+        const auto bits = static_cast<std::make_unsigned_t<T>>(value);
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            bytes[i] = static_cast<uint8_t>(bits >> (BYTE_SHIFT * (sizeof(T) - 1 - i)));
+        }
+    }
+
+    // Copia un bloque de bytes; los bloques grandes se escriben sin pasar por el búfer
+    void write(std::span<const uint8_t> data);
+
+    // Reserva `count` bytes contiguos al final del búfer para que el llamante los rellene
+    // directamente antes de la siguiente llamada al escritor
+    std::span<uint8_t> append(std::size_t count);
+
+    // Escribe en el flujo todo lo acumulado
+    void flush();
+
+private:
+    static constexpr int BYTE_SHIFT = 8;
+
+    std::ostream& output;
+    std::vector<uint8_t> buffer;
+    std::size_t used = 0;
+};
+
 #endif // PRACTICA1_BINARYIO_HPP
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "bitpack.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr unsigned BYTE_BITS = 8;
+    constexpr unsigned WORD_BITS = 64;
+
+    uint64_t mascaraBits(const unsigned bits) {
+        return bits >= WORD_BITS ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    }
+
+    // Un grupo con un acumulador de 64 bits: entra un índice y salen los bytes completos
+    void empaquetarGrupo(const uint32_t *indices, const unsigned bits, uint8_t *out) {
+        uint64_t acumulado = 0;
+        unsigned pendientes = 0;
+        for (std::size_t j = 0; j < PACK_GROUP; ++j) {
+            acumulado |= static_cast<uint64_t>(indices[j]) << pendientes;
+            pendientes += bits;
+            while (pendientes >= BYTE_BITS) {
+                *out++ = static_cast<uint8_t>(acumulado);
+                acumulado >>= BYTE_BITS;
+                pendientes -= BYTE_BITS;
+            }
+        }
+    }
+
+    void desempaquetarGrupo(const uint8_t *packed, const unsigned bits, uint32_t *indices) {
+        const uint64_t mascara = mascaraBits(bits);
+        uint64_t acumulado = 0;
+        unsigned disponibles = 0;
+        for (std::size_t j = 0; j < PACK_GROUP; ++j) {
+            while (disponibles < bits) {
+                acumulado |= static_cast<uint64_t>(*packed++) << disponibles;
+                disponibles += BYTE_BITS;
+            }
+            indices[j] = static_cast<uint32_t>(acumulado & mascara);
+            acumulado >>= bits;
+            disponibles -= bits;
+        }
+    }
+
+#if defined(__SSE2__)
+    constexpr unsigned MAX_SIMD_BITS = 16;
+    constexpr int HALF_REGISTER_BYTES = 8;
+    constexpr int LANE_BITS = 32;
+
+    // Cuatro índices de 32 bits -> un valor de 4 * bits bits en dos pasos de desplazamiento
+    // uniforme: primero se juntan los pares de cada carril de 64 bits (i0 | i1 << bits) y
+    // después los dos carriles (c0 | c1 << 2 * bits)
+    uint64_t juntarCuatro(__m128i valores, const __m128i cuenta, const __m128i cuentaDoble) {
+        const __m128i bajos = _mm_set1_epi64x(static_cast<long long>(mascaraBits(LANE_BITS)));
+        valores = _mm_or_si128(_mm_and_si128(valores, bajos), _mm_sll_epi64(_mm_srli_epi64(valores, LANE_BITS), cuenta));
+        valores = _mm_or_si128(valores, _mm_sll_epi64(_mm_srli_si128(valores, HALF_REGISTER_BYTES), cuentaDoble));
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(valores));
+    }
+
+    // Inverso de juntarCuatro: separa los dos carriles y, en cada uno, los dos índices
+    __m128i separarCuatro(const uint64_t valor, const unsigned bits, const __m128i cuenta) {
+        const __m128i mascara = _mm_set1_epi64x(static_cast<long long>(mascaraBits(bits)));
+        const __m128i carriles = _mm_set_epi64x(static_cast<long long>(valor >> (2 * bits)),
+                                                static_cast<long long>(valor & mascaraBits(2 * bits)));
+        const __m128i pares = _mm_and_si128(carriles, mascara);
+        const __m128i impares = _mm_and_si128(_mm_srl_epi64(carriles, cuenta), mascara);
+        return _mm_or_si128(pares, _mm_slli_epi64(impares, LANE_BITS));
+    }
+#endif
+}
+
+unsigned packedIndexBits(const std::size_t colors) {
+    return std::max(1U, static_cast<unsigned>(std::bit_width(std::max<std::size_t>(colors, 1) - 1)));
+}
+
+std::size_t packedSize(const std::size_t count, const unsigned bits) {
+    return (count + PACK_GROUP - 1) / PACK_GROUP * bits;
+}
+
+// Con SSE2 los ocho índices del grupo se reducen a dos valores de 4 * bits bits, que juntos
+// son los `bits` bytes del grupo (el host es little-endian, así que se copian tal cual)
+void packIndices(const std::span<const uint32_t> indices, const unsigned bits, const std::span<uint8_t> out) {
+    const std::size_t grupos = indices.size() / PACK_GROUP;
+#if defined(__SSE2__)
+    if (bits <= MAX_SIMD_BITS) {
+        const __m128i cuenta = _mm_cvtsi32_si128(static_cast<int>(bits));
+        const __m128i cuentaDoble = _mm_cvtsi32_si128(static_cast<int>(2 * bits));
+        const unsigned mitad = 4 * bits;
+        for (std::size_t grupo = 0; grupo < grupos; ++grupo) {
+            const uint32_t *origen = &indices[grupo * PACK_GROUP];
+            const uint64_t primero = juntarCuatro(_mm_loadu_si128(reinterpret_cast<const __m128i *>(origen)), cuenta, cuentaDoble);
+            const uint64_t segundo = juntarCuatro(_mm_loadu_si128(reinterpret_cast<const __m128i *>(origen + 4)), cuenta, cuentaDoble);
+            const uint64_t bajo = mitad == WORD_BITS ? primero : primero | (segundo << mitad);
+            const uint64_t alto = mitad == WORD_BITS ? segundo : segundo >> (WORD_BITS - mitad);
+            uint8_t *destino = &out[grupo * bits];
+            const std::size_t bytesBajo = std::min<std::size_t>(bits, sizeof(bajo));
+            std::memcpy(destino, &bajo, bytesBajo);
+            std::memcpy(destino + bytesBajo, &alto, bits - bytesBajo);
+        }
+        return;
+    }
+#endif
+    for (std::size_t grupo = 0; grupo < grupos; ++grupo) {
+        empaquetarGrupo(&indices[grupo * PACK_GROUP], bits, &out[grupo * bits]);
+    }
+}
+
+void unpackIndices(const std::span<const uint8_t> packed, const unsigned bits, const std::span<uint32_t> indices) {
+    const std::size_t grupos = packed.size() / bits;
+#if defined(__SSE2__)
+    if (bits <= MAX_SIMD_BITS) {
+        const __m128i cuenta = _mm_cvtsi32_si128(static_cast<int>(bits));
+        const unsigned mitad = 4 * bits;
+        for (std::size_t grupo = 0; grupo < grupos; ++grupo) {
+            const uint8_t *origen = &packed[grupo * bits];
+            uint64_t bajo = 0;
+            uint64_t alto = 0;
+            const std::size_t bytesBajo = std::min<std::size_t>(bits, sizeof(bajo));
+            std::memcpy(&bajo, origen, bytesBajo);
+            std::memcpy(&alto, origen + bytesBajo, bits - bytesBajo);
+            const uint64_t primero = bajo & mascaraBits(mitad);
+            const uint64_t segundo = mitad == WORD_BITS ? alto : ((bajo >> mitad) | (alto << (WORD_BITS - mitad))) & mascaraBits(mitad);
+            uint32_t *destino = &indices[grupo * PACK_GROUP];
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destino), separarCuatro(primero, bits, cuenta));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(destino + 4), separarCuatro(segundo, bits, cuenta));
+        }
+        return;
+    }
+#endif
+    for (std::size_t grupo = 0; grupo < grupos; ++grupo) {
+        desempaquetarGrupo(&packed[grupo * bits], bits, &indices[grupo * PACK_GROUP]);
+    }
+}
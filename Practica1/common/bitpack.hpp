@@ -0,0 +1,29 @@
+#ifndef PRACTICA1_BITPACK_HPP
+#define PRACTICA1_BITPACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Empaquetado de índices de tabla con un número fijo de bits (1 a 32). Los índices se
+// agrupan de PACK_GROUP en PACK_GROUP: un grupo ocupa exactamente `bits` bytes, así que los
+// grupos empiezan siempre en un byte y se pueden codificar y decodificar por bloques
+// independientes. Dentro del grupo, el índice j ocupa los bits [j * bits, (j + 1) * bits)
+// del entero little-endian que forman sus bytes. Con SSE2 y hasta 16 bits por índice cada
+// grupo se combina en registros de 128 bits; en otro caso se usa un bucle escalar.
+constexpr std::size_t PACK_GROUP = 8;
+
+// Bits necesarios para `colors` índices distintos: ceil(log2(colors)), al menos 1
+[[nodiscard]] unsigned packedIndexBits(std::size_t colors);
+
+// Bytes que ocupan `count` índices empaquetados (el último grupo se completa con ceros)
+[[nodiscard]] std::size_t packedSize(std::size_t count, unsigned bits);
+
+// Empaqueta `indices` (un múltiplo de PACK_GROUP, todos menores que 2^bits) en `out`,
+// que debe tener packedSize(indices.size(), bits) bytes
+void packIndices(std::span<const uint32_t> indices, unsigned bits, std::span<uint8_t> out);
+
+// Operación inversa: desempaqueta packed.size() / bits grupos en `indices`
+void unpackIndices(std::span<const uint8_t> packed, unsigned bits, std::span<uint32_t> indices);
+
+#endif // PRACTICA1_BITPACK_HPP
@@ -0,0 +1,407 @@
+#include "cppmcompress.hpp"
+#include "parallel.hpp"
+#include "positionalwriter.hpp"
+#include "outputtarget.hpp"
+#include "planarcache.hpp"
+#include "bitpack.hpp"
+#include "indexlz.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <optional>
+#include <utility>
+
+namespace {
+    constexpr std::size_t MAX_COLORS_1_BYTE = 256;
+    constexpr std::size_t MAX_COLORS_2_BYTES = 65536;
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr unsigned BYTE_SHIFT = 8;
+    constexpr unsigned SAMPLE_SHIFT_8 = 8;
+    constexpr unsigned SAMPLE_SHIFT_16 = 16;
+    constexpr uint64_t BYTE_MASK = 0xFF;
+    constexpr std::size_t MIN_CAPACITY = 64;
+    constexpr unsigned HASH_BITS = 64;
+    constexpr uint64_t FIBONACCI_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    // Ninguna clave real ocupa más de 48 bits
+    constexpr uint64_t EMPTY_KEY = ~uint64_t{0};
+
+    void rechazarAlfa(const PPMHeader &header) {
+        if (header.channels() != 1 && header.channels() != RGB_CHANNELS) {
+            throw std::runtime_error("Formato no soportado");
+        }
+    }
+}
+
+// Capacidad potencia de dos con al menos el doble de entradas que las esperadas
+ColorIndexMap::ColorIndexMap(const std::size_t expected) {
+    std::size_t capacidad = MIN_CAPACITY;
+    while (capacidad < 2 * expected) {
+        capacidad *= 2;
+    }
+    claves.assign(capacidad, EMPTY_KEY);
+    valores.resize(capacidad);
+    mascara = capacidad - 1;
+    desplazamiento = HASH_BITS - static_cast<unsigned>(std::countr_zero(capacidad));
+}
+
+// Hash multiplicativo de Fibonacci: los bits altos del producto mezclan toda la clave
+std::size_t ColorIndexMap::posicion(const uint64_t key) const {
+    return static_cast<std::size_t>((key * FIBONACCI_MULTIPLIER) >> desplazamiento);
+}
+
+bool ColorIndexMap::insert(const uint64_t key, const uint32_t value) {
+    std::size_t pos = posicion(key);
+    while (claves[pos] != EMPTY_KEY) {
+        if (claves[pos] == key) {
+            return false;
+        }
+        pos = (pos + 1) & mascara;
+    }
+    claves[pos] = key;
+    valores[pos] = value;
+    // Se mantiene por debajo de la mitad de ocupación para que los sondeos sean cortos
+    if (2 * ++usados > claves.size()) {
+        crecer();
+    }
+    return true;
+}
+
+const uint32_t *ColorIndexMap::find(const uint64_t key) const {
+    std::size_t pos = posicion(key);
+    while (claves[pos] != EMPTY_KEY) {
+        if (claves[pos] == key) {
+            return &valores[pos];
+        }
+        pos = (pos + 1) & mascara;
+    }
+    return nullptr;
+}
+
+void ColorIndexMap::crecer() {
+    ColorIndexMap mayor(claves.size());
+    for (std::size_t pos = 0; pos < claves.size(); ++pos) {
+        if (claves[pos] != EMPTY_KEY) {
+            mayor.insert(claves[pos], valores[pos]);
+        }
+    }
+    *this = std::move(mayor);
+}
+
+uint64_t colorKey(const std::span<const uint8_t> raster, const PPMHeader &header, const std::size_t pixel) {
+    const std::size_t canales = header.channels();
+    if (header.bytesPerSample() == 1) {
+        const std::size_t pos = pixel * canales;
+        if (canales == 1) {
+            return raster[pos];
+        }
+        return (static_cast<uint64_t>(raster[pos]) << SAMPLE_SHIFT_16) | (static_cast<uint64_t>(raster[pos + 1]) << SAMPLE_SHIFT_8) |
+               raster[pos + 2];
+    }
+
+    uint64_t clave = 0;
+    const std::size_t pos = pixel * canales * 2;
+    for (std::size_t byte = 0; byte < canales * 2; ++byte) {
+        clave = (clave << BYTE_SHIFT) | raster[pos + byte];
+    }
+    return clave;
+}
+
+ColorPalette buildPalette(const std::span<const uint8_t> raster, const PPMHeader &header) {
+    const std::size_t pixeles = header.pixelCount();
+    // Colores de cada bloque en orden de primera aparición; la tabla hash del bloque se
+    // libera al terminarlo y solo se conserva la lista. Cada bloque reserva memoria, así que
+    // se reparten con parallelForEach, que relanza un bad_alloc en lugar de abortar
+    std::vector<std::vector<uint64_t>> bloques((pixeles + PARALLEL_GRAIN_PIXELS - 1) / PARALLEL_GRAIN_PIXELS);
+    parallelForEach(bloques.size(), [&](const std::size_t bloque) {
+        std::vector<uint64_t> &orden = bloques[bloque];
+        const std::size_t first = bloque * PARALLEL_GRAIN_PIXELS;
+        const std::size_t last = std::min(pixeles, first + PARALLEL_GRAIN_PIXELS);
+        ColorIndexMap vistos;
+        for (std::size_t i = first; i < last; ++i) {
+            const uint64_t clave = colorKey(raster, header, i);
+            if (vistos.insert(clave, 0)) {
+                orden.push_back(clave);
+            }
+        }
+    });
+
+    // Los bloques se combinan en orden: un color recibe su índice en el primer bloque
+    // (y en la primera posición dentro de él) en el que aparece
+    std::size_t candidatos = 0;
+    for (const std::vector<uint64_t> &orden : bloques) {
+        candidatos += orden.size();
+    }
+    ColorPalette palette{.colors = {}, .indices = ColorIndexMap(candidatos)};
+    for (std::vector<uint64_t> &orden : bloques) {
+        for (const uint64_t clave : orden) {
+            if (palette.indices.insert(clave, static_cast<uint32_t>(palette.colors.size()))) {
+                palette.colors.push_back(clave);
+            }
+        }
+        orden = std::vector<uint64_t>{};
+    }
+    return palette;
+}
+
+std::size_t cppmIndexBytes(const std::size_t colors) {
+    if (colors <= MAX_COLORS_1_BYTE) {
+        return 1;
+    }
+    return colors <= MAX_COLORS_2_BYTES ? 2 : 4;
+}
+
+std::string cppmMagic(const CPPMOptions &options) {
+    std::string magic = "C6";
+    if (options.tileSize > 0) {
+        magic += 'T';
+    }
+    if (options.packed) {
+        magic += 'P';
+    }
+    if (options.lz) {
+        magic += 'Z';
+    }
+    return magic;
+}
+
+std::string formatCPPMPrefix(const PPMHeader &header, const ColorPalette &palette, const std::string_view magic,
+                             const int layoutSize) {
+    std::string prefijo = std::string(magic) + " " + std::to_string(header.width) + " " + std::to_string(header.height) + " " +
+                          std::to_string(header.maxColorValue) + " " + std::to_string(palette.colors.size());
+    if (layoutSize > 0) {
+        prefijo += " " + std::to_string(layoutSize);
+    }
+    prefijo += "\n";
+
+    // Cada muestra de la clave se escribe con su ancho (byte a byte, el más significativo primero)
+    const std::size_t bytesMuestra = header.bytesPerSample();
+    const std::size_t bytesColor = RGB_CHANNELS * bytesMuestra;
+    const std::size_t inicio = prefijo.size();
+    prefijo.resize(inicio + (palette.colors.size() * bytesColor));
+    for (std::size_t color = 0; color < palette.colors.size(); ++color) {
+        uint64_t clave = palette.colors[color];
+        if (header.channels() == 1) {
+            // Gris: el nivel se repite en los tres canales
+            uint64_t repetida = 0;
+            for (std::size_t canal = 0; canal < RGB_CHANNELS; ++canal) {
+                repetida = (repetida << (BYTE_SHIFT * bytesMuestra)) | clave;
+            }
+            clave = repetida;
+        }
+        for (std::size_t byte = bytesColor; byte-- > 0;) {
+            prefijo[inicio + (color * bytesColor) + byte] = static_cast<char>(clave & BYTE_MASK);
+            clave >>= BYTE_SHIFT;
+        }
+    }
+    return prefijo;
+}
+
+namespace {
+    // Índices empaquetados: cada elemento es un grupo de PACK_GROUP píxeles, que ocupa
+    // `bits` bytes; los índices se buscan por tramos y se empaquetan con packIndices
+    void escribirEmpaquetado(const std::string &outputFile, const std::string &prefijo, const std::span<const uint8_t> raster,
+                             const PPMHeader &header, const ColorPalette &palette) {
+        constexpr std::size_t GRUPOS_TRAMO = 128;
+        const unsigned bits = packedIndexBits(palette.colors.size());
+        const std::size_t pixeles = header.pixelCount();
+        writeEncodedOutput(outputFile, prefijo, (pixeles + PACK_GROUP - 1) / PACK_GROUP, bits,
+                           [&](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+                               std::array<uint32_t, GRUPOS_TRAMO * PACK_GROUP> tramo{};
+                               for (std::size_t grupo = first; grupo < last; grupo += GRUPOS_TRAMO) {
+                                   const std::size_t grupos = std::min(GRUPOS_TRAMO, last - grupo);
+                                   const std::size_t inicio = grupo * PACK_GROUP;
+                                   const std::size_t fin = std::min(pixeles, (grupo + grupos) * PACK_GROUP);
+                                   // El último grupo de la imagen se completa con el índice 0
+                                   std::fill(tramo.begin(), tramo.end(), 0);
+                                   for (std::size_t i = inicio; i < fin; ++i) {
+                                       tramo[i - inicio] = *palette.indices.find(colorKey(raster, header, i));
+                                   }
+                                   packIndices(std::span(tramo).first(grupos * PACK_GROUP), bits,
+                                               out.subspan((grupo - first) * bits, grupos * bits));
+                               }
+                           });
+    }
+}
+
+namespace {
+    constexpr std::size_t OFFSET_BYTES = 8;
+
+    // Reparto en teselas: de ladoX x ladoY en mosaico, o franjas del ancho de la imagen
+    struct Teselas {
+        std::size_t ladoX;
+        std::size_t ladoY;
+        std::size_t porFila;
+        std::size_t total;
+    };
+
+    Teselas repartirTeselas(const PPMHeader &header, const std::size_t ladoX, const std::size_t ladoY) {
+        const auto ancho = static_cast<std::size_t>(header.width);
+        const auto alto = static_cast<std::size_t>(header.height);
+        const std::size_t porFila = ladoX == 0 ? 0 : (ancho + ladoX - 1) / ladoX;
+        return {.ladoX = ladoX, .ladoY = ladoY, .porFila = porFila, .total = ladoY == 0 ? 0 : porFila * ((alto + ladoY - 1) / ladoY)};
+    }
+
+    // Índices de una tesela, por filas, codificados como el archivo: bytes little-endian o
+    // empaquetados (el último grupo se completa con el índice 0), y después comprimidos con
+    // lzCompress si se ha pedido
+    std::vector<uint8_t> codificarTesela(const std::span<const uint8_t> raster, const PPMHeader &header,
+                                         const ColorPalette &palette, const CPPMOptions &options, const Teselas &reparto,
+                                         const std::size_t tesela) {
+        const auto ancho = static_cast<std::size_t>(header.width);
+        const auto alto = static_cast<std::size_t>(header.height);
+        const std::size_t x0 = (tesela % reparto.porFila) * reparto.ladoX;
+        const std::size_t y0 = (tesela / reparto.porFila) * reparto.ladoY;
+        const std::size_t anchoTesela = std::min(reparto.ladoX, ancho - x0);
+        const std::size_t altoTesela = std::min(reparto.ladoY, alto - y0);
+
+        std::vector<uint32_t> indices(anchoTesela * altoTesela);
+        for (std::size_t y = 0; y < altoTesela; ++y) {
+            for (std::size_t x = 0; x < anchoTesela; ++x) {
+                indices[(y * anchoTesela) + x] = *palette.indices.find(colorKey(raster, header, ((y0 + y) * ancho) + x0 + x));
+            }
+        }
+        std::vector<uint8_t> codificada;
+        std::size_t unidad = 0; // Bytes de un índice, o de un grupo si van empaquetados
+        std::size_t fila = 0;   // Bytes de una fila de la tesela, o 0 si no empieza en un byte
+        if (options.packed) {
+            const unsigned bits = packedIndexBits(palette.colors.size());
+            indices.resize((indices.size() + PACK_GROUP - 1) / PACK_GROUP * PACK_GROUP, 0);
+            codificada.resize(packedSize(indices.size(), bits));
+            packIndices(indices, bits, codificada);
+            unidad = bits;
+            fila = anchoTesela % PACK_GROUP == 0 ? anchoTesela / PACK_GROUP * bits : 0;
+        } else {
+            const std::size_t bytesIndice = cppmIndexBytes(palette.colors.size());
+            codificada.resize(indices.size() * bytesIndice);
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+                uint32_t indice = indices[i];
+                for (std::size_t byte = 0; byte < bytesIndice; ++byte) {
+                    codificada[(bytesIndice * i) + byte] = static_cast<uint8_t>(indice);
+                    indice >>= BYTE_SHIFT;
+                }
+            }
+            unidad = bytesIndice;
+            fila = anchoTesela * bytesIndice;
+        }
+        return options.lz ? lzCompress(codificada, unidad, fila) : codificada;
+    }
+
+    // Mosaico o franjas: las teselas se codifican en paralelo en memoria, porque su tamaño
+    // (y por tanto la tabla de desplazamientos que las precede) no se conoce hasta tenerlas.
+    // Codificar una tesela reserva memoria: parallelForEach relanza el error si falta
+    void escribirMosaico(const std::string &outputFile, std::string prefijo, const std::span<const uint8_t> raster,
+                         const PPMHeader &header, const ColorPalette &palette, const CPPMOptions &options,
+                         const Teselas &reparto) {
+        const std::size_t teselas = reparto.total;
+        std::vector<std::vector<uint8_t>> codificadas(teselas);
+        parallelForEach(teselas, [&](const std::size_t tesela) {
+            codificadas[tesela] = codificarTesela(raster, header, palette, options, reparto, tesela);
+        });
+
+        std::vector<uint64_t> desplazamientos(teselas + 1, 0);
+        for (std::size_t tesela = 0; tesela < teselas; ++tesela) {
+            desplazamientos[tesela + 1] = desplazamientos[tesela] + codificadas[tesela].size();
+        }
+        for (uint64_t desplazamiento : desplazamientos) {
+            for (std::size_t byte = 0; byte < OFFSET_BYTES; ++byte) {
+                prefijo += static_cast<char>(desplazamiento & BYTE_MASK);
+                desplazamiento >>= BYTE_SHIFT;
+            }
+        }
+
+        // Cada elemento es un byte de los datos de teselas; un rango puede abarcar varias
+        writeEncodedOutput(outputFile, prefijo, static_cast<std::size_t>(desplazamientos.back()), 1,
+                           [&](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+                               auto tesela = static_cast<std::size_t>(
+                                   std::upper_bound(desplazamientos.begin(), desplazamientos.end(), first) -
+                                   desplazamientos.begin() - 1);
+                               for (std::size_t pos = first; pos < last; ++tesela) {
+                                   const auto inicio = static_cast<std::size_t>(desplazamientos[tesela]);
+                                   const std::size_t fin = std::min(last, static_cast<std::size_t>(desplazamientos[tesela + 1]));
+                                   std::copy(codificadas[tesela].begin() + static_cast<std::ptrdiff_t>(pos - inicio),
+                                             codificadas[tesela].begin() + static_cast<std::ptrdiff_t>(fin - inicio),
+                                             out.begin() + static_cast<std::ptrdiff_t>(pos - first));
+                                   pos = fin;
+                               }
+                           });
+    }
+}
+
+void compressMapped(const std::string &inputFile, const std::string &outputFile, const CPPMOptions &options) {
+    MappedFile file(inputFile);
+    std::vector<uint8_t> intercalado; // Solo para la caché planar
+    std::optional<PPMView> view;
+    PPMHeader header;
+    std::span<const uint8_t> raster;
+    if (isPlanarCache(file.data())) {
+        const PlanarView planar(std::move(file));
+        const PlanarHeader &cache = planar.header();
+        // Encabezado equivalente; con cuatro canales es un PAM, que rechazarAlfa descarta
+        header.magicNumber = cache.channels == 1 ? "P5" : (cache.channels == RGB_CHANNELS ? "P6" : "P7");
+        header.depth = static_cast<int>(cache.channels);
+        header.width = cache.width;
+        header.height = cache.height;
+        header.maxColorValue = cache.maxColorValue;
+        intercalado = planar.interleavedRaster();
+        raster = intercalado;
+    } else {
+        view.emplace(std::move(file));
+        header = view->header();
+        raster = view->raster();
+    }
+    // El raster se lee de la proyección mientras se escribe: sobre la misma ruta se
+    // escribe en un temporal y se renombra al terminar
+    OutputTarget salida(inputFile, outputFile);
+    compressRaster(raster, header, salida.path(), options);
+    salida.commit();
+}
+
+void compressImage(const PPMHeader &header, const ItemEncoder &encoder, const std::string &outputFile,
+                   const CPPMOptions &options) {
+    rechazarAlfa(header); // Antes de reservar el raster
+    compressRaster(encodeRaster(header, encoder), header, outputFile, options);
+}
+
+void compressRaster(const std::span<const uint8_t> raster, const PPMHeader &header, const std::string &outputFile,
+                    const CPPMOptions &options) {
+    rechazarAlfa(header);
+
+    if (options.tileSize < 0) {
+        throw std::invalid_argument("Error: El lado de tesela debe ser positivo.");
+    }
+
+    const ColorPalette palette = buildPalette(raster, header);
+    if (options.tileSize > 0) {
+        const auto lado = static_cast<std::size_t>(options.tileSize);
+        escribirMosaico(outputFile, formatCPPMPrefix(header, palette, cppmMagic(options), options.tileSize), raster, header,
+                        palette, options, repartirTeselas(header, lado, lado));
+        return;
+    }
+    if (options.lz) {
+        // Sin mosaico la compresión va por franjas de filas, para poder comprimirlas y
+        // expandirlas en paralelo
+        const std::size_t filas = rowsPerTask(static_cast<std::size_t>(header.width));
+        escribirMosaico(outputFile, formatCPPMPrefix(header, palette, cppmMagic(options), static_cast<int>(filas)), raster,
+                        header, palette, options, repartirTeselas(header, static_cast<std::size_t>(header.width), filas));
+        return;
+    }
+    if (options.packed) {
+        escribirEmpaquetado(outputFile, formatCPPMPrefix(header, palette, cppmMagic(options)), raster, header, palette);
+        return;
+    }
+    const std::size_t bytesIndice = cppmIndexBytes(palette.colors.size());
+
+    // La tabla solo se consulta en esta pasada, así que la comparten todos los hilos
+    writeEncodedOutput(outputFile, formatCPPMPrefix(header, palette), header.pixelCount(), bytesIndice,
+                       [&](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+                           for (std::size_t i = first; i < last; ++i) {
+                               uint32_t indice = *palette.indices.find(colorKey(raster, header, i));
+                               for (std::size_t byte = 0; byte < bytesIndice; ++byte) {
+                                   out[(bytesIndice * (i - first)) + byte] = static_cast<uint8_t>(indice);
+                                   indice >>= BYTE_SHIFT;
+                               }
+                           }
+                       });
+}
@@ -0,0 +1,94 @@
+#ifndef PRACTICA1_CPPMCOMPRESS_HPP
+#define PRACTICA1_CPPMCOMPRESS_HPP
+
+#include "ppmview.hpp"
+#include "ppmstream.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Tabla hash de direccionamiento abierto (sondeo lineal) de clave de color a índice. Las
+// claves y los valores van en vectores contiguos, sin un nodo por entrada como en
+// std::unordered_map; las consultas concurrentes son seguras si nadie inserta.
+class ColorIndexMap {
+public:
+    explicit ColorIndexMap(std::size_t expected = 0);
+
+    // Inserta la clave con `value` si no estaba; devuelve si se ha insertado
+    bool insert(uint64_t key, uint32_t value);
+
+    // Valor de la clave, o nullptr si no está
+    [[nodiscard]] const uint32_t *find(uint64_t key) const;
+
+    [[nodiscard]] std::size_t size() const { return usados; }
+
+private:
+    [[nodiscard]] std::size_t posicion(uint64_t key) const;
+    void crecer();
+
+    std::vector<uint64_t> claves; // EMPTY_KEY en las posiciones libres
+    std::vector<uint32_t> valores;
+    std::size_t usados = 0;
+    std::size_t mascara = 0;
+    unsigned desplazamiento = 0;
+};
+
+// Tabla de colores de un raster P6 (o P5) en orden de primera aparición. Cada color se
+// identifica por una clave con sus tres muestras completas (16 bits por canal si maxval
+// > 255); en escala de grises la clave es el nivel y el color es (v, v, v).
+struct ColorPalette {
+    std::vector<uint64_t> colors;                   // Clave de cada índice
+    ColorIndexMap indices;                           // Índice de cada clave
+};
+
+// Clave del píxel `pixel` leída directamente del raster
+[[nodiscard]] uint64_t colorKey(std::span<const uint8_t> raster, const PPMHeader &header, std::size_t pixel);
+
+// Construye la tabla en paralelo: cada bloque de píxeles reúne sus colores en orden de
+// aparición y los bloques se combinan en orden, así que los índices coinciden con los de
+// un recorrido secuencial
+[[nodiscard]] ColorPalette buildPalette(std::span<const uint8_t> raster, const PPMHeader &header);
+
+// Bytes por índice del formato CPPM para `colors` colores: 1, 2 o 4
+[[nodiscard]] std::size_t cppmIndexBytes(std::size_t colors);
+
+// Encabezado "C6 ancho alto maxval colores" (con el número mágico `magic` y, si `layoutSize`
+// no es 0, el lado de tesela o las filas por franja al final) seguido de la tabla de colores
+// (3 bytes por color, o 6 big-endian si maxval > 255)
+[[nodiscard]] std::string formatCPPMPrefix(const PPMHeader &header, const ColorPalette &palette,
+                                           std::string_view magic = "C6", int layoutSize = 0);
+
+// Variantes del formato que se eligen al comprimir
+struct CPPMOptions {
+    bool packed = false; // "C6P": índices con packedIndexBits(colores) bits en lugar de 1, 2 o 4 bytes
+    int tileSize = 0;    // "C6T": teselas de tileSize x tileSize codificadas por separado; 0 sin mosaico
+    bool lz = false;     // "C6Z": cada tesela (o franja de filas) comprimida con lzCompress
+};
+
+// Número mágico de las variantes elegidas: "C6" seguido de las letras en orden
+[[nodiscard]] std::string cppmMagic(const CPPMOptions &options);
+
+// Comprime un raster P6 (o P5) a CPPM: una pasada construye la tabla y otra codifica los
+// índices por bloques en paralelo con writeEncodedOutput. En mosaico (o con compresión) cada
+// tarea codifica una tesela y la tabla de desplazamientos se calcula con sus tamaños antes
+// de escribir.
+void compressRaster(std::span<const uint8_t> raster, const PPMHeader &header, const std::string &outputFile,
+                    const CPPMOptions &options = {});
+
+// Comprime una imagen en memoria (Image::compress de ambos backends): sus píxeles se
+// codifican con encodeRaster en un raster como el de `header` y este se comprime con
+// compressRaster, así que el resultado coincide con el de compressMapped. A diferencia de
+// compressMapped, además de la memoria de la imagen ocupa una copia completa del raster.
+void compressImage(const PPMHeader &header, const ItemEncoder &encoder, const std::string &outputFile,
+                   const CPPMOptions &options = {});
+
+// Comprime un PPM (o PGM) a CPPM directamente desde el archivo proyectado, sin cargar una
+// imagen, con compressRaster. Una caché planar se intercala antes en memoria. La salida
+// puede ser el propio archivo de entrada (ver OutputTarget).
+void compressMapped(const std::string &inputFile, const std::string &outputFile, const CPPMOptions &options = {});
+
+#endif // PRACTICA1_CPPMCOMPRESS_HPP
@@ -0,0 +1,57 @@
+#include "cppmpalette.hpp"
+#include "cppmview.hpp"
+#include "cppmcompress.hpp"
+#include "positionalwriter.hpp"
+#include "outputtarget.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr unsigned BITS_PER_BYTE = 8;
+    constexpr int MAX_COLOR_VALUE = 65535;
+}
+
+void rewriteCPPMPalette(const std::string &inputFile, const std::string &outputFile, const int newMaxColorValue,
+                        const PaletteTransform &transform) {
+    // Un maxval fuera de rango daría un encabezado inválido y muestras truncadas a 16 bits
+    if (newMaxColorValue < 1 || newMaxColorValue > MAX_COLOR_VALUE) {
+        throw std::invalid_argument("Error: Valor fuera de rango para maxlevel. Debe estar entre 1 y 65535.");
+    }
+    const CPPMView vista(inputFile);
+    const PPMHeader &cabecera = vista.header();
+
+    std::vector<uint16_t> muestras;
+    muestras.reserve(vista.palette().size() * RGB_CHANNELS);
+    for (const PaletteColor &color : vista.palette()) {
+        muestras.insert(muestras.end(), color.begin(), color.end());
+    }
+    transform(muestras, cabecera.maxColorValue);
+
+    // La tabla nueva se escribe con formatCPPMPrefix a partir de claves con el ancho de
+    // muestra del nuevo maxval
+    PPMHeader nueva = cabecera;
+    nueva.maxColorValue = newMaxColorValue;
+    const unsigned bitsMuestra = static_cast<unsigned>(nueva.bytesPerSample()) * BITS_PER_BYTE;
+    ColorPalette tabla;
+    tabla.colors.reserve(vista.palette().size());
+    for (std::size_t color = 0; color < vista.palette().size(); ++color) {
+        uint64_t clave = 0;
+        for (std::size_t canal = 0; canal < RGB_CHANNELS; ++canal) {
+            clave = (clave << bitsMuestra) | muestras[(color * RGB_CHANNELS) + canal];
+        }
+        tabla.colors.push_back(clave);
+    }
+
+    const int disposicion = cabecera.tileSize > 0 ? cabecera.tileSize : cabecera.stripRows;
+    const std::span<const uint8_t> flujo = vista.indexStream();
+    // Los índices se copian de la proyección: sobre la misma ruta se escribe en un temporal
+    OutputTarget salida(inputFile, outputFile);
+    writeEncodedOutput(salida.path(), formatCPPMPrefix(nueva, tabla, cabecera.magicNumber, disposicion), flujo.size(), 1,
+                       [&](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+                           std::memcpy(out.data(), flujo.subspan(first).data(), last - first);
+                       });
+    salida.commit();
+}
@@ -0,0 +1,23 @@
+#ifndef PRACTICA1_CPPMPALETTE_HPP
+#define PRACTICA1_CPPMPALETTE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+
+// Transformación de las muestras de la tabla, intercaladas (RGBRGB...); recibe también el
+// maxval del archivo de entrada
+using PaletteTransform = std::function<void(std::span<uint16_t> samples, int maxColorValue)>;
+
+// Operaciones sobre un CPPM que solo cambian la tabla de colores, en O(colores): se
+// reescribe el encabezado (con `newMaxColorValue`) y la tabla transformada, y el resto del
+// archivo (índices, y en mosaico o franjas la tabla de desplazamientos) se copia tal cual,
+// sin expandir ni volver a comprimir. Colores distintos pueden quedar iguales; la tabla
+// conserva ambas entradas. Un `newMaxColorValue` fuera de 1..65535 se rechaza con
+// std::invalid_argument antes de leer el archivo. La salida puede ser el propio archivo de
+// entrada (ver OutputTarget).
+void rewriteCPPMPalette(const std::string &inputFile, const std::string &outputFile, int newMaxColorValue,
+                        const PaletteTransform &transform);
+
+#endif // PRACTICA1_CPPMPALETTE_HPP
@@ -0,0 +1,240 @@
+#include "cppmview.hpp"
+#include "cppmcompress.hpp"
+
+#include "sharedmemory.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <utility>
+
+namespace {
+    constexpr int MAX_COLOR_16_BIT = 65535;
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr int BYTE_SHIFT = 8;
+    constexpr std::size_t OFFSET_BYTES = 8;
+    constexpr std::size_t REGION_FIELDS = 4;
+
+    // "C6" seguido de las letras de variante admitidas, cada una como mucho una vez y en orden
+    bool varianteValida(const std::string &magic) {
+        constexpr std::string_view VARIANTES = "TPZ";
+        if (!magic.starts_with("C6")) {
+            return false;
+        }
+        std::size_t siguiente = 0;
+        for (const char letra : std::string_view(magic).substr(2)) {
+            const std::size_t pos = VARIANTES.find(letra, siguiente);
+            if (pos == std::string_view::npos) {
+                return false;
+            }
+            siguiente = pos + 1;
+        }
+        return true;
+    }
+
+    uint64_t leerDesplazamiento(const std::span<const uint8_t> datos) {
+        uint64_t valor = 0;
+        for (std::size_t byte = OFFSET_BYTES; byte-- > 0;) {
+            valor = (valor << BYTE_SHIFT) | datos[byte];
+        }
+        return valor;
+    }
+}
+
+CPPMRegion parseRegion(const std::string &text) {
+    std::array<int, REGION_FIELDS> campos{};
+    const char *pos = text.data();
+    const char *const fin = text.data() + text.size();
+    for (std::size_t campo = 0; campo < REGION_FIELDS; ++campo) {
+        const auto [ptr, error] = std::from_chars(pos, fin, campos[campo]);
+        const bool separador = campo + 1 < REGION_FIELDS ? ptr != fin && *ptr == ',' : ptr == fin;
+        if (error != std::errc{} || !separador || campos[campo] < 0) {
+            throw std::invalid_argument("Error: La región debe ser x,y,ancho,alto con enteros no negativos.");
+        }
+        pos = ptr + 1;
+    }
+    if (campos[2] == 0 || campos[3] == 0) {
+        throw std::invalid_argument("Error: La región debe tener ancho y alto mayores que 0.");
+    }
+    return {.x = campos[0], .y = campos[1], .width = campos[2], .height = campos[3]};
+}
+
+bool isCPPM(const std::span<const uint8_t> data) {
+    return data.size() >= 2 && data[0] == 'C' && data[1] == '6';
+}
+
+bool isCPPMFile(const std::string &filePath) {
+    if (isStandardStream(filePath) || isSharedMemory(filePath)) {
+        return false;
+    }
+    std::ifstream archivo(filePath, std::ios::binary);
+    std::array<char, 2> firma{};
+    return archivo.read(firma.data(), firma.size()) && firma[0] == 'C' && firma[1] == '6';
+}
+
+CPPMView::CPPMView(const std::string &filePath) : CPPMView(MappedFile(filePath)) {}
+
+CPPMView::CPPMView(MappedFile mappedFile) : file(std::move(mappedFile)), cabecera(parsePPMHeader(file.data())) {
+    if (!varianteValida(cabecera.magicNumber)) {
+        throw std::runtime_error("Formato no soportado");
+    }
+    if (cabecera.maxColorValue <= 0 || cabecera.maxColorValue > MAX_COLOR_16_BIT) {
+        throw std::runtime_error("Valor de maxColorValue fuera de rango");
+    }
+    if (cabecera.colorCount <= 0 && cabecera.pixelCount() > 0) {
+        throw std::runtime_error("Archivo CPPM no válido");
+    }
+
+    const auto colores = static_cast<std::size_t>(cabecera.colorCount);
+    const std::size_t bytesMuestra = cabecera.bytesPerSample();
+    bytesIndice = cppmIndexBytes(colores);
+    bitsIndice = cabecera.magicNumber.find('P') != std::string::npos ? packedIndexBits(colores) : 0;
+    const std::size_t bytesTabla = colores * RGB_CHANNELS * bytesMuestra;
+    const std::span<const uint8_t> datos = file.data().subspan(cabecera.dataOffset);
+    if (datos.size() < bytesTabla) {
+        throw std::runtime_error("Archivo CPPM incompleto");
+    }
+
+    // La tabla es pequeña frente a los índices: se decodifica entera de una vez
+    paleta.resize(colores);
+    const std::span<const uint8_t> tabla = datos.first(bytesTabla);
+    for (std::size_t color = 0; color < colores; ++color) {
+        for (std::size_t canal = 0; canal < RGB_CHANNELS; ++canal) {
+            const std::size_t pos = ((color * RGB_CHANNELS) + canal) * bytesMuestra;
+            paleta[color][canal] = bytesMuestra == 1 ? static_cast<uint16_t>(tabla[pos])
+                                                     : static_cast<uint16_t>((tabla[pos] << BYTE_SHIFT) | tabla[pos + 1]);
+        }
+    }
+
+    comprimido = cabecera.magicNumber.find('Z') != std::string::npos;
+    if (cabecera.tileSize > 0 || comprimido) {
+        anchoTesela = static_cast<std::size_t>(cabecera.tileSize > 0 ? cabecera.tileSize : cabecera.width);
+        altoTesela = static_cast<std::size_t>(cabecera.tileSize > 0 ? cabecera.tileSize : cabecera.stripRows);
+        readTileTable(datos.subspan(bytesTabla));
+        return;
+    }
+    const std::size_t bytesIndices = encodedSize(cabecera.pixelCount());
+    if (datos.size() - bytesTabla < bytesIndices) {
+        throw std::runtime_error("Archivo CPPM incompleto");
+    }
+    indices = datos.subspan(bytesTabla, bytesIndices);
+    flujo = indices;
+}
+
+// Lee la tabla de desplazamientos y comprueba que cada tesela quepa en los datos y, si no
+// está comprimida, tenga los bytes que necesitan sus píxeles
+void CPPMView::readTileTable(const std::span<const uint8_t> datos) {
+    // Una imagen vacía no tiene teselas
+    teselasX = anchoTesela == 0 ? 0 : (static_cast<std::size_t>(cabecera.width) + anchoTesela - 1) / anchoTesela;
+    teselasY = altoTesela == 0 ? 0 : (static_cast<std::size_t>(cabecera.height) + altoTesela - 1) / altoTesela;
+    const std::size_t bytesTablaTeselas = (tileCount() + 1) * OFFSET_BYTES;
+    if (datos.size() < bytesTablaTeselas) {
+        throw std::runtime_error("Archivo CPPM incompleto");
+    }
+    indices = datos.subspan(bytesTablaTeselas);
+
+    desplazamientos.resize(tileCount() + 1);
+    for (std::size_t tesela = 0; tesela <= tileCount(); ++tesela) {
+        desplazamientos[tesela] = leerDesplazamiento(datos.subspan(tesela * OFFSET_BYTES, OFFSET_BYTES));
+    }
+    if (desplazamientos.back() > indices.size()) {
+        throw std::runtime_error("Archivo CPPM incompleto");
+    }
+    flujo = datos.first(bytesTablaTeselas + static_cast<std::size_t>(desplazamientos.back()));
+    for (std::size_t tesela = 0; tesela < tileCount(); ++tesela) {
+        const CPPMRegion region = tileRegion(tesela);
+        const std::size_t pixeles = static_cast<std::size_t>(region.width) * static_cast<std::size_t>(region.height);
+        if (desplazamientos[tesela] > desplazamientos[tesela + 1] ||
+            (!comprimido && desplazamientos[tesela + 1] - desplazamientos[tesela] < encodedSize(pixeles))) {
+            throw std::runtime_error("Archivo CPPM no válido");
+        }
+    }
+}
+
+std::size_t CPPMView::encodedSize(const std::size_t count) const {
+    return bitsIndice > 0 ? packedSize(count, bitsIndice) : count * bytesIndice;
+}
+
+CPPMRegion CPPMView::tileRegion(const std::size_t tile) const {
+    if (desplazamientos.empty()) {
+        return fullRegion();
+    }
+    const auto ancho = static_cast<int>(anchoTesela);
+    const auto alto = static_cast<int>(altoTesela);
+    const int x = static_cast<int>(tile % teselasX) * ancho;
+    const int y = static_cast<int>(tile / teselasX) * alto;
+    return {.x = x, .y = y, .width = std::min(ancho, cabecera.width - x), .height = std::min(alto, cabecera.height - y)};
+}
+
+std::span<const uint8_t> CPPMView::tilePayload(const std::size_t tile) const {
+    if (desplazamientos.empty()) {
+        return indices;
+    }
+    return indices.subspan(desplazamientos[tile], desplazamientos[tile + 1] - desplazamientos[tile]);
+}
+
+bool CPPMView::decodeTile(const std::size_t tile, std::vector<uint8_t> &buffer, std::vector<uint32_t> &out) const {
+    const CPPMRegion region = tileRegion(tile);
+    out.resize(static_cast<std::size_t>(region.width) * static_cast<std::size_t>(region.height));
+    std::span<const uint8_t> datos = tilePayload(tile);
+    if (comprimido) {
+        buffer.resize(encodedSize(out.size()));
+        if (!lzDecompress(datos, buffer)) {
+            return false;
+        }
+        datos = buffer;
+    }
+    decodeIndices(datos, 0, out);
+    return true;
+}
+
+std::vector<std::size_t> CPPMView::tilesIn(const CPPMRegion &region) const {
+    std::vector<std::size_t> teselas;
+    if (region.width == 0 || region.height == 0) {
+        return teselas;
+    }
+    for (std::size_t ty = static_cast<std::size_t>(region.y) / altoTesela;
+         ty * altoTesela < static_cast<std::size_t>(region.y + region.height); ++ty) {
+        for (std::size_t tx = static_cast<std::size_t>(region.x) / anchoTesela;
+             tx * anchoTesela < static_cast<std::size_t>(region.x + region.width); ++tx) {
+            teselas.push_back((ty * teselasX) + tx);
+        }
+    }
+    return teselas;
+}
+
+void CPPMView::requireInside(const CPPMRegion &region) const {
+    if (region.x < 0 || region.y < 0 || region.width < 0 || region.height < 0 ||
+        region.width > cabecera.width - region.x || region.height > cabecera.height - region.y) {
+        throw std::runtime_error("Región fuera de la imagen");
+    }
+}
+
+void CPPMView::decodeIndices(const std::span<const uint8_t> datos, const std::size_t first, const std::span<uint32_t> out) const {
+    if (bitsIndice == 0) {
+        for (std::size_t j = 0; j < out.size(); ++j) {
+            const std::span<const uint8_t> bytes = datos.subspan((first + j) * bytesIndice, bytesIndice);
+            uint32_t valor = 0;
+            for (std::size_t byte = bytesIndice; byte-- > 0;) {
+                valor = (valor << BYTE_SHIFT) | bytes[byte];
+            }
+            out[j] = valor;
+        }
+        return;
+    }
+
+    // Empaquetados: se desempaquetan los grupos completos que cubren el tramo y se copia
+    // la parte pedida
+    std::array<uint32_t, EXPAND_SPAN> grupos{};
+    std::size_t hechos = 0;
+    while (hechos < out.size()) {
+        const std::size_t inicio = first + hechos;
+        const std::size_t base = inicio / PACK_GROUP * PACK_GROUP;
+        const std::size_t fin = std::min(base + EXPAND_SPAN, (first + out.size() + PACK_GROUP - 1) / PACK_GROUP * PACK_GROUP);
+        unpackIndices(datos.subspan(base / PACK_GROUP * bitsIndice, (fin - base) / PACK_GROUP * bitsIndice), bitsIndice,
+                      std::span(grupos).first(fin - base));
+        const std::size_t copiar = std::min(out.size() - hechos, fin - inicio);
+        std::copy_n(grupos.begin() + static_cast<std::ptrdiff_t>(inicio - base), copiar,
+                    out.begin() + static_cast<std::ptrdiff_t>(hechos));
+        hechos += copiar;
+    }
+}
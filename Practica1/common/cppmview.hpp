@@ -0,0 +1,212 @@
+#ifndef PRACTICA1_CPPMVIEW_HPP
+#define PRACTICA1_CPPMVIEW_HPP
+
+#include "mappedfile.hpp"
+#include "ppmview.hpp"
+#include "bitpack.hpp"
+#include "parallel.hpp"
+#include "indexlz.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Color de la tabla CPPM: rojo, verde y azul
+using PaletteColor = std::array<uint16_t, 3>;
+
+// Rectángulo de píxeles de una imagen
+struct CPPMRegion {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Analiza una región escrita como "x,y,ancho,alto"; lanza std::invalid_argument si no lo es
+CPPMRegion parseRegion(const std::string &text);
+
+// Indica si los datos empiezan como un CPPM ("C6" o una de sus variantes)
+[[nodiscard]] bool isCPPM(std::span<const uint8_t> data);
+
+// Lo mismo leyendo solo el principio del archivo; "-" y "shm:" no se consultan (false)
+[[nodiscard]] bool isCPPMFile(const std::string &filePath);
+
+// Vista de solo lectura de un CPPM (C6) proyectado en memoria. La tabla de colores se
+// decodifica al abrirlo (3 bytes por color, o 6 big-endian si maxval > 255); los índices
+// (little-endian, de 1, 2 o 4 bytes según el número de colores) se leen en el sitio.
+// Las variantes se indican con letras tras "C6", en este orden:
+//   T  mosaico: el encabezado lleva además el lado de tesela ("C6T ancho alto maxval
+//      colores lado"). Tras la tabla de colores va una tabla de teselas + 1 desplazamientos
+//      uint64 little-endian, relativos al inicio de los datos de teselas, y después las
+//      teselas por filas, cada una con sus píxeles por filas y codificada por separado.
+//   P  índices empaquetados con packedIndexBits(colores) bits (ver bitpack.hpp).
+//   Z  cada tesela se comprime con lzCompress (ver indexlz.hpp). Sin mosaico, el
+//      encabezado lleva en su lugar las filas de cada franja y la imagen se guarda como
+//      teselas del ancho completo, con la misma tabla de desplazamientos.
+class CPPMView {
+public:
+    explicit CPPMView(const std::string &filePath);
+    explicit CPPMView(MappedFile mappedFile);
+
+    [[nodiscard]] const PPMHeader &header() const { return cabecera; }
+    [[nodiscard]] const std::vector<PaletteColor> &palette() const { return paleta; }
+
+    // Bytes de cada índice de píxel (sin empaquetar)
+    [[nodiscard]] std::size_t indexBytes() const { return bytesIndice; }
+
+    // Todo lo que sigue a la tabla de colores (en mosaico o franjas, tabla de desplazamientos
+    // incluida) tal como está en el archivo; no depende de los valores de la tabla
+    [[nodiscard]] std::span<const uint8_t> indexStream() const { return flujo; }
+
+    // Bits de cada índice empaquetado, o 0 si los índices ocupan bytes completos
+    [[nodiscard]] unsigned packedBits() const { return bitsIndice; }
+
+    // Lado de las teselas, o 0 si el archivo no es en mosaico
+    [[nodiscard]] int tileSize() const { return cabecera.tileSize; }
+    [[nodiscard]] std::size_t tileCount() const { return teselasX * teselasY; }
+
+    // Indica si las teselas (o franjas) están comprimidas con lzCompress
+    [[nodiscard]] bool compressed() const { return comprimido; }
+
+    // Rectángulo de la tesela `tile` (las de los bordes pueden ser más pequeñas)
+    [[nodiscard]] CPPMRegion tileRegion(std::size_t tile) const;
+
+    // Toda la imagen
+    [[nodiscard]] CPPMRegion fullRegion() const { return {.x = 0, .y = 0, .width = cabecera.width, .height = cabecera.height}; }
+
+    // Llama a fn(pixel, indice) para los píxeles [first, last) de un archivo sin mosaico ni
+    // compresión.
+    // Se detiene y devuelve false si un índice no está en la tabla; no lanza, así que se
+    // puede usar dentro de parallelForRanges.
+    template <typename Fn>
+    bool expand(const std::size_t first, const std::size_t last, Fn &&fn) const {
+        std::array<uint32_t, EXPAND_SPAN> tramo{};
+        for (std::size_t inicio = first; inicio < last; inicio += EXPAND_SPAN) {
+            const std::span<uint32_t> destino = std::span(tramo).first(std::min(EXPAND_SPAN, last - inicio));
+            decodeIndices(indices, inicio, destino);
+            for (std::size_t j = 0; j < destino.size(); ++j) {
+                if (destino[j] >= paleta.size()) {
+                    return false;
+                }
+                fn(inicio + j, static_cast<std::size_t>(destino[j]));
+            }
+        }
+        return true;
+    }
+
+    // Decodifica la región en paralelo llamando a fn(x, y, indice) con coordenadas relativas
+    // a la región; fn se llama a la vez desde varios hilos con píxeles distintos. En mosaico
+    // (o en franjas) solo se decodifican las teselas que cortan la región y cada tarea hace
+    // una tesela; si no, cada tarea hace un bloque de filas. Lanza std::runtime_error si la
+    // región se sale de la imagen, si una tesela comprimida está dañada o si algún índice
+    // no está en la tabla.
+    template <typename Fn>
+    void expandRegion(const CPPMRegion &region, Fn &&fn) const {
+        requireInside(region);
+        std::atomic<bool> indiceInvalido = false;
+        std::atomic<bool> teselaDanada = false;
+        const auto anchoRegion = static_cast<std::size_t>(region.width);
+        if (desplazamientos.empty()) {
+            const auto ancho = static_cast<std::size_t>(cabecera.width);
+            parallelForRanges(static_cast<std::size_t>(region.height), rowsPerTask(anchoRegion),
+                              [&](const std::size_t primera, const std::size_t ultima) {
+                                  for (std::size_t fila = primera; fila < ultima; ++fila) {
+                                      const std::size_t inicio = ((static_cast<std::size_t>(region.y) + fila) * ancho) +
+                                                                 static_cast<std::size_t>(region.x);
+                                      const bool valido = expand(inicio, inicio + anchoRegion,
+                                                                 [&](const std::size_t pixel, const std::size_t indice) {
+                                                                     fn(pixel - inicio, fila, indice);
+                                                                 });
+                                      if (!valido) {
+                                          indiceInvalido = true;
+                                          return;
+                                      }
+                                  }
+                              });
+        } else {
+            const std::vector<std::size_t> teselas = tilesIn(region);
+            parallelForRanges(teselas.size(), 1, [&](const std::size_t primera, const std::size_t ultima) {
+                std::vector<uint8_t> descomprimida;
+                std::vector<uint32_t> indicesTesela;
+                for (std::size_t k = primera; k < ultima; ++k) {
+                    const CPPMRegion tesela = tileRegion(teselas[k]);
+                    if (!decodeTile(teselas[k], descomprimida, indicesTesela)) {
+                        teselaDanada = true;
+                        return;
+                    }
+                    // Intersección de la tesela con la región
+                    const int x0 = std::max(tesela.x, region.x);
+                    const int x1 = std::min(tesela.x + tesela.width, region.x + region.width);
+                    const int y0 = std::max(tesela.y, region.y);
+                    const int y1 = std::min(tesela.y + tesela.height, region.y + region.height);
+                    for (int y = y0; y < y1; ++y) {
+                        for (int x = x0; x < x1; ++x) {
+                            const uint32_t indice = indicesTesela[(static_cast<std::size_t>(y - tesela.y) *
+                                                                   static_cast<std::size_t>(tesela.width)) +
+                                                                  static_cast<std::size_t>(x - tesela.x)];
+                            if (indice >= paleta.size()) {
+                                indiceInvalido = true;
+                                return;
+                            }
+                            fn(static_cast<std::size_t>(x - region.x), static_cast<std::size_t>(y - region.y),
+                               static_cast<std::size_t>(indice));
+                        }
+                    }
+                }
+            });
+        }
+        if (teselaDanada) {
+            throw std::runtime_error("Archivo CPPM no válido");
+        }
+        if (indiceInvalido) {
+            throw std::runtime_error("Índice de color fuera de la tabla");
+        }
+    }
+
+private:
+    // Índices que decodifica expand() de una vez
+    static constexpr std::size_t EXPAND_SPAN = 1024;
+
+    // Decodifica los índices [first, first + out.size()) de un flujo de índices (todo el
+    // archivo o una tesela) según el ancho de índice del archivo
+    void decodeIndices(std::span<const uint8_t> datos, std::size_t first, std::span<uint32_t> out) const;
+
+    // Bytes de la tesela `tile` dentro de los datos de teselas
+    [[nodiscard]] std::span<const uint8_t> tilePayload(std::size_t tile) const;
+
+    // Índices de la tesela `tile` por filas; si está comprimida se descomprime antes en
+    // `buffer`. Devuelve false, sin lanzar, si los datos comprimidos están dañados.
+    bool decodeTile(std::size_t tile, std::vector<uint8_t> &buffer, std::vector<uint32_t> &out) const;
+
+    // Teselas que cortan la región
+    [[nodiscard]] std::vector<std::size_t> tilesIn(const CPPMRegion &region) const;
+
+    void requireInside(const CPPMRegion &region) const;
+
+    // Bytes que ocupan `count` índices codificados
+    [[nodiscard]] std::size_t encodedSize(std::size_t count) const;
+
+    void readTileTable(std::span<const uint8_t> datos);
+
+    MappedFile file;
+    PPMHeader cabecera;
+    std::vector<PaletteColor> paleta;
+    std::size_t bytesIndice = 1;
+    unsigned bitsIndice = 0;
+    std::span<const uint8_t> indices; // Apunta a las páginas de `file`; en mosaico, a los datos de teselas
+    std::span<const uint8_t> flujo;   // Desde el final de la tabla de colores hasta el final de los índices
+    bool comprimido = false;
+    std::size_t anchoTesela = 0; // Lado de tesela, o el ancho de la imagen en franjas
+    std::size_t altoTesela = 0;
+    std::size_t teselasX = 1;
+    std::size_t teselasY = 1;
+    std::vector<uint64_t> desplazamientos; // Solo en mosaico o franjas: teselas + 1 posiciones
+};
+
+#endif // PRACTICA1_CPPMVIEW_HPP
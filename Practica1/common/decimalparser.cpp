@@ -0,0 +1,224 @@
+#include "decimalparser.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr std::size_t BLOQUE = 64;
+    constexpr int MAX_COLOR_8_BIT = 255;
+    constexpr int DECIMAL_BASE = 10;
+    constexpr int BYTE_SHIFT = 8;
+    constexpr uint8_t BYTE_MASK = 0xFF;
+    constexpr uint8_t ESPACIO = ' ';
+    constexpr uint8_t PRIMER_CONTROL = '\t'; // '\t' '\n' '\v' '\f' '\r' son consecutivos
+    constexpr uint8_t CONTROLES = 4;          // Distancia del último control al primero
+    constexpr uint8_t MAYOR_DIGITO = 9;
+
+    // Clasificación de 64 bytes: bit i activo si el byte i es un dígito o un separador
+    struct Clases {
+        uint64_t digitos = 0;
+        uint64_t separadores = 0;
+    };
+
+    bool esSeparador(const uint8_t byte) {
+        return byte == ESPACIO || static_cast<uint8_t>(byte - PRIMER_CONTROL) <= CONTROLES;
+    }
+
+    bool esDigito(const uint8_t byte) {
+        return static_cast<uint8_t>(byte - '0') <= MAYOR_DIGITO;
+    }
+
+#if defined(__AVX2__)
+    constexpr std::size_t BYTES_REGISTRO = 32;
+
+    // Comparaciones sin signo "x - base <= rango" con min_epu8
+    uint64_t clasificarRegistro(const __m256i bytes, const char base, const char rango) {
+        const __m256i desplazados = _mm256_sub_epi8(bytes, _mm256_set1_epi8(base));
+        const __m256i dentro = _mm256_cmpeq_epi8(_mm256_min_epu8(desplazados, _mm256_set1_epi8(rango)), desplazados);
+        return static_cast<uint32_t>(_mm256_movemask_epi8(dentro));
+    }
+
+    Clases clasificar(const uint8_t *datos) {
+        Clases clases;
+        for (std::size_t i = 0; i < BLOQUE / BYTES_REGISTRO; ++i) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(datos + (i * BYTES_REGISTRO)));
+            const uint64_t espacios = static_cast<uint32_t>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(static_cast<char>(ESPACIO)))));
+            const uint64_t controles = clasificarRegistro(bytes, static_cast<char>(PRIMER_CONTROL), static_cast<char>(CONTROLES));
+            clases.digitos |= clasificarRegistro(bytes, '0', static_cast<char>(MAYOR_DIGITO)) << (i * BYTES_REGISTRO);
+            clases.separadores |= (espacios | controles) << (i * BYTES_REGISTRO);
+        }
+        return clases;
+    }
+#elif defined(__SSE2__)
+    constexpr std::size_t BYTES_REGISTRO = 16;
+
+    // Comparaciones sin signo "x - base <= rango" con min_epu8
+    uint64_t clasificarRegistro(const __m128i bytes, const char base, const char rango) {
+        const __m128i desplazados = _mm_sub_epi8(bytes, _mm_set1_epi8(base));
+        const __m128i dentro = _mm_cmpeq_epi8(_mm_min_epu8(desplazados, _mm_set1_epi8(rango)), desplazados);
+        return static_cast<uint32_t>(_mm_movemask_epi8(dentro));
+    }
+
+    Clases clasificar(const uint8_t *datos) {
+        Clases clases;
+        for (std::size_t i = 0; i < BLOQUE / BYTES_REGISTRO; ++i) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(datos + (i * BYTES_REGISTRO)));
+            const uint64_t espacios = static_cast<uint32_t>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(ESPACIO)))));
+            const uint64_t controles = clasificarRegistro(bytes, static_cast<char>(PRIMER_CONTROL), static_cast<char>(CONTROLES));
+            clases.digitos |= clasificarRegistro(bytes, '0', static_cast<char>(MAYOR_DIGITO)) << (i * BYTES_REGISTRO);
+            clases.separadores |= (espacios | controles) << (i * BYTES_REGISTRO);
+        }
+        return clases;
+    }
+#else
+    Clases clasificar(const uint8_t *datos) {
+        const std::span<const uint8_t> bloque(datos, BLOQUE);
+        Clases clases;
+        for (std::size_t i = 0; i < BLOQUE; ++i) {
+            clases.digitos |= static_cast<uint64_t>(esDigito(bloque[i])) << i;
+            clases.separadores |= static_cast<uint64_t>(esSeparador(bloque[i])) << i;
+        }
+        return clases;
+    }
+#endif
+
+    // Recorre los bloques de 64 bytes de `trozo` y llama a alInicio(posición) con la posición
+    // del primer dígito de cada número. Devuelve false si hay algún byte que no sea ni dígito
+    // ni separador. El trozo empieza y acaba en un límite de número.
+    template <typename AlInicio>
+    bool recorrerNumeros(const std::span<const uint8_t> trozo, AlInicio &&alInicio) {
+        uint64_t acarreo = 0; // 1 si el bloque anterior terminó en un dígito
+        for (std::size_t inicio = 0; inicio < trozo.size(); inicio += BLOQUE) {
+            const std::size_t bytes = std::min(BLOQUE, trozo.size() - inicio);
+            Clases clases;
+            if (bytes == BLOQUE) {
+                clases = clasificar(trozo.subspan(inicio, BLOQUE).data());
+            } else {
+                // Último bloque incompleto: se rellena con separadores
+                std::array<uint8_t, BLOQUE> relleno{};
+                relleno.fill(ESPACIO);
+                std::ranges::copy(trozo.subspan(inicio), relleno.begin());
+                clases = clasificar(relleno.data());
+            }
+            if ((clases.digitos | clases.separadores) != ~uint64_t{0}) {
+                return false;
+            }
+
+            // Un número empieza en un dígito precedido por un separador
+            uint64_t inicios = clases.digitos & ~((clases.digitos << 1U) | acarreo);
+            acarreo = clases.digitos >> (BLOQUE - 1);
+            while (inicios != 0) {
+                alInicio(inicio + static_cast<std::size_t>(std::countr_zero(inicios)));
+                inicios &= inicios - 1;
+            }
+        }
+        return true;
+    }
+
+    // Corta el texto en trozos de unos `chunkSize` bytes sin partir ningún número
+    std::vector<std::size_t> cortarTrozos(const std::span<const uint8_t> text, const std::size_t chunkSize) {
+        std::vector<std::size_t> limites{0};
+        std::size_t limite = 0;
+        while (text.size() - limite > chunkSize) {
+            limite += chunkSize;
+            while (limite < text.size() && !esSeparador(text[limite])) {
+                ++limite;
+            }
+            limites.push_back(limite);
+        }
+        if (limites.back() != text.size()) {
+            limites.push_back(text.size());
+        }
+        return limites;
+    }
+
+    // Escribe los números del trozo a partir de la muestra `primera`; false si alguno supera maxval
+    template <std::size_t BYTES_MUESTRA>
+    bool escribirNumeros(const std::span<const uint8_t> trozo, const std::size_t primera, const int maxColorValue,
+                         const std::span<uint8_t> raster) {
+        std::size_t muestra = primera;
+        bool valido = true;
+        const bool completo = recorrerNumeros(trozo, [&](std::size_t posicion) {
+            int valor = 0;
+            while (posicion < trozo.size() && esDigito(trozo[posicion])) {
+                valor = (valor * DECIMAL_BASE) + (trozo[posicion] - '0');
+                if (valor > maxColorValue) {
+                    valido = false;
+                    return;
+                }
+                ++posicion;
+            }
+            if constexpr (BYTES_MUESTRA == 1) {
+                raster[muestra] = static_cast<uint8_t>(valor);
+            } else {
+                raster[2 * muestra] = static_cast<uint8_t>(valor >> BYTE_SHIFT);
+                raster[(2 * muestra) + 1] = static_cast<uint8_t>(valor & BYTE_MASK);
+            }
+            ++muestra;
+        });
+        return completo && valido;
+    }
+}
+
+std::vector<uint8_t> parseDecimalRaster(const std::span<const uint8_t> text, const std::size_t samples,
+                                        const int maxColorValue, const std::size_t chunkSize) {
+    const std::vector<std::size_t> limites = cortarTrozos(text, std::max<std::size_t>(BLOQUE, chunkSize));
+    const std::size_t trozos = limites.size() - 1;
+    const auto trozo = [&](const std::size_t indice) {
+        return text.subspan(limites[indice], limites[indice + 1] - limites[indice]);
+    };
+
+    // Primera pasada: números por trozo, para saber dónde escribe cada uno
+    std::vector<std::size_t> cuentas(trozos + 1, 0);
+    std::atomic<bool> invalido = false;
+    parallelForRanges(trozos, 1, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            std::size_t numeros = 0;
+            if (!recorrerNumeros(trozo(i), [&numeros](std::size_t /*posicion*/) { ++numeros; })) {
+                invalido = true;
+            }
+            cuentas[i + 1] = numeros;
+        }
+    });
+    if (invalido) {
+        throw std::runtime_error("Archivo PPM no válido");
+    }
+    std::partial_sum(cuentas.begin(), cuentas.end(), cuentas.begin());
+    if (cuentas.back() < samples) {
+        throw std::runtime_error("Archivo PPM incompleto");
+    }
+    if (cuentas.back() > samples) {
+        throw std::runtime_error("Archivo PPM no válido");
+    }
+
+    // Segunda pasada: cada trozo escribe sus muestras en su posición del raster
+    const std::size_t bytesMuestra = maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2;
+    std::vector<uint8_t> raster(samples * bytesMuestra);
+    std::atomic<bool> fueraDeRango = false;
+    parallelForRanges(trozos, 1, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const bool correcto = bytesMuestra == 1 ? escribirNumeros<1>(trozo(i), cuentas[i], maxColorValue, raster)
+                                                    : escribirNumeros<2>(trozo(i), cuentas[i], maxColorValue, raster);
+            if (!correcto) {
+                fueraDeRango = true;
+            }
+        }
+    });
+    if (fueraDeRango) {
+        throw std::runtime_error("Valor de muestra fuera de rango");
+    }
+    return raster;
+}
@@ -0,0 +1,22 @@
+#ifndef PRACTICA1_DECIMALPARSER_HPP
+#define PRACTICA1_DECIMALPARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Tamaño aproximado del texto que analiza cada tarea paralela
+constexpr std::size_t DECIMAL_CHUNK_SIZE = static_cast<std::size_t>(1) << 20;
+
+// Convierte el raster en texto de un PPM P3 (enteros decimales separados por espacios en
+// blanco) al raster binario equivalente de un P6: un byte por muestra si maxval <= 255 y
+// dos bytes big-endian en otro caso. El texto se reparte en trozos de unos `chunkSize`
+// bytes cortados en separadores; cada trozo se clasifica por bloques de 64 bytes con SIMD
+// (dígito/separador) y se analiza en paralelo en dos pasadas: una cuenta los números de
+// cada trozo y la otra los escribe en su posición. Debe haber exactamente `samples`
+// números, todos entre 0 y maxColorValue.
+std::vector<uint8_t> parseDecimalRaster(std::span<const uint8_t> text, std::size_t samples, int maxColorValue,
+                                        std::size_t chunkSize = DECIMAL_CHUNK_SIZE);
+
+#endif // PRACTICA1_DECIMALPARSER_HPP
@@ -0,0 +1,144 @@
+#include "indexlz.hpp"
+
+#include <cstring>
+
+namespace {
+    constexpr unsigned HASH_BITS = 14;
+    constexpr uint32_t HASH_MULTIPLIER = 2654435761U;
+    constexpr unsigned VARINT_SHIFT = 7;
+    constexpr uint8_t VARINT_MASK = 0x7F;
+    constexpr uint8_t VARINT_MORE = 0x80;
+    constexpr unsigned MAX_VARINT_SHIFT = 63;
+    constexpr unsigned BYTE_SHIFT = 8;
+
+    void escribirVarint(std::vector<uint8_t> &out, std::size_t valor) {
+        while (valor > VARINT_MASK) {
+            out.push_back(static_cast<uint8_t>((valor & VARINT_MASK) | VARINT_MORE));
+            valor >>= VARINT_SHIFT;
+        }
+        out.push_back(static_cast<uint8_t>(valor));
+    }
+
+    // Lee un varint desde `pos`; false si se acaba la entrada o no cabe en 64 bits
+    bool leerVarint(const std::span<const uint8_t> in, std::size_t &pos, std::size_t &valor) {
+        valor = 0;
+        for (unsigned desplazamiento = 0; desplazamiento <= MAX_VARINT_SHIFT; desplazamiento += VARINT_SHIFT) {
+            if (pos >= in.size()) {
+                return false;
+            }
+            const uint8_t byte = in[pos++];
+            valor |= static_cast<std::size_t>(byte & VARINT_MASK) << desplazamiento;
+            if ((byte & VARINT_MORE) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Bytes iguales a partir de `pos` y de `pos - distancia`, hasta el final de la entrada
+    std::size_t longitudComun(const std::span<const uint8_t> in, const std::size_t pos, const std::size_t distancia) {
+        std::size_t longitud = 0;
+        while (pos + longitud < in.size() && in[pos + longitud] == in[pos + longitud - distancia]) {
+            ++longitud;
+        }
+        return longitud;
+    }
+
+    std::size_t hashear(const std::span<const uint8_t> in, const std::size_t pos) {
+        uint32_t palabra = 0;
+        for (std::size_t byte = LZ_MIN_MATCH; byte-- > 0;) {
+            palabra = (palabra << BYTE_SHIFT) | in[pos + byte];
+        }
+        return (palabra * HASH_MULTIPLIER) >> (32U - HASH_BITS);
+    }
+}
+
+std::vector<uint8_t> lzCompress(const std::span<const uint8_t> input, const std::size_t unit, const std::size_t row) {
+    std::vector<uint8_t> out;
+    out.reserve(input.size() / 4);
+    // Posición + 1 de la última aparición de cada hash; 0 indica vacío
+    std::vector<uint32_t> ultimas(std::size_t{1} << HASH_BITS, 0);
+    std::size_t literales = 0; // Inicio de los literales pendientes
+    std::size_t pos = 0;
+    while (pos + LZ_MIN_MATCH <= input.size()) {
+        std::size_t mejorLongitud = 0;
+        std::size_t mejorDistancia = 0;
+        const auto probar = [&](const std::size_t distancia) {
+            if (distancia == 0 || distancia > pos) {
+                return;
+            }
+            const std::size_t longitud = longitudComun(input, pos, distancia);
+            if (longitud > mejorLongitud) {
+                mejorLongitud = longitud;
+                mejorDistancia = distancia;
+            }
+        };
+        probar(unit);
+        probar(row);
+        const std::size_t hash = hashear(input, pos);
+        if (ultimas[hash] != 0) {
+            probar(pos - (ultimas[hash] - 1));
+        }
+        ultimas[hash] = static_cast<uint32_t>(pos + 1);
+
+        if (mejorLongitud < LZ_MIN_MATCH) {
+            ++pos;
+            continue;
+        }
+        escribirVarint(out, pos - literales);
+        out.insert(out.end(), input.begin() + static_cast<std::ptrdiff_t>(literales), input.begin() + static_cast<std::ptrdiff_t>(pos));
+        escribirVarint(out, mejorLongitud);
+        escribirVarint(out, mejorDistancia);
+        // Se registran algunas posiciones de dentro de la repetición para que las siguientes
+        // la encuentren; registrarlas todas ralentiza las rachas largas sin ganar nada
+        const std::size_t fin = pos + mejorLongitud;
+        for (std::size_t paso = pos + 1; paso + LZ_MIN_MATCH <= input.size() && paso < fin && paso < pos + LZ_MIN_MATCH; ++paso) {
+            ultimas[hashear(input, paso)] = static_cast<uint32_t>(paso + 1);
+        }
+        pos = fin;
+        literales = pos;
+    }
+
+    escribirVarint(out, input.size() - literales);
+    out.insert(out.end(), input.begin() + static_cast<std::ptrdiff_t>(literales), input.end());
+    escribirVarint(out, 0);
+    return out;
+}
+
+bool lzDecompress(const std::span<const uint8_t> input, const std::span<uint8_t> output) {
+    std::size_t leido = 0;
+    std::size_t escrito = 0;
+    while (leido < input.size()) {
+        std::size_t literales = 0;
+        std::size_t longitud = 0;
+        if (!leerVarint(input, leido, literales) || literales > input.size() - leido || literales > output.size() - escrito) {
+            return false;
+        }
+        std::memcpy(output.data() + escrito, input.data() + leido, literales);
+        leido += literales;
+        escrito += literales;
+
+        if (!leerVarint(input, leido, longitud)) {
+            return false;
+        }
+        if (longitud == 0) {
+            return leido == input.size() && escrito == output.size();
+        }
+        std::size_t distancia = 0;
+        if (!leerVarint(input, leido, distancia) || distancia == 0 || distancia > escrito || longitud > output.size() - escrito) {
+            return false;
+        }
+        uint8_t *destino = output.data() + escrito;
+        const uint8_t *origen = destino - distancia;
+        if (distancia >= longitud) {
+            std::memcpy(destino, origen, longitud);
+        } else {
+            // Solapada: se copia byte a byte en orden para que se repita lo recién escrito
+            for (std::size_t byte = 0; byte < longitud; ++byte) {
+                destino[byte] = origen[byte];
+            }
+        }
+        escrito += longitud;
+    }
+    return false;
+}
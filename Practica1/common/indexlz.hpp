@@ -0,0 +1,31 @@
+#ifndef PRACTICA1_INDEXLZ_HPP
+#define PRACTICA1_INDEXLZ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Compresión sin pérdida del flujo de índices CPPM ya codificado (bytes o empaquetado),
+// pensada para capturas e imágenes sintéticas con muchas repeticiones. El resultado es una
+// serie de secuencias, cada una con:
+//   varint  literales   bytes copiados tal cual
+//   bytes   literales
+//   varint  longitud    bytes repetidos desde atrás (0 solo en la última secuencia)
+//   varint  distancia   cuántos bytes atrás empieza la repetición (solo si longitud > 0)
+// Los varint son LEB128 (7 bits por byte, el menos significativo primero). Una repetición
+// puede solaparse consigo misma, así que una racha de un mismo índice es una repetición a
+// distancia de un índice.
+//
+// Para cada posición se prueban tres candidatos y se queda el más largo: la racha (a
+// `unit` bytes), la fila anterior (a `row` bytes, si no es 0) y la última aparición de los
+// mismos MIN_MATCH bytes según una tabla hash.
+constexpr std::size_t LZ_MIN_MATCH = 4;
+
+[[nodiscard]] std::vector<uint8_t> lzCompress(std::span<const uint8_t> input, std::size_t unit, std::size_t row);
+
+// Descomprime `input` en `output`, que debe tener exactamente el tamaño original. Devuelve
+// false, sin lanzar, si los datos están mal formados o no llenan `output` justo.
+[[nodiscard]] bool lzDecompress(std::span<const uint8_t> input, std::span<uint8_t> output);
+
+#endif // PRACTICA1_INDEXLZ_HPP
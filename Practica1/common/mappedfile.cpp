@@ -0,0 +1,130 @@
+#include "mappedfile.hpp"
+#include "sharedmemory.hpp"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+    // Tamaño de cada lectura cuando la entrada es una tubería
+    constexpr std::size_t READ_CHUNK_SIZE = static_cast<std::size_t>(1) << 20;
+}
+
+MappedFile::MappedFile(const std::string &filePath) {
+    const bool estandar = isStandardStream(filePath);
+    int descriptor = STDIN_FILENO;
+    if (isSharedMemory(filePath)) {
+        // Un segmento de memoria compartida se proyecta igual que un archivo regular
+        descriptor = ::shm_open(sharedMemoryName(filePath).c_str(), O_RDONLY, 0);
+    } else if (!estandar) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+        descriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (descriptor < 0) {
+        throw std::runtime_error("Error al abrir el archivo");
+    }
+    // La entrada estándar no es nuestra: no se cierra
+    const auto cerrar = [descriptor, estandar]() {
+        if (!estandar) {
+            ::close(descriptor);
+        }
+    };
+
+    struct stat info{};
+    if (::fstat(descriptor, &info) != 0) {
+        cerrar();
+        throw std::runtime_error("Error al abrir el archivo");
+    }
+
+    // Una tubería o un terminal no se pueden proyectar: se leen a memoria
+    if (!S_ISREG(info.st_mode)) {
+        try {
+            readAll(descriptor);
+        } catch (...) {
+            cerrar();
+            throw;
+        }
+        cerrar();
+        return;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+
+    // Un archivo vacío no se puede proyectar; se expone como un rango vacío
+    if (length > 0) {
+        void *address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (address == MAP_FAILED) {
+            cerrar();
+            throw std::runtime_error("Error al proyectar el archivo en memoria: " + filePath);
+        }
+        // El acceso es secuencial: el kernel puede leer por adelantado y liberar lo ya leído
+        ::madvise(address, length, MADV_SEQUENTIAL);
+        mapping = static_cast<const uint8_t *>(address);
+    }
+
+    // Un segmento de memoria compartida se consume al leerlo: se elimina su nombre para que
+    // no siga ocupando memoria, y la proyección lo mantiene vivo hasta que se libera
+    if (isSharedMemory(filePath)) {
+        ::shm_unlink(sharedMemoryName(filePath).c_str());
+    }
+
+    // La proyección se mantiene válida después de cerrar el descriptor
+    cerrar();
+}
+
+void MappedFile::readAll(const int descriptor) {
+    std::size_t leidos = 0;
+    while (true) {
+        contents.resize(leidos + READ_CHUNK_SIZE);
+        const ssize_t resultado = ::read(descriptor, std::span(contents).subspan(leidos).data(), READ_CHUNK_SIZE);
+        if (resultado < 0 && errno == EINTR) {
+            continue;
+        }
+        if (resultado < 0) {
+            throw std::runtime_error("Error al leer la entrada");
+        }
+        if (resultado == 0) {
+            break;
+        }
+        leidos += static_cast<std::size_t>(resultado);
+    }
+    contents.resize(leidos);
+    length = leidos;
+}
+
+std::span<const uint8_t> MappedFile::data() const {
+    if (mapping == nullptr) {
+        return contents;
+    }
+    return {mapping, length};
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mapping(std::exchange(other.mapping, nullptr)), length(std::exchange(other.length, 0)),
+      contents(std::move(other.contents)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        unmap();
+        mapping = std::exchange(other.mapping, nullptr);
+        length = std::exchange(other.length, 0);
+        contents = std::move(other.contents);
+    }
+    return *this;
+}
+
+void MappedFile::unmap() noexcept {
+    if (mapping != nullptr) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        ::munmap(const_cast<uint8_t *>(mapping), length);
+        mapping = nullptr;
+        length = 0;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PRACTICA1_MAPPEDFILE_HPP
+#define PRACTICA1_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ruta que designa la entrada o la salida estándar
+constexpr std::string_view STANDARD_STREAM_PATH = "-";
+
+[[nodiscard]] inline bool isStandardStream(const std::string &filePath) {
+    return filePath == STANDARD_STREAM_PATH;
+}
+
+// Proyección en memoria (mmap) de solo lectura de un archivo completo.
+// Permite parsear y copiar los datos directamente desde las páginas del archivo
+// sin pasar por un búfer intermedio. Con "-" se usa la entrada estándar: se proyecta
+// si es un archivo redirigido y, si es una tubería, se lee entera por bloques grandes.
+// Con "shm:nombre" se proyecta el segmento de memoria compartida POSIX de ese nombre y se
+// elimina (shm_unlink): cada segmento lo consume un único lector.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &filePath);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Contenido completo del archivo proyectado
+    [[nodiscard]] std::span<const uint8_t> data() const;
+
+    [[nodiscard]] std::size_t size() const { return length; }
+
+private:
+    void unmap() noexcept;
+
+    // Lee el descriptor hasta el final cuando no admite mmap
+    void readAll(int descriptor);
+
+    const uint8_t *mapping = nullptr;
+    std::size_t length = 0;
+    std::vector<uint8_t> contents; // Solo para entradas que no se pueden proyectar
+};
+
+#endif // PRACTICA1_MAPPEDFILE_HPP
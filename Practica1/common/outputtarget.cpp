@@ -0,0 +1,77 @@
+#include "outputtarget.hpp"
+#include "mappedfile.hpp"
+#include "sharedmemory.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    constexpr mode_t PERMISSION_BITS = 07777;
+
+    // stat de una ruta de entrada; "-" es la entrada estándar
+    bool estadoEntrada(const std::string &path, struct stat &info) {
+        if (isStandardStream(path)) {
+            return ::fstat(STDIN_FILENO, &info) == 0;
+        }
+        return !isSharedMemory(path) && ::stat(path.c_str(), &info) == 0;
+    }
+}
+
+bool isSameFile(const std::string &inputFile, const std::string &outputFile) {
+    if (isStandardStream(outputFile) || isSharedMemory(outputFile)) {
+        return false;
+    }
+    struct stat entrada{};
+    struct stat salida{};
+    if (!estadoEntrada(inputFile, entrada) || ::stat(outputFile.c_str(), &salida) != 0) {
+        return false;
+    }
+    return S_ISREG(entrada.st_mode) && entrada.st_dev == salida.st_dev && entrada.st_ino == salida.st_ino;
+}
+
+OutputTarget::OutputTarget(const std::string &inputFile, const std::string &outputFile) : ruta(outputFile) {
+    if (!isSameFile(inputFile, outputFile)) {
+        return;
+    }
+
+    // El temporal va junto al archivo real (tras resolver enlaces) para que rename no
+    // cambie de sistema de archivos
+    destino = std::filesystem::canonical(outputFile).string();
+    const std::string plantilla = destino + ".XXXXXX";
+    std::vector<char> nombre(plantilla.begin(), plantilla.end());
+    nombre.push_back('\0');
+    const int descriptor = ::mkstemp(nombre.data());
+    if (descriptor < 0) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+    ruta = nombre.data();
+
+    struct stat info{};
+    const bool permisos = ::stat(destino.c_str(), &info) == 0 && ::fchmod(descriptor, info.st_mode & PERMISSION_BITS) == 0;
+    ::close(descriptor);
+    if (!permisos) {
+        std::remove(ruta.c_str());
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+}
+
+OutputTarget::~OutputTarget() {
+    if (!destino.empty()) {
+        std::remove(ruta.c_str());
+    }
+}
+
+void OutputTarget::commit() {
+    if (destino.empty()) {
+        return;
+    }
+    if (std::rename(ruta.c_str(), destino.c_str()) != 0) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+    destino.clear();
+}
@@ -0,0 +1,36 @@
+#ifndef PRACTICA1_OUTPUTTARGET_HPP
+#define PRACTICA1_OUTPUTTARGET_HPP
+
+#include <string>
+
+// Indica si `inputFile` y `outputFile` son el mismo archivo (mismo st_dev y st_ino): por
+// ejemplo la misma ruta, un enlace o, con "-", la entrada estándar redirigida desde la
+// salida. La salida estándar y la memoria compartida nunca coinciden con un archivo.
+[[nodiscard]] bool isSameFile(const std::string &inputFile, const std::string &outputFile);
+
+// Ruta en la que escribir la salida mientras la entrada sigue proyectada o a medio leer.
+// Si ambas son el mismo archivo, abrir la salida truncaría lo que aún se está leyendo: se
+// escribe entonces en un temporal del mismo directorio (con los permisos de la entrada)
+// que commit() renombra sobre ella. En otro caso path() es la salida tal cual.
+class OutputTarget {
+public:
+    OutputTarget(const std::string &inputFile, const std::string &outputFile);
+    // Borra el temporal si no se ha llegado a commit()
+    ~OutputTarget();
+
+    OutputTarget(const OutputTarget &) = delete;
+    OutputTarget &operator=(const OutputTarget &) = delete;
+    OutputTarget(OutputTarget &&) = delete;
+    OutputTarget &operator=(OutputTarget &&) = delete;
+
+    [[nodiscard]] const std::string &path() const { return ruta; }
+
+    // Sustituye la salida por el temporal una vez escrito por completo
+    void commit();
+
+private:
+    std::string ruta;
+    std::string destino; // Vacío si se escribe directamente en la salida
+};
+
+#endif // PRACTICA1_OUTPUTTARGET_HPP
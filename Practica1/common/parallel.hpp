@@ -0,0 +1,64 @@
+#ifndef PRACTICA1_PARALLEL_HPP
+#define PRACTICA1_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <execution>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+// Píxeles aproximados que procesa cada tarea paralela
+constexpr std::size_t PARALLEL_GRAIN_PIXELS = 65536;
+
+// Filas por tarea para que cada una trabaje sobre unos PARALLEL_GRAIN_PIXELS píxeles
+inline std::size_t rowsPerTask(const std::size_t width) {
+    return std::max<std::size_t>(1, PARALLEL_GRAIN_PIXELS / std::max<std::size_t>(1, width));
+}
+
+// Divide [0, count) en rangos consecutivos de `grain` elementos y llama a
+// function(first, last) para cada uno en paralelo. La función no debe lanzar excepciones.
+template <typename Function>
+void parallelForRanges(const std::size_t count, const std::size_t grain, Function &&function) {
+    const std::size_t paso = std::max<std::size_t>(1, grain);
+    std::vector<std::size_t> rangos((count + paso - 1) / paso);
+    std::iota(rangos.begin(), rangos.end(), std::size_t{0});
+
+    std::for_each(std::execution::par, rangos.begin(), rangos.end(), [&function, count, paso](const std::size_t rango) {
+        const std::size_t first = rango * paso;
+        function(first, std::min(count, first + paso));
+    });
+}
+
+// Llama a function(i) para cada i de [0, count) en paralelo, una tarea por elemento. A
+// diferencia de parallelForRanges la función puede lanzar: se esperan todas las tareas y
+// después se relanza la excepción del menor índice que haya fallado. Solo se conserva esa:
+// sin memoria cada excepción viva ocupa la reserva de emergencia del runtime, y guardar una
+// por tarea la agotaría y acabaría en std::terminate.
+template <typename Function>
+void parallelForEach(const std::size_t count, Function &&function) {
+    std::vector<std::size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), std::size_t{0});
+    std::exception_ptr error;
+    std::size_t indiceError = count;
+    std::mutex cerrojo;
+
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](const std::size_t indice) {
+        try {
+            function(indice);
+        } catch (...) {
+            const std::lock_guard<std::mutex> bloqueo(cerrojo);
+            if (indice < indiceError) {
+                indiceError = indice;
+                error = std::current_exception();
+            }
+        }
+    });
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif // PRACTICA1_PARALLEL_HPP
@@ -0,0 +1,890 @@
+#include "pixelkernels.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <execution>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    constexpr std::size_t CANALES = 3;
+    constexpr std::size_t CANALES_RGBA = 4;
+    constexpr int BYTE_SHIFT = 8;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t BYTES_REGISTRO = 16;
+    constexpr int8_t DESCARTAR = -128; // pshufb pone a cero los bytes con el bit alto activo
+
+    // Máscaras pshufb indexadas por [canal][registro]: llevan a cada byte de salida el byte
+    // de la entrada que le corresponde si está en ese registro, o cero si está en otro.
+    using Mascara = std::array<int8_t, BYTES_REGISTRO>;
+    using TablaMascaras = std::array<std::array<Mascara, CANALES>, CANALES>;
+
+    // origen(canal, byte) devuelve la posición global (en los 48 bytes de entrada) del byte
+    // que debe acabar en la posición `byte` del registro de salida del canal
+    template <typename Origen>
+    constexpr TablaMascaras construirMascaras(Origen origen) {
+        TablaMascaras tabla{};
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            for (std::size_t registro = 0; registro < CANALES; ++registro) {
+                for (std::size_t byte = 0; byte < BYTES_REGISTRO; ++byte) {
+                    const std::size_t global = origen(canal, byte);
+                    tabla[canal][registro][byte] = (global / BYTES_REGISTRO == registro)
+                                                           ? static_cast<int8_t>(global % BYTES_REGISTRO)
+                                                           : DESCARTAR;
+                }
+            }
+        }
+        return tabla;
+    }
+
+    // 8 bits: 16 píxeles por bloque, el byte j del canal c es el byte 3j + c de la entrada
+    constexpr TablaMascaras SEPARAR_8 = construirMascaras([](const std::size_t canal, const std::size_t byte) {
+        return (CANALES * byte) + canal;
+    });
+
+    // 16 bits: 8 píxeles por bloque; cada muestra big-endian se invierte al colocarla
+    constexpr TablaMascaras SEPARAR_16 = construirMascaras([](const std::size_t canal, const std::size_t byte) {
+        const std::size_t muestra = (CANALES * (byte / 2)) + canal;
+        return (2 * muestra) + 1 - (byte % 2);
+    });
+
+    // Máscaras para intercalar, indexadas por [registro de salida][canal]. fuente(global)
+    // devuelve el canal y el byte dentro del registro de ese canal que acaban en la posición
+    // `global` de los 48 bytes de salida
+    template <typename Fuente>
+    constexpr TablaMascaras construirMascarasIntercalado(Fuente fuente) {
+        TablaMascaras tabla{};
+        for (std::size_t registro = 0; registro < CANALES; ++registro) {
+            for (std::size_t canal = 0; canal < CANALES; ++canal) {
+                for (std::size_t byte = 0; byte < BYTES_REGISTRO; ++byte) {
+                    const auto [canalFuente, posicion] = fuente((registro * BYTES_REGISTRO) + byte);
+                    tabla[registro][canal][byte] = (canalFuente == canal) ? static_cast<int8_t>(posicion)
+                                                                          : DESCARTAR;
+                }
+            }
+        }
+        return tabla;
+    }
+
+    struct ByteFuente {
+        std::size_t canal;
+        std::size_t posicion;
+    };
+
+    // 8 bits: el byte g de la salida es el canal g % 3 del píxel g / 3
+    constexpr TablaMascaras INTERCALAR_8 = construirMascarasIntercalado([](const std::size_t global) {
+        return ByteFuente{.canal = global % CANALES, .posicion = global / CANALES};
+    });
+
+    // 16 bits: cada muestra se escribe con el byte más significativo primero
+    constexpr TablaMascaras INTERCALAR_16 = construirMascarasIntercalado([](const std::size_t global) {
+        const std::size_t muestra = global / 2;
+        return ByteFuente{.canal = muestra % CANALES, .posicion = (2 * (muestra / CANALES)) + 1 - (global % 2)};
+    });
+
+    __m128i cargar(const void *origen) {
+        return _mm_loadu_si128(static_cast<const __m128i *>(origen));
+    }
+
+    // Tres registros consecutivos de la entrada, o las tres máscaras de un canal
+    struct Trio128 {
+        __m128i primero;
+        __m128i segundo;
+        __m128i tercero;
+    };
+
+    Trio128 cargarTrio(const uint8_t *origen) {
+        return {.primero = cargar(origen), .segundo = cargar(origen + BYTES_REGISTRO),
+                .tercero = cargar(origen + (2 * BYTES_REGISTRO))};
+    }
+
+    // Aplica a cada registro su máscara y combina el resultado: al separar, los registros son
+    // el bloque intercalado y las máscaras las de un canal; al intercalar, los registros son
+    // los tres canales y las máscaras las de un registro de salida
+    __m128i combinarRegistros(const Trio128 &bloque, const Trio128 &mascaras) {
+        return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(bloque.primero, mascaras.primero),
+                                         _mm_shuffle_epi8(bloque.segundo, mascaras.segundo)),
+                            _mm_shuffle_epi8(bloque.tercero, mascaras.tercero));
+    }
+
+    std::array<Trio128, CANALES> cargarMascaras(const TablaMascaras &tabla) {
+        std::array<Trio128, CANALES> mascaras{};
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            mascaras[canal] = {.primero = cargar(tabla[canal][0].data()), .segundo = cargar(tabla[canal][1].data()),
+                               .tercero = cargar(tabla[canal][2].data())};
+        }
+        return mascaras;
+    }
+
+#if defined(__AVX2__)
+    struct Trio256 {
+        __m256i primero;
+        __m256i segundo;
+        __m256i tercero;
+    };
+
+    __m256i cargarPar(const uint8_t *bajo, const uint8_t *alto) {
+        return _mm256_inserti128_si256(_mm256_castsi128_si256(cargar(bajo)), cargar(alto), 1);
+    }
+
+    // Carga dos bloques de 48 bytes consecutivos: el primero en la mitad baja de cada
+    // registro y el segundo en la alta, para aplicar las mismas máscaras en ambas mitades
+    Trio256 cargarDosBloques(const uint8_t *origen) {
+        constexpr std::size_t BLOQUE = CANALES * BYTES_REGISTRO;
+        return {.primero = cargarPar(origen, origen + BLOQUE),
+                .segundo = cargarPar(origen + BYTES_REGISTRO, origen + BLOQUE + BYTES_REGISTRO),
+                .tercero = cargarPar(origen + (2 * BYTES_REGISTRO), origen + BLOQUE + (2 * BYTES_REGISTRO))};
+    }
+
+    Trio256 ampliarMascaras(const Trio128 &mascaras) {
+        return {.primero = _mm256_broadcastsi128_si256(mascaras.primero),
+                .segundo = _mm256_broadcastsi128_si256(mascaras.segundo),
+                .tercero = _mm256_broadcastsi128_si256(mascaras.tercero)};
+    }
+
+    // Escribe 96 bytes consecutivos a partir de tres registros cuyas mitades bajas forman el
+    // primer bloque de 48 bytes y las altas el segundo
+    void guardarDosBloques(uint8_t *destino, const Trio256 &salida) {
+        auto *registros = reinterpret_cast<__m256i *>(destino);
+        _mm256_storeu_si256(registros, _mm256_permute2x128_si256(salida.primero, salida.segundo, 0x20));
+        _mm256_storeu_si256(registros + 1, _mm256_permute2x128_si256(salida.tercero, salida.primero, 0x30));
+        _mm256_storeu_si256(registros + 2, _mm256_permute2x128_si256(salida.segundo, salida.tercero, 0x31));
+    }
+
+    __m256i combinarRegistros(const Trio256 &bloque, const Trio256 &mascaras) {
+        return _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(bloque.primero, mascaras.primero),
+                                               _mm256_shuffle_epi8(bloque.segundo, mascaras.segundo)),
+                               _mm256_shuffle_epi8(bloque.tercero, mascaras.tercero));
+    }
+#endif
+#endif
+
+    void deinterleaveRGB8Escalar(const uint8_t *raster, uint16_t *red, uint16_t *green, uint16_t *blue,
+                                 const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            red[i] = raster[i * CANALES];
+            green[i] = raster[(i * CANALES) + 1];
+            blue[i] = raster[(i * CANALES) + 2];
+        }
+    }
+
+    void interleaveRGB8Escalar(const uint16_t *red, const uint16_t *green, const uint16_t *blue, uint8_t *raster,
+                               const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            raster[i * CANALES] = static_cast<uint8_t>(red[i]);
+            raster[(i * CANALES) + 1] = static_cast<uint8_t>(green[i]);
+            raster[(i * CANALES) + 2] = static_cast<uint8_t>(blue[i]);
+        }
+    }
+
+    void interleaveRGB16BEEscalar(const uint16_t *red, const uint16_t *green, const uint16_t *blue, uint8_t *raster,
+                                  const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            uint8_t *pixel = raster + (i * CANALES * 2);
+            pixel[0] = static_cast<uint8_t>(red[i] >> BYTE_SHIFT);
+            pixel[1] = static_cast<uint8_t>(red[i]);
+            pixel[2] = static_cast<uint8_t>(green[i] >> BYTE_SHIFT);
+            pixel[3] = static_cast<uint8_t>(green[i]);
+            pixel[4] = static_cast<uint8_t>(blue[i] >> BYTE_SHIFT);
+            pixel[5] = static_cast<uint8_t>(blue[i]);
+        }
+    }
+
+    void loadSamples16BEEscalar(const uint8_t *raster, uint16_t *samples, const std::size_t first,
+                                const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            samples[i] = static_cast<uint16_t>((raster[2 * i] << BYTE_SHIFT) | raster[(2 * i) + 1]);
+        }
+    }
+
+    void storeSamples16BEEscalar(const uint16_t *samples, uint8_t *raster, const std::size_t first,
+                                 const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            raster[2 * i] = static_cast<uint8_t>(samples[i] >> BYTE_SHIFT);
+            raster[(2 * i) + 1] = static_cast<uint8_t>(samples[i]);
+        }
+    }
+
+    void deinterleaveRGB16BEEscalar(const uint8_t *raster, uint16_t *red, uint16_t *green, uint16_t *blue,
+                                    const std::size_t first, const std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            const uint8_t *pixel = raster + (i * CANALES * 2);
+            red[i] = static_cast<uint16_t>((pixel[0] << BYTE_SHIFT) | pixel[1]);
+            green[i] = static_cast<uint16_t>((pixel[2] << BYTE_SHIFT) | pixel[3]);
+            blue[i] = static_cast<uint16_t>((pixel[4] << BYTE_SHIFT) | pixel[5]);
+        }
+    }
+}
+
+// NOLINTBEGIN(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
+void deinterleaveRGB8(std::span<const uint8_t> raster, std::span<uint16_t> red,
+                      std::span<uint16_t> green, std::span<uint16_t> blue) {
+    const std::size_t total = red.size();
+    const uint8_t *origen = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t PIXELES_BLOQUE = BYTES_REGISTRO;
+    const auto mascaras = cargarMascaras(SEPARAR_8);
+    std::array<uint16_t *, CANALES> planos = {red.data(), green.data(), blue.data()};
+
+#if defined(__AVX2__)
+    const std::array<Trio256, CANALES> mascaras256 = {ampliarMascaras(mascaras[0]), ampliarMascaras(mascaras[1]),
+                                                      ampliarMascaras(mascaras[2])};
+    // Dos bloques de 16 píxeles por iteración; cada canal se amplía a 16 bits con vpmovzxbw
+    for (; i + (2 * PIXELES_BLOQUE) <= total; i += 2 * PIXELES_BLOQUE) {
+        const Trio256 bloque = cargarDosBloques(origen + (i * CANALES));
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            const __m256i bytes = combinarRegistros(bloque, mascaras256[canal]);
+            auto *destino = reinterpret_cast<__m256i *>(planos[canal] + i);
+            _mm256_storeu_si256(destino, _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+            _mm256_storeu_si256(destino + 1, _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+        }
+    }
+#endif
+    const __m128i cero = _mm_setzero_si128();
+    for (; i + PIXELES_BLOQUE <= total; i += PIXELES_BLOQUE) {
+        const Trio128 bloque = cargarTrio(origen + (i * CANALES));
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            const __m128i bytes = combinarRegistros(bloque, mascaras[canal]);
+            auto *destino = reinterpret_cast<__m128i *>(planos[canal] + i);
+            _mm_storeu_si128(destino, _mm_unpacklo_epi8(bytes, cero));
+            _mm_storeu_si128(destino + 1, _mm_unpackhi_epi8(bytes, cero));
+        }
+    }
+#endif
+
+    deinterleaveRGB8Escalar(origen, red.data(), green.data(), blue.data(), i, total);
+}
+
+void deinterleaveRGB16BE(std::span<const uint8_t> raster, std::span<uint16_t> red,
+                         std::span<uint16_t> green, std::span<uint16_t> blue) {
+    const std::size_t total = red.size();
+    const uint8_t *origen = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t PIXELES_BLOQUE = BYTES_REGISTRO / 2;
+    const auto mascaras = cargarMascaras(SEPARAR_16);
+    std::array<uint16_t *, CANALES> planos = {red.data(), green.data(), blue.data()};
+
+#if defined(__AVX2__)
+    const std::array<Trio256, CANALES> mascaras256 = {ampliarMascaras(mascaras[0]), ampliarMascaras(mascaras[1]),
+                                                      ampliarMascaras(mascaras[2])};
+    // Dos bloques de 8 píxeles por iteración; las máscaras ya intercambian los bytes de cada muestra
+    for (; i + (2 * PIXELES_BLOQUE) <= total; i += 2 * PIXELES_BLOQUE) {
+        const Trio256 bloque = cargarDosBloques(origen + (i * CANALES * 2));
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(planos[canal] + i), combinarRegistros(bloque, mascaras256[canal]));
+        }
+    }
+#endif
+    for (; i + PIXELES_BLOQUE <= total; i += PIXELES_BLOQUE) {
+        const Trio128 bloque = cargarTrio(origen + (i * CANALES * 2));
+        for (std::size_t canal = 0; canal < CANALES; ++canal) {
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(planos[canal] + i), combinarRegistros(bloque, mascaras[canal]));
+        }
+    }
+#endif
+
+    deinterleaveRGB16BEEscalar(origen, red.data(), green.data(), blue.data(), i, total);
+}
+
+void loadSamples16BE(std::span<const uint8_t> raster, std::span<uint16_t> samples) {
+    const std::size_t total = samples.size();
+    const uint8_t *origen = raster.data();
+    uint16_t *destino = samples.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t MUESTRAS_REGISTRO = BYTES_REGISTRO / 2;
+    // Intercambia los dos bytes de cada muestra
+    const __m128i intercambio = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+#if defined(__AVX2__)
+    const __m256i intercambio256 = _mm256_broadcastsi128_si256(intercambio);
+    for (; i + (2 * MUESTRAS_REGISTRO) <= total; i += 2 * MUESTRAS_REGISTRO) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(origen + (2 * i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destino + i), _mm256_shuffle_epi8(bytes, intercambio256));
+    }
+#endif
+    for (; i + MUESTRAS_REGISTRO <= total; i += MUESTRAS_REGISTRO) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destino + i),
+                         _mm_shuffle_epi8(cargar(origen + (2 * i)), intercambio));
+    }
+#endif
+
+    loadSamples16BEEscalar(origen, destino, i, total);
+}
+
+void storeSamples16BE(std::span<const uint16_t> samples, std::span<uint8_t> raster) {
+    const std::size_t total = samples.size();
+    const uint16_t *origen = samples.data();
+    uint8_t *destino = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t MUESTRAS_REGISTRO = BYTES_REGISTRO / 2;
+    // El intercambio de bytes es su propia inversa: la misma máscara que en la carga
+    const __m128i intercambio = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+
+#if defined(__AVX2__)
+    const __m256i intercambio256 = _mm256_broadcastsi128_si256(intercambio);
+    for (; i + (2 * MUESTRAS_REGISTRO) <= total; i += 2 * MUESTRAS_REGISTRO) {
+        const __m256i muestras = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(origen + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destino + (2 * i)), _mm256_shuffle_epi8(muestras, intercambio256));
+    }
+#endif
+    for (; i + MUESTRAS_REGISTRO <= total; i += MUESTRAS_REGISTRO) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destino + (2 * i)), _mm_shuffle_epi8(cargar(origen + i), intercambio));
+    }
+#endif
+
+    storeSamples16BEEscalar(origen, destino, i, total);
+}
+
+void widenSamples8(std::span<const uint8_t> raster, std::span<uint16_t> samples) {
+    const std::size_t total = samples.size();
+    const uint8_t *origen = raster.data();
+    uint16_t *destino = samples.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+#if defined(__AVX2__)
+    for (; i + BYTES_REGISTRO <= total; i += BYTES_REGISTRO) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destino + i), _mm256_cvtepu8_epi16(cargar(origen + i)));
+    }
+#endif
+    // Intercalar con ceros amplía cada byte a 16 bits
+    const __m128i ceros = _mm_setzero_si128();
+    for (; i + BYTES_REGISTRO <= total; i += BYTES_REGISTRO) {
+        const __m128i bytes = cargar(origen + i);
+        auto *salida = reinterpret_cast<__m128i *>(destino + i);
+        _mm_storeu_si128(salida, _mm_unpacklo_epi8(bytes, ceros));
+        _mm_storeu_si128(salida + 1, _mm_unpackhi_epi8(bytes, ceros));
+    }
+#endif
+
+    for (; i < total; ++i) {
+        destino[i] = origen[i];
+    }
+}
+
+void narrowSamples8(std::span<const uint16_t> samples, std::span<uint8_t> raster) {
+    const std::size_t total = samples.size();
+    const uint16_t *origen = samples.data();
+    uint8_t *destino = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t MUESTRAS_REGISTRO = BYTES_REGISTRO / 2;
+#if defined(__AVX2__)
+    // packus reduce a bytes por mitades de 128 bits, de ahí la permutación posterior
+    for (; i + (4 * MUESTRAS_REGISTRO) <= total; i += 4 * MUESTRAS_REGISTRO) {
+        const auto *entrada = reinterpret_cast<const __m256i *>(origen + i);
+        const __m256i bytes = _mm256_packus_epi16(_mm256_loadu_si256(entrada), _mm256_loadu_si256(entrada + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destino + i), _mm256_permute4x64_epi64(bytes, 0xD8));
+    }
+#endif
+    for (; i + (2 * MUESTRAS_REGISTRO) <= total; i += 2 * MUESTRAS_REGISTRO) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destino + i),
+                         _mm_packus_epi16(cargar(origen + i), cargar(origen + i + MUESTRAS_REGISTRO)));
+    }
+#endif
+
+    for (; i < total; ++i) {
+        destino[i] = static_cast<uint8_t>(origen[i]);
+    }
+}
+
+void scaleSamples(std::span<uint16_t> samples, const float factor) {
+    const std::size_t total = samples.size();
+    uint16_t *datos = samples.data();
+    std::size_t i = 0;
+
+#if defined(__SSE4_1__)
+    // round_ps redondea las mitades al par: se trunca y se suma 1 si la parte fraccionaria
+    // llega a 0.5, que para valores positivos es exactamente std::round
+    const auto redondear = [](const __m128 valor) {
+        const __m128 truncado = _mm_round_ps(valor, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const __m128 mitad = _mm_cmpge_ps(_mm_sub_ps(valor, truncado), _mm_set1_ps(0.5F));
+        return _mm_cvttps_epi32(_mm_add_ps(truncado, _mm_and_ps(mitad, _mm_set1_ps(1.0F))));
+    };
+    const __m128 factor128 = _mm_set1_ps(factor);
+
+#if defined(__AVX2__)
+    const __m256 factor256 = _mm256_set1_ps(factor);
+    for (; i + 8 <= total; i += 8) {
+        const __m256 valor = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(cargar(datos + i))), factor256);
+        const __m128i bajo = redondear(_mm256_castps256_ps128(valor));
+        const __m128i alto = redondear(_mm256_extractf128_ps(valor, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(datos + i), _mm_packus_epi32(bajo, alto));
+    }
+#endif
+    for (; i + 4 <= total; i += 4) {
+        const __m128i muestras = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(datos + i)));
+        const __m128i escaladas = redondear(_mm_mul_ps(_mm_cvtepi32_ps(muestras), factor128));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(datos + i), _mm_packus_epi32(escaladas, escaladas));
+    }
+#endif
+
+    for (; i < total; ++i) {
+        datos[i] = static_cast<uint16_t>(std::round(static_cast<float>(datos[i]) * factor));
+    }
+}
+
+void checkSampleRange(const std::span<const uint16_t> samples, const int maxColorValue) {
+    constexpr int MAX_COLOR_8_BIT = 255;
+    constexpr int MAX_COLOR_16_BIT = 65535;
+    if (maxColorValue == MAX_COLOR_8_BIT || maxColorValue == MAX_COLOR_16_BIT) {
+        return;
+    }
+    const auto limite = static_cast<uint16_t>(maxColorValue);
+    if (std::any_of(std::execution::par_unseq, samples.begin(), samples.end(),
+                    [limite](const uint16_t muestra) { return muestra > limite; })) {
+        throw std::runtime_error("Valor de muestra fuera de rango");
+    }
+}
+
+unsigned resizeWeightBits(const int maxColorValue) {
+    constexpr int MAX_COLOR_8_BIT = 255;
+    constexpr unsigned BITS_8 = 8;
+    constexpr unsigned BITS_16 = 16;
+    return maxColorValue <= MAX_COLOR_8_BIT ? BITS_8 : BITS_16;
+}
+
+ResizeColumn fixedResizeColumn(const std::size_t left, const std::size_t right, const float delta,
+                               const unsigned bits) {
+    const uint32_t escala = 1U << bits;
+    if (right == left) {
+        // Sin segunda muestra: en el borde se toma la pareja anterior con todo el peso en la
+        // derecha, y con una sola muestra el peso es nulo
+        return left == 0 ? ResizeColumn{.left = 0, .weight = 0}
+                         : ResizeColumn{.left = static_cast<uint32_t>(left - 1), .weight = escala};
+    }
+    const auto peso = static_cast<uint32_t>(std::lround(delta * static_cast<float>(escala)));
+    return {.left = static_cast<uint32_t>(left), .weight = std::min(peso, escala)};
+}
+
+namespace {
+    // Con pesos de 8 bits la mezcla horizontal (16 bits) se conserva entera y solo se
+    // redondea al final; con 16 bits se reduce a 16 bits para que la vertical quepa en 32
+    constexpr unsigned BITS_PESO_8 = 8;
+    inline unsigned recorteHorizontal(const unsigned bits) {
+        return bits <= BITS_PESO_8 ? 0 : bits;
+    }
+
+    // Divide entre 2^desplazamiento redondeando al más cercano (las mitades hacia arriba)
+    inline uint32_t redondear(const uint32_t valor, const unsigned desplazamiento) {
+        return desplazamiento == 0 ? valor : (valor + (1U << (desplazamiento - 1))) >> desplazamiento;
+    }
+
+    inline uint32_t redondeoDe(const unsigned desplazamiento) {
+        return desplazamiento == 0 ? 0 : 1U << (desplazamiento - 1);
+    }
+
+    // primera * (2^bits - peso) + segunda * peso
+    inline uint32_t mezclarFijo(const uint32_t primera, const uint32_t segunda, const uint32_t peso,
+                                const unsigned bits) {
+        return (primera * ((1U << bits) - peso)) + (segunda * peso);
+    }
+
+    // El número de canales es un parámetro de plantilla para que el bucle interior se desenrolle
+    template <std::size_t CANALES_FILA>
+    void interpolateRowEscalar(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                               std::span<const ResizeColumn> columns, const uint32_t weightY, const unsigned bits,
+                               std::span<uint16_t> out, const std::size_t desde) {
+        const std::size_t muestras = top.size() / CANALES_FILA;
+        const unsigned bitsIntermedios = recorteHorizontal(bits);
+        const unsigned bitsFinales = (2 * bits) - bitsIntermedios;
+        for (std::size_t x = desde; x < columns.size(); ++x) {
+            const ResizeColumn &columna = columns[x];
+            const std::size_t izquierda = columna.left * CANALES_FILA;
+            const std::size_t derecha = nextSample(columna, muestras) * CANALES_FILA;
+            for (std::size_t canal = 0; canal < CANALES_FILA; ++canal) {
+                const uint32_t arriba = redondear(
+                        mezclarFijo(top[izquierda + canal], top[derecha + canal], columna.weight, bits), bitsIntermedios);
+                const uint32_t abajo = redondear(
+                        mezclarFijo(bottom[izquierda + canal], bottom[derecha + canal], columna.weight, bits), bitsIntermedios);
+                out[(x * CANALES_FILA) + canal] = static_cast<uint16_t>(redondear(mezclarFijo(arriba, abajo, weightY, bits), bitsFinales));
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    // Ocho columnas de destino de un plano por iteración. Cada gather lee como un entero de
+    // 32 bits la pareja (fila[left], fila[left + 1]), así que ambas muestras llegan juntas.
+    std::size_t interpolateRowPlano(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                                    std::span<const ResizeColumn> columns, const uint32_t weightY,
+                                    const unsigned bits, std::span<uint16_t> out) {
+        constexpr std::size_t COLUMNAS_BLOQUE = 8;
+        constexpr int MITAD = 16;
+        const unsigned bitsIntermedios = recorteHorizontal(bits);
+        const unsigned bitsFinales = (2 * bits) - bitsIntermedios;
+        const __m256i escala = _mm256_set1_epi32(static_cast<int>(1U << bits));
+        const __m256i redondeoIntermedio = _mm256_set1_epi32(static_cast<int>(redondeoDe(bitsIntermedios)));
+        const __m256i redondeoFinal = _mm256_set1_epi32(static_cast<int>(redondeoDe(bitsFinales)));
+        const __m128i desplazamientoIntermedio = _mm_cvtsi32_si128(static_cast<int>(bitsIntermedios));
+        const __m128i desplazamientoFinal = _mm_cvtsi32_si128(static_cast<int>(bitsFinales));
+        const __m256i pesoAbajo = _mm256_set1_epi32(static_cast<int>(weightY));
+        const __m256i pesoArriba = _mm256_sub_epi32(escala, pesoAbajo);
+        const __m256i mascaraBaja = _mm256_set1_epi32(0xFFFF);
+        // Cada registro de la tabla trae cuatro parejas (left, weight): se separan en mitades
+        const __m256i separar = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+        std::size_t x = 0;
+        for (; x + COLUMNAS_BLOQUE <= columns.size(); x += COLUMNAS_BLOQUE) {
+            const auto *tabla = reinterpret_cast<const __m256i *>(columns.data() + x);
+            const __m256i primeras = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(tabla), separar);
+            const __m256i segundas = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(tabla + 1), separar);
+            const __m256i posiciones = _mm256_permute2x128_si256(primeras, segundas, 0x20);
+            const __m256i pesos = _mm256_permute2x128_si256(primeras, segundas, 0x31);
+            const __m256i complementos = _mm256_sub_epi32(escala, pesos);
+            // Con pesos de 8 bits muestras y pesos caben en 16 bits con signo y madd hace las
+            // dos multiplicaciones y la suma; con 16 bits se separa la pareja y se usa mullo
+            const __m256i paresPesos = _mm256_or_si256(complementos, _mm256_slli_epi32(pesos, MITAD));
+
+            const auto mezclarFila = [&](const uint16_t *fila) {
+                const __m256i pares = _mm256_i32gather_epi32(reinterpret_cast<const int *>(fila), posiciones, 2);
+                const __m256i suma = bits <= BITS_PESO_8
+                        ? _mm256_madd_epi16(pares, paresPesos)
+                        : _mm256_add_epi32(_mm256_mullo_epi32(_mm256_and_si256(pares, mascaraBaja), complementos),
+                                           _mm256_mullo_epi32(_mm256_srli_epi32(pares, MITAD), pesos));
+                return _mm256_srl_epi32(_mm256_add_epi32(suma, redondeoIntermedio), desplazamientoIntermedio);
+            };
+            const __m256i vertical = _mm256_add_epi32(_mm256_mullo_epi32(mezclarFila(top.data()), pesoArriba),
+                                                      _mm256_mullo_epi32(mezclarFila(bottom.data()), pesoAbajo));
+            const __m256i resultado = _mm256_srl_epi32(_mm256_add_epi32(vertical, redondeoFinal), desplazamientoFinal);
+            // packus reduce por mitades de 128 bits: se juntan los dos grupos de cuatro
+            const __m256i empaquetado = _mm256_permute4x64_epi64(_mm256_packus_epi32(resultado, resultado), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data() + x), _mm256_castsi256_si128(empaquetado));
+        }
+        return x;
+    }
+#endif
+
+#if defined(__SSE4_1__)
+    // Un píxel RGBA por iteración: las cuatro muestras de cada vecino ocupan un registro
+    std::size_t interpolateRowRGBA(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                                   std::span<const ResizeColumn> columns, const uint32_t weightY,
+                                   const unsigned bits, std::span<uint16_t> out) {
+        const unsigned bitsIntermedios = recorteHorizontal(bits);
+        const unsigned bitsFinales = (2 * bits) - bitsIntermedios;
+        const uint32_t escala = 1U << bits;
+        const __m128i redondeoIntermedio = _mm_set1_epi32(static_cast<int>(redondeoDe(bitsIntermedios)));
+        const __m128i redondeoFinal = _mm_set1_epi32(static_cast<int>(redondeoDe(bitsFinales)));
+        const __m128i desplazamientoIntermedio = _mm_cvtsi32_si128(static_cast<int>(bitsIntermedios));
+        const __m128i desplazamientoFinal = _mm_cvtsi32_si128(static_cast<int>(bitsFinales));
+        const __m128i pesoAbajo = _mm_set1_epi32(static_cast<int>(weightY));
+        const __m128i pesoArriba = _mm_set1_epi32(static_cast<int>(escala - weightY));
+        const auto cargarPixel = [](const uint16_t *pixel) {
+            return _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(pixel)));
+        };
+
+        for (std::size_t x = 0; x < columns.size(); ++x) {
+            const std::size_t izquierda = columns[x].left * CANALES_RGBA;
+            const __m128i peso = _mm_set1_epi32(static_cast<int>(columns[x].weight));
+            const __m128i complemento = _mm_set1_epi32(static_cast<int>(escala - columns[x].weight));
+            const auto mezclarFila = [&](const uint16_t *fila) {
+                const __m128i suma = _mm_add_epi32(_mm_mullo_epi32(cargarPixel(fila + izquierda), complemento),
+                                                   _mm_mullo_epi32(cargarPixel(fila + izquierda + CANALES_RGBA), peso));
+                return _mm_srl_epi32(_mm_add_epi32(suma, redondeoIntermedio), desplazamientoIntermedio);
+            };
+            const __m128i vertical = _mm_add_epi32(_mm_mullo_epi32(mezclarFila(top.data()), pesoArriba),
+                                                   _mm_mullo_epi32(mezclarFila(bottom.data()), pesoAbajo));
+            const __m128i resultado = _mm_srl_epi32(_mm_add_epi32(vertical, redondeoFinal), desplazamientoFinal);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out.data() + (x * CANALES_RGBA)),
+                             _mm_packus_epi32(resultado, resultado));
+        }
+        return columns.size();
+    }
+#endif
+}
+
+void interpolateRow(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                    std::span<const ResizeColumn> columns, const uint32_t weightY, const unsigned bits,
+                    const std::size_t channels, std::span<uint16_t> out) {
+    static_assert(sizeof(ResizeColumn) == 2 * sizeof(uint32_t), "ResizeColumn debe ser dos uint32_t contiguos");
+    std::size_t x = 0;
+    // Los caminos vectoriales leen siempre left + 1, que solo falta con un origen de una columna
+    [[maybe_unused]] const bool conPareja = top.size() >= 2 * channels;
+#if defined(__AVX2__)
+    if (channels == 1 && conPareja) {
+        x = interpolateRowPlano(top, bottom, columns, weightY, bits, out);
+    }
+#endif
+#if defined(__SSE4_1__)
+    if (channels == CANALES_RGBA && conPareja) {
+        x = interpolateRowRGBA(top, bottom, columns, weightY, bits, out);
+    }
+#endif
+    switch (channels) {
+        case 1:
+            interpolateRowEscalar<1>(top, bottom, columns, weightY, bits, out, x);
+            break;
+        case CANALES:
+            interpolateRowEscalar<CANALES>(top, bottom, columns, weightY, bits, out, x);
+            break;
+        default:
+            interpolateRowEscalar<CANALES_RGBA>(top, bottom, columns, weightY, bits, out, x);
+            break;
+    }
+}
+
+namespace {
+    // Filas que se pueden sumar en enteros de 32 bits sin desbordar
+    constexpr std::size_t MAX_FILAS_SUMA = 65537;
+
+    // Divide la suma de un bloque entre su número de muestras redondeando al más cercano
+    // (las mitades hacia arriba), con un desplazamiento si es potencia de dos
+    struct MediaBloque {
+        uint64_t muestras;
+        bool potenciaDeDos;
+        unsigned desplazamiento;
+
+        explicit MediaBloque(const uint64_t total)
+                : muestras(total), potenciaDeDos(std::has_single_bit(total)),
+                  desplazamiento(static_cast<unsigned>(std::countr_zero(total))) {}
+
+        [[nodiscard]] uint16_t operator()(const uint64_t suma) const {
+            const uint64_t redondeada = suma + (muestras / 2);
+            return static_cast<uint16_t>(potenciaDeDos ? redondeada >> desplazamiento : redondeada / muestras);
+        }
+    };
+
+    // columnas[i] = suma de fila[i] en todas las filas, para i >= inicio. Con AVX2 cada tramo
+    // de 16 columnas se acumula en registros a lo largo de todas las filas y se guarda una vez
+    void sumarFilas(std::span<const std::span<const uint16_t>> rows, const std::size_t inicio,
+                    std::span<uint32_t> columnas) {
+        std::size_t i = inicio;
+#if defined(__AVX2__)
+        constexpr std::size_t COLUMNAS_TRAMO = 16;
+        for (; i + COLUMNAS_TRAMO <= columnas.size(); i += COLUMNAS_TRAMO) {
+            __m256i bajas = _mm256_setzero_si256();
+            __m256i altas = _mm256_setzero_si256();
+            for (const std::span<const uint16_t> fila : rows) {
+                const __m256i muestras = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fila.data() + i));
+                bajas = _mm256_add_epi32(bajas, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(muestras)));
+                altas = _mm256_add_epi32(altas, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(muestras, 1)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(columnas.data() + i), bajas);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(columnas.data() + i + (COLUMNAS_TRAMO / 2)), altas);
+        }
+#endif
+        const std::size_t resto = i;
+        std::fill(columnas.begin() + static_cast<std::ptrdiff_t>(resto), columnas.end(), 0);
+        for (const std::span<const uint16_t> fila : rows) {
+            for (i = resto; i < columnas.size(); ++i) {
+                columnas[i] += fila[i];
+            }
+        }
+    }
+
+    // Suma horizontal de los bloques completos de `factor` columnas ya sumadas en vertical;
+    // en el caso habitual (2) el factor es también un parámetro de plantilla (FACTOR) para
+    // que el bucle se desenrolle
+    template <std::size_t CANALES_FILA, std::size_t FACTOR = 0>
+    void sumarBloques(std::span<const uint32_t> columnas, const std::size_t factor, const MediaBloque &media,
+                      std::span<uint16_t> out, const std::size_t desde, const std::size_t hasta) {
+        const std::size_t pasos = FACTOR == 0 ? factor : FACTOR;
+        for (std::size_t x = desde; x < hasta; ++x) {
+            const uint32_t *bloque = columnas.data() + (x * pasos * CANALES_FILA);
+            for (std::size_t canal = 0; canal < CANALES_FILA; ++canal) {
+                uint64_t suma = 0;
+                for (std::size_t paso = 0; paso < pasos; ++paso) {
+                    suma += bloque[(paso * CANALES_FILA) + canal];
+                }
+                out[(x * CANALES_FILA) + canal] = media(suma);
+            }
+        }
+    }
+
+    // Primero se suman en vertical todas las filas y después cada bloque en horizontal; en el
+    // borde derecho se repite la última columna
+    template <std::size_t CANALES_FILA>
+    void boxReduceRowEscalar(std::span<const std::span<const uint16_t>> rows, const std::size_t factorX,
+                             std::span<uint16_t> out, const std::size_t desde) {
+        const std::size_t ancho = rows.front().size() / CANALES_FILA;
+        const std::size_t salidas = out.size() / CANALES_FILA;
+        const MediaBloque media(rows.size() * factorX);
+        if (desde == salidas) {
+            return;
+        }
+        // Si la suma vertical pudiera desbordar 32 bits (más de 65537 filas) se suma en 64
+        if (rows.size() > MAX_FILAS_SUMA) {
+            for (std::size_t x = desde; x < salidas; ++x) {
+                for (std::size_t canal = 0; canal < CANALES_FILA; ++canal) {
+                    uint64_t suma = 0;
+                    for (const std::span<const uint16_t> fila : rows) {
+                        for (std::size_t paso = 0; paso < factorX; ++paso) {
+                            suma += fila[(std::min((x * factorX) + paso, ancho - 1) * CANALES_FILA) + canal];
+                        }
+                    }
+                    out[(x * CANALES_FILA) + canal] = media(suma);
+                }
+            }
+            return;
+        }
+
+        std::vector<uint32_t> columnas(rows.front().size());
+        sumarFilas(rows, desde * factorX * CANALES_FILA, columnas);
+
+        const std::size_t completas = std::min(salidas, ancho / factorX);
+        if (factorX == 2) {
+            sumarBloques<CANALES_FILA, 2>(columnas, factorX, media, out, desde, completas);
+        } else {
+            sumarBloques<CANALES_FILA>(columnas, factorX, media, out, desde, completas);
+        }
+        // Bloque incompleto del borde derecho
+        for (std::size_t x = std::max(desde, completas); x < salidas; ++x) {
+            for (std::size_t canal = 0; canal < CANALES_FILA; ++canal) {
+                uint64_t suma = 0;
+                for (std::size_t paso = 0; paso < factorX; ++paso) {
+                    suma += columnas[(std::min((x * factorX) + paso, ancho - 1) * CANALES_FILA) + canal];
+                }
+                out[(x * CANALES_FILA) + canal] = media(suma);
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    // Reducción a la mitad de un plano, 16 salidas por iteración: cada entero de 32 bits
+    // contiene una pareja de columnas, cuyas dos mitades se separan y se suman
+    std::size_t halveRowPlano(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                              std::span<uint16_t> out) {
+        constexpr std::size_t SALIDAS_BLOQUE = 16;
+        constexpr int MITAD = 16;
+        constexpr int DESPLAZAMIENTO_MEDIA = 2;
+        const __m256i mascaraBaja = _mm256_set1_epi32(0xFFFF);
+        const __m256i redondeo = _mm256_set1_epi32(2);
+        const auto sumarParejas = [&](const uint16_t *fila) {
+            const __m256i parejas = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fila));
+            return _mm256_add_epi32(_mm256_and_si256(parejas, mascaraBaja), _mm256_srli_epi32(parejas, MITAD));
+        };
+        const auto medias = [&](const std::size_t columna) {
+            const __m256i suma = _mm256_add_epi32(sumarParejas(top.data() + columna), sumarParejas(bottom.data() + columna));
+            return _mm256_srli_epi32(_mm256_add_epi32(suma, redondeo), DESPLAZAMIENTO_MEDIA);
+        };
+
+        // Solo las salidas con su pareja completa en el origen
+        const std::size_t completas = std::min(top.size() / 2, out.size());
+        std::size_t x = 0;
+        for (; x + SALIDAS_BLOQUE <= completas; x += SALIDAS_BLOQUE) {
+            // packus reduce por mitades de 128 bits: la permutación restablece el orden
+            const __m256i empaquetado = _mm256_packus_epi32(medias(2 * x), medias((2 * x) + SALIDAS_BLOQUE));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out.data() + x), _mm256_permute4x64_epi64(empaquetado, 0xD8));
+        }
+        return x;
+    }
+#endif
+}
+
+void boxReduceRow(std::span<const std::span<const uint16_t>> rows, const std::size_t factorX,
+                  const std::size_t channels, std::span<uint16_t> out) {
+    std::size_t x = 0;
+#if defined(__AVX2__)
+    if (channels == 1 && factorX == 2 && rows.size() == 2) {
+        x = halveRowPlano(rows[0], rows[1], out);
+    }
+#endif
+    switch (channels) {
+        case 1:
+            boxReduceRowEscalar<1>(rows, factorX, out, x);
+            break;
+        case CANALES:
+            boxReduceRowEscalar<CANALES>(rows, factorX, out, x);
+            break;
+        default:
+            boxReduceRowEscalar<CANALES_RGBA>(rows, factorX, out, x);
+            break;
+    }
+}
+
+void interleaveRGB8(std::span<const uint16_t> red, std::span<const uint16_t> green,
+                    std::span<const uint16_t> blue, std::span<uint8_t> raster) {
+    const std::size_t total = red.size();
+    uint8_t *destino = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t PIXELES_BLOQUE = BYTES_REGISTRO;
+    const auto mascaras = cargarMascaras(INTERCALAR_8);
+
+#if defined(__AVX2__)
+    const std::array<Trio256, CANALES> mascaras256 = {ampliarMascaras(mascaras[0]), ampliarMascaras(mascaras[1]),
+                                                      ampliarMascaras(mascaras[2])};
+    // Dos bloques de 16 píxeles por iteración: la mitad baja de cada canal alimenta el primero
+    for (; i + (2 * PIXELES_BLOQUE) <= total; i += 2 * PIXELES_BLOQUE) {
+        // packus reduce a bytes por mitades de 128 bits, de ahí la permutación posterior
+        const auto estrechar = [i](const uint16_t *plano) {
+            const auto *origen = reinterpret_cast<const __m256i *>(plano + i);
+            const __m256i bytes = _mm256_packus_epi16(_mm256_loadu_si256(origen), _mm256_loadu_si256(origen + 1));
+            return _mm256_permute4x64_epi64(bytes, 0xD8);
+        };
+        const Trio256 canales = {.primero = estrechar(red.data()), .segundo = estrechar(green.data()),
+                                 .tercero = estrechar(blue.data())};
+        guardarDosBloques(destino + (i * CANALES), {.primero = combinarRegistros(canales, mascaras256[0]),
+                                                    .segundo = combinarRegistros(canales, mascaras256[1]),
+                                                    .tercero = combinarRegistros(canales, mascaras256[2])});
+    }
+#endif
+    for (; i + PIXELES_BLOQUE <= total; i += PIXELES_BLOQUE) {
+        const auto estrechar = [i](const uint16_t *plano) {
+            return _mm_packus_epi16(cargar(plano + i), cargar(plano + i + (PIXELES_BLOQUE / 2)));
+        };
+        const Trio128 canales = {.primero = estrechar(red.data()), .segundo = estrechar(green.data()),
+                                 .tercero = estrechar(blue.data())};
+        auto *salida = reinterpret_cast<__m128i *>(destino + (i * CANALES));
+        for (std::size_t registro = 0; registro < CANALES; ++registro) {
+            _mm_storeu_si128(salida + registro, combinarRegistros(canales, mascaras[registro]));
+        }
+    }
+#endif
+
+    interleaveRGB8Escalar(red.data(), green.data(), blue.data(), destino, i, total);
+}
+
+void interleaveRGB16BE(std::span<const uint16_t> red, std::span<const uint16_t> green,
+                       std::span<const uint16_t> blue, std::span<uint8_t> raster) {
+    const std::size_t total = red.size();
+    uint8_t *destino = raster.data();
+    std::size_t i = 0;
+
+#if defined(__SSSE3__)
+    constexpr std::size_t PIXELES_BLOQUE = BYTES_REGISTRO / 2;
+    const auto mascaras = cargarMascaras(INTERCALAR_16);
+
+#if defined(__AVX2__)
+    const std::array<Trio256, CANALES> mascaras256 = {ampliarMascaras(mascaras[0]), ampliarMascaras(mascaras[1]),
+                                                      ampliarMascaras(mascaras[2])};
+    // 16 píxeles por iteración: cada mitad de un registro de canal ya es un bloque de 8
+    for (; i + (2 * PIXELES_BLOQUE) <= total; i += 2 * PIXELES_BLOQUE) {
+        const Trio256 canales = {.primero = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(red.data() + i)),
+                                 .segundo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(green.data() + i)),
+                                 .tercero = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(blue.data() + i))};
+        guardarDosBloques(destino + (i * CANALES * 2), {.primero = combinarRegistros(canales, mascaras256[0]),
+                                                        .segundo = combinarRegistros(canales, mascaras256[1]),
+                                                        .tercero = combinarRegistros(canales, mascaras256[2])});
+    }
+#endif
+    for (; i + PIXELES_BLOQUE <= total; i += PIXELES_BLOQUE) {
+        const Trio128 canales = {.primero = cargar(red.data() + i), .segundo = cargar(green.data() + i),
+                                 .tercero = cargar(blue.data() + i)};
+        auto *salida = reinterpret_cast<__m128i *>(destino + (i * CANALES * 2));
+        for (std::size_t registro = 0; registro < CANALES; ++registro) {
+            _mm_storeu_si128(salida + registro, combinarRegistros(canales, mascaras[registro]));
+        }
+    }
+#endif
+
+    interleaveRGB16BEEscalar(red.data(), green.data(), blue.data(), destino, i, total);
+}
+// NOLINTEND(cppcoreguidelines-pro-bounds-pointer-arithmetic,cppcoreguidelines-pro-type-reinterpret-cast)
@@ -0,0 +1,95 @@
+#ifndef PRACTICA1_PIXELKERNELS_HPP
+#define PRACTICA1_PIXELKERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Núcleos de conversión entre el raster PPM intercalado (RGBRGB...) y planos separados.
+// Usan AVX2 o SSSE3 cuando el compilador los habilita (-march=native en Release) y un
+// bucle escalar en otro caso. El número de píxeles lo marca el tamaño de los planos.
+
+// Separa un raster de 8 bits en tres planos de 16 bits
+void deinterleaveRGB8(std::span<const uint8_t> raster, std::span<uint16_t> red,
+                      std::span<uint16_t> green, std::span<uint16_t> blue);
+
+// Separa un raster de 16 bits big-endian en tres planos en el orden del host
+void deinterleaveRGB16BE(std::span<const uint8_t> raster, std::span<uint16_t> red,
+                         std::span<uint16_t> green, std::span<uint16_t> blue);
+
+// Convierte muestras de 16 bits big-endian al orden del host sin separar canales; sirve
+// para cargar directamente un raster de 16 bits en píxeles intercalados
+void loadSamples16BE(std::span<const uint8_t> raster, std::span<uint16_t> samples);
+
+// Operación inversa de loadSamples16BE: escribe las muestras en big-endian
+void storeSamples16BE(std::span<const uint16_t> samples, std::span<uint8_t> raster);
+
+// Amplía un raster de un canal de 8 bits a muestras de 16 bits (planos en escala de grises)
+void widenSamples8(std::span<const uint8_t> raster, std::span<uint16_t> samples);
+
+// Reduce muestras de 16 bits con valores de 8 bits a un byte por muestra
+void narrowSamples8(std::span<const uint16_t> samples, std::span<uint8_t> raster);
+
+// Multiplica cada muestra por `factor` y redondea al entero más cercano (las mitades hacia
+// arriba, como std::round). Con SSE4.1 o AVX2 se procesan 4 u 8 muestras por iteración.
+void scaleSamples(std::span<uint16_t> samples, float factor);
+
+// Lanza std::runtime_error si alguna muestra supera maxColorValue, como el parser de P2/P3.
+// Los rasters binarios y la caché planar se cargan sin mirar los valores y las operaciones
+// que indexan tablas por nivel dependen de ese límite. Con 255 o 65535 ninguna muestra
+// cargada puede superarlo y no se recorre nada.
+void checkSampleRange(std::span<const uint16_t> samples, int maxColorValue);
+
+// Posición de origen de una columna (o fila) de destino en punto fijo: se interpola entre
+// `left` y `left + 1` y `weight` es el peso de la segunda sobre 2^bits. En el borde derecho
+// la pareja se desplaza una posición a la izquierda con peso completo para que `left + 1`
+// exista siempre; solo con un origen de una columna queda left = 0 y weight = 0.
+struct ResizeColumn {
+    uint32_t left;
+    uint32_t weight;
+};
+
+// Bits de los pesos según la profundidad: 8 para imágenes de 8 bits y 16 para las de 16,
+// de forma que muestra por peso quepa en 16 y 32 bits respectivamente
+unsigned resizeWeightBits(int maxColorValue);
+
+// Convierte una posición de origen (muestras `left` y `right` con peso `delta` para la
+// segunda) a punto fijo, redondeando el peso y normalizando el borde como se indica arriba
+ResizeColumn fixedResizeColumn(std::size_t left, std::size_t right, float delta, unsigned bits);
+
+// Segunda muestra de origen de una posición: left + 1, salvo con un origen de tamaño 1
+inline std::size_t nextSample(const ResizeColumn &column, const std::size_t size) {
+    return std::min<std::size_t>(column.left + 1, size - 1);
+}
+
+// Interpola bilinealmente una fila de destino de píxeles de `channels` muestras contiguas
+// entre dos filas de origen; weightY es el peso de la inferior sobre 2^bits.
+// Redondeo: primero se mezcla cada fila en horizontal, a * (2^bits - w) + b * w, y después
+// las dos filas en vertical del mismo modo; el total se divide entre 2^(2 * bits) sumando
+// antes la mitad, es decir, redondeo al más cercano con las mitades hacia arriba en lugar de
+// truncar. Con 8 bits la mezcla horizontal se conserva exacta; con 16 se redondea también a
+// 16 bits antes de la vertical para que todo quepa en enteros de 32 bits sin signo. Con
+// AVX2 un solo canal (planos SoA) se calcula de 8 en 8 columnas y con SSE4.1 cuatro canales
+// (RGBA) en un registro por píxel; el bucle escalar da el mismo resultado.
+void interpolateRow(std::span<const uint16_t> top, std::span<const uint16_t> bottom,
+                    std::span<const ResizeColumn> columns, uint32_t weightY, unsigned bits, std::size_t channels,
+                    std::span<uint16_t> out);
+
+// Reducción por bloques: cada píxel de `out` es la media de los bloques de `factorX`
+// píxeles consecutivos de todas las filas de `rows`, redondeada al más cercano (las mitades
+// hacia arriba) y sin pasar por coma flotante. Un bloque incompleto en el borde derecho
+// repite la última columna. Con AVX2 la reducción a la mitad de un plano (un canal, dos
+// filas y factor 2) se calcula de 16 en 16 salidas sumando las columnas por parejas.
+void boxReduceRow(std::span<const std::span<const uint16_t>> rows, std::size_t factorX, std::size_t channels,
+                  std::span<uint16_t> out);
+
+// Intercala tres planos con muestras de 8 bits en un raster RGB de un byte por muestra
+void interleaveRGB8(std::span<const uint16_t> red, std::span<const uint16_t> green,
+                    std::span<const uint16_t> blue, std::span<uint8_t> raster);
+
+// Intercala tres planos en un raster de 16 bits big-endian
+void interleaveRGB16BE(std::span<const uint16_t> red, std::span<const uint16_t> green,
+                       std::span<const uint16_t> blue, std::span<uint8_t> raster);
+
+#endif // PRACTICA1_PIXELKERNELS_HPP
@@ -0,0 +1,216 @@
+#include "planarcache.hpp"
+#include "positionalwriter.hpp"
+#include "parallel.hpp"
+#include "sharedmemory.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    constexpr int MAX_COLOR_8_BIT = 255;
+    constexpr int MAX_COLOR_16_BIT = 65535;
+    constexpr uint16_t PLANAR_VERSION = 1;
+    constexpr std::size_t MAX_CHANNELS = 4;
+    constexpr int BYTE_SHIFT = 8;
+
+    // Posiciones de los campos de la cabecera
+    constexpr std::size_t VERSION_OFFSET = 8;
+    constexpr std::size_t ORDER_OFFSET = 10;
+    constexpr std::size_t WIDTH_OFFSET = 12;
+    constexpr std::size_t HEIGHT_OFFSET = 16;
+    constexpr std::size_t MAXVAL_OFFSET = 20;
+    constexpr std::size_t CHANNELS_OFFSET = 24;
+
+    constexpr uint8_t HOST_LITTLE_ENDIAN = std::endian::native == std::endian::little ? 1 : 0;
+
+    template <typename T>
+    T leerLE(const std::span<const uint8_t> data, const std::size_t offset) {
+        T valor = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            valor = static_cast<T>(valor | (static_cast<T>(data[offset + i]) << (BYTE_SHIFT * i)));
+        }
+        return valor;
+    }
+
+    template <typename T>
+    void escribirLE(std::string &data, const std::size_t offset, const T valor) {
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            data[offset + i] = static_cast<char>(static_cast<uint8_t>(valor >> (BYTE_SHIFT * i)));
+        }
+    }
+
+    std::size_t alinear(const std::size_t bytes) {
+        return (bytes + PLANAR_ALIGNMENT - 1) / PLANAR_ALIGNMENT * PLANAR_ALIGNMENT;
+    }
+
+    int leerDimension(const std::span<const uint8_t> data, const std::size_t offset) {
+        const auto valor = leerLE<uint32_t>(data, offset);
+        if (valor > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+            throw std::runtime_error("Caché planar no válida");
+        }
+        return static_cast<int>(valor);
+    }
+
+    // Producto y suma sin valor si el resultado no cabe en std::size_t
+    std::optional<std::size_t> multiplicar(const std::size_t a, const std::size_t b) {
+        if (a != 0 && b > std::numeric_limits<std::size_t>::max() / a) {
+            return std::nullopt;
+        }
+        return a * b;
+    }
+
+    std::optional<std::size_t> sumar(const std::size_t a, const std::size_t b) {
+        if (b > std::numeric_limits<std::size_t>::max() - a) {
+            return std::nullopt;
+        }
+        return a + b;
+    }
+
+    // PlanarHeader::fileSize() con cada operación comprobada: con dimensiones elegidas a
+    // propósito el cálculo sin comprobar da la vuelta, pasa la comparación con el tamaño del
+    // archivo y los planos quedan fuera de la proyección
+    std::optional<std::size_t> tamanoComprobado(const PlanarHeader &header) {
+        const std::optional<std::size_t> pixeles =
+                multiplicar(static_cast<std::size_t>(header.width), static_cast<std::size_t>(header.height));
+        const std::optional<std::size_t> bytesPlano = pixeles ? multiplicar(*pixeles, header.bytesPerSample()) : std::nullopt;
+        const std::optional<std::size_t> conRelleno = bytesPlano ? sumar(*bytesPlano, PLANAR_ALIGNMENT - 1) : std::nullopt;
+        const std::optional<std::size_t> planos =
+                conRelleno ? multiplicar(*conRelleno / PLANAR_ALIGNMENT * PLANAR_ALIGNMENT, header.channels) : std::nullopt;
+        return planos ? sumar(*planos, PLANAR_ALIGNMENT) : std::nullopt;
+    }
+}
+
+std::size_t PlanarHeader::bytesPerSample() const {
+    return maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2;
+}
+
+std::size_t PlanarHeader::pixelCount() const {
+    return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+}
+
+std::size_t PlanarHeader::planeBytes() const {
+    return pixelCount() * bytesPerSample();
+}
+
+std::size_t PlanarHeader::planeStride() const {
+    return alinear(planeBytes());
+}
+
+std::size_t PlanarHeader::fileSize() const {
+    return PLANAR_ALIGNMENT + (channels * planeStride());
+}
+
+bool isPlanarCache(const std::span<const uint8_t> data) {
+    return data.size() >= PLANAR_MAGIC.size() && std::ranges::equal(data.first(PLANAR_MAGIC.size()), PLANAR_MAGIC);
+}
+
+bool isPlanarCacheFile(const std::string &filePath) {
+    if (isStandardStream(filePath) || isSharedMemory(filePath)) {
+        return false;
+    }
+    std::ifstream archivo(filePath, std::ios::binary);
+    std::array<char, PLANAR_MAGIC.size()> firma{};
+    return archivo.read(firma.data(), firma.size()) && std::string_view(firma.data(), firma.size()) == PLANAR_MAGIC;
+}
+
+PlanarHeader parsePlanarHeader(const std::span<const uint8_t> data) {
+    if (data.size() < PLANAR_ALIGNMENT || !isPlanarCache(data)) {
+        throw std::runtime_error("Caché planar no válida");
+    }
+    if (leerLE<uint16_t>(data, VERSION_OFFSET) != PLANAR_VERSION) {
+        throw std::runtime_error("Formato no soportado");
+    }
+
+    PlanarHeader header;
+    header.width = leerDimension(data, WIDTH_OFFSET);
+    header.height = leerDimension(data, HEIGHT_OFFSET);
+    header.maxColorValue = leerDimension(data, MAXVAL_OFFSET);
+    header.channels = leerLE<uint32_t>(data, CHANNELS_OFFSET);
+    if (header.maxColorValue <= 0 || header.maxColorValue > MAX_COLOR_16_BIT || header.channels == 0 ||
+        header.channels > MAX_CHANNELS) {
+        throw std::runtime_error("Caché planar no válida");
+    }
+    // Las muestras de 16 bits están en el orden del host que la escribió
+    if (header.bytesPerSample() == 2 && data[ORDER_OFFSET] != HOST_LITTLE_ENDIAN) {
+        throw std::runtime_error("Formato no soportado");
+    }
+    const std::optional<std::size_t> tamano = tamanoComprobado(header);
+    if (!tamano) {
+        throw std::runtime_error("Caché planar no válida");
+    }
+    if (data.size() < *tamano) {
+        throw std::runtime_error("Caché planar incompleta");
+    }
+    return header;
+}
+
+void writePlanarCache(const std::string &filePath, const PlanarHeader &header, const PlaneEncoder &encoder) {
+    std::string cabecera(PLANAR_ALIGNMENT, '\0');
+    std::ranges::copy(PLANAR_MAGIC, cabecera.begin());
+    escribirLE(cabecera, VERSION_OFFSET, PLANAR_VERSION);
+    cabecera[ORDER_OFFSET] = static_cast<char>(HOST_LITTLE_ENDIAN);
+    escribirLE(cabecera, WIDTH_OFFSET, static_cast<uint32_t>(header.width));
+    escribirLE(cabecera, HEIGHT_OFFSET, static_cast<uint32_t>(header.height));
+    escribirLE(cabecera, MAXVAL_OFFSET, static_cast<uint32_t>(header.maxColorValue));
+    escribirLE(cabecera, CHANNELS_OFFSET, static_cast<uint32_t>(header.channels));
+
+    // Cada elemento es una muestra de un plano, relleno incluido; los bloques que cruzan el
+    // final de un plano se reparten entre el encoder y los ceros de alineación
+    const std::size_t bytesMuestra = header.bytesPerSample();
+    const std::size_t muestrasPlano = header.planeStride() / bytesMuestra;
+    writeEncodedOutput(filePath, cabecera, header.channels * muestrasPlano, bytesMuestra,
+                       [&](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+                           std::size_t posicion = first;
+                           while (posicion < last) {
+                               const std::size_t plano = posicion / muestrasPlano;
+                               const std::size_t inicio = posicion % muestrasPlano;
+                               const std::size_t fin = std::min(muestrasPlano, inicio + (last - posicion));
+                               const std::span<uint8_t> destino =
+                                       out.subspan((posicion - first) * bytesMuestra, (fin - inicio) * bytesMuestra);
+                               const std::size_t utiles = std::min(fin, header.pixelCount());
+                               if (inicio < utiles) {
+                                   encoder(plano, inicio, utiles, destino.first((utiles - inicio) * bytesMuestra));
+                               }
+                               const std::size_t relleno = std::max(inicio, utiles);
+                               std::fill(destino.begin() + static_cast<std::ptrdiff_t>((relleno - inicio) * bytesMuestra),
+                                         destino.end(), uint8_t{0});
+                               posicion += fin - inicio;
+                           }
+                       });
+}
+
+PlanarView::PlanarView(MappedFile mappedFile) : file(std::move(mappedFile)), cabecera(parsePlanarHeader(file.data())) {}
+
+std::span<const uint8_t> PlanarView::plane(const std::size_t index) const {
+    return file.data().subspan(PLANAR_ALIGNMENT + (index * cabecera.planeStride()), cabecera.planeBytes());
+}
+
+std::vector<uint8_t> PlanarView::interleavedRaster() const {
+    const std::size_t canales = cabecera.channels;
+    const std::size_t bytesMuestra = cabecera.bytesPerSample();
+    std::vector<uint8_t> raster(cabecera.pixelCount() * canales * bytesMuestra);
+    parallelForRanges(cabecera.pixelCount(), PARALLEL_GRAIN_PIXELS, [&](const std::size_t first, const std::size_t last) {
+        for (std::size_t canal = 0; canal < canales; ++canal) {
+            const std::span<const uint8_t> origen = plane(canal);
+            for (std::size_t i = first; i < last; ++i) {
+                const std::size_t destino = ((i * canales) + canal) * bytesMuestra;
+                if (bytesMuestra == 1) {
+                    raster[destino] = origen[i];
+                } else {
+                    uint16_t muestra = 0;
+                    std::memcpy(&muestra, &origen[2 * i], sizeof(muestra));
+                    raster[destino] = static_cast<uint8_t>(muestra >> BYTE_SHIFT);
+                    raster[destino + 1] = static_cast<uint8_t>(muestra);
+                }
+            }
+        }
+    });
+    return raster;
+}
@@ -0,0 +1,82 @@
+#ifndef PRACTICA1_PLANARCACHE_HPP
+#define PRACTICA1_PLANARCACHE_HPP
+
+#include "mappedfile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Caché planar: formato propio con la misma disposición que los planos SoA en memoria.
+// Una cabecera de PLANAR_ALIGNMENT bytes va seguida de un plano por canal; cada plano
+// empieza en un múltiplo de PLANAR_ALIGNMENT y guarda las muestras con su ancho nativo
+// (1 byte si maxval <= 255, 2 bytes en el orden del host en otro caso), de modo que
+// cargarlo es copiar o ampliar planos proyectados en memoria, sin analizar ni separar.
+//
+// Cabecera (enteros little-endian):
+//   0  "IMPLANAR"     8 bytes
+//   8  versión        uint16
+//   10 orden          uint8: 1 si las muestras de 16 bits son little-endian, 0 si big-endian
+//   12 ancho, alto, maxval, canales   uint32 cada uno
+//   resto hasta PLANAR_ALIGNMENT a cero
+constexpr std::size_t PLANAR_ALIGNMENT = 64;
+constexpr std::string_view PLANAR_MAGIC = "IMPLANAR";
+
+struct PlanarHeader {
+    int width = 0;
+    int height = 0;
+    int maxColorValue = 0;
+    std::size_t channels = 0;
+
+    [[nodiscard]] std::size_t bytesPerSample() const;
+    [[nodiscard]] std::size_t pixelCount() const;
+
+    // Bytes útiles de un plano y distancia entre el inicio de dos planos consecutivos
+    [[nodiscard]] std::size_t planeBytes() const;
+    [[nodiscard]] std::size_t planeStride() const;
+
+    // Tamaño total del archivo
+    [[nodiscard]] std::size_t fileSize() const;
+};
+
+// Indica si los datos empiezan por la firma de la caché planar
+[[nodiscard]] bool isPlanarCache(std::span<const uint8_t> data);
+
+// Indica si la ruta es un archivo normal con una caché planar. La entrada estándar y la
+// memoria compartida no se inspeccionan (no se puede leer su inicio sin consumirlo)
+[[nodiscard]] bool isPlanarCacheFile(const std::string &filePath);
+
+// Analiza y valida la cabecera; lanza una excepción si no es una caché de este host
+PlanarHeader parsePlanarHeader(std::span<const uint8_t> data);
+
+// Rellena `out` con las muestras [first, last) del plano `plane`, ya en su ancho nativo
+using PlaneEncoder = std::function<void(std::size_t plane, std::size_t first, std::size_t last, std::span<uint8_t> out)>;
+
+// Escribe una caché planar completa. Los planos se codifican por bloques en paralelo con
+// writeEncodedOutput, así que admite archivos, "-" y "shm:nombre" como cualquier salida.
+void writePlanarCache(const std::string &filePath, const PlanarHeader &header, const PlaneEncoder &encoder);
+
+// Vista de solo lectura de una caché planar proyectada en memoria
+class PlanarView {
+public:
+    explicit PlanarView(MappedFile mappedFile);
+
+    [[nodiscard]] const PlanarHeader &header() const { return cabecera; }
+
+    // Bytes del plano `index`, sin el relleno de alineación
+    [[nodiscard]] std::span<const uint8_t> plane(std::size_t index) const;
+
+    // Raster intercalado equivalente al de un P6 (P5 con un canal, PAM con cuatro), con
+    // las muestras de 16 bits en big-endian; para quien trabaja sobre el raster
+    [[nodiscard]] std::vector<uint8_t> interleavedRaster() const;
+
+private:
+    MappedFile file;
+    PlanarHeader cabecera;
+};
+
+#endif // PRACTICA1_PLANARCACHE_HPP
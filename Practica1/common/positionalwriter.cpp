@@ -0,0 +1,124 @@
+#include "positionalwriter.hpp"
+#include "parallel.hpp"
+#include "sharedmemory.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Los mismos permisos que crearía std::ofstream (sujetos a la umask)
+    constexpr mode_t FILE_MODE = 0666;
+}
+
+PositionalWriter::PositionalWriter(const std::string &filePath, const std::size_t totalSize) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    descriptor = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, FILE_MODE);
+    if (descriptor < 0) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+    if (totalSize == 0) {
+        return;
+    }
+
+    // Se reservan los bloques del archivo completo; si el sistema de archivos no lo
+    // admite basta con fijar el tamaño, que pwrite rellenará después
+    const auto longitud = static_cast<off_t>(totalSize);
+    if (::posix_fallocate(descriptor, 0, longitud) != 0 && ::ftruncate(descriptor, longitud) != 0) {
+        ::close(descriptor);
+        descriptor = -1;
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+}
+
+PositionalWriter::~PositionalWriter() {
+    if (descriptor >= 0) {
+        ::close(descriptor);
+    }
+}
+
+void PositionalWriter::writeAt(std::size_t offset, std::span<const uint8_t> data) const {
+    // pwrite puede escribir menos de lo pedido: se repite hasta completar el rango
+    while (!data.empty()) {
+        const ssize_t escritos = ::pwrite(descriptor, data.data(), data.size(), static_cast<off_t>(offset));
+        if (escritos < 0 && errno == EINTR) {
+            continue;
+        }
+        if (escritos <= 0) {
+            throw std::runtime_error("Error al guardar el archivo");
+        }
+        offset += static_cast<std::size_t>(escritos);
+        data = data.subspan(static_cast<std::size_t>(escritos));
+    }
+}
+
+void PositionalWriter::writeAt(const std::size_t offset, const std::string_view text) const {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    writeAt(offset, std::span(reinterpret_cast<const uint8_t *>(text.data()), text.size()));
+}
+
+void PositionalWriter::writeEncoded(const std::size_t offset, const std::size_t count, const std::size_t bytesPerItem,
+                                    const ItemEncoder &encoder) const {
+    if (count == 0 || bytesPerItem == 0) {
+        return;
+    }
+
+    const std::size_t itemsPorBloque = std::max<std::size_t>(1, OUTPUT_BLOCK_SIZE / bytesPerItem);
+
+    // Cada tarea codifica su bloque en un búfer propio y lo escribe en su posición final.
+    // El búfer se reserva dentro de la tarea: parallelForEach relanza el error si falta
+    // memoria o falla la escritura
+    parallelForEach((count + itemsPorBloque - 1) / itemsPorBloque, [&](const std::size_t indice) {
+        const std::size_t first = indice * itemsPorBloque;
+        const std::size_t last = std::min(count, first + itemsPorBloque);
+        std::vector<uint8_t> bloque((last - first) * bytesPerItem);
+        encoder(first, last, bloque);
+        writeAt(offset + (first * bytesPerItem), bloque);
+    });
+}
+
+void PositionalWriter::close() {
+    const int cerrado = ::close(std::exchange(descriptor, -1));
+    if (cerrado != 0) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+}
+
+void writeEncodedOutput(const std::string &filePath, const std::string_view prefix, const std::size_t count,
+                        const std::size_t bytesPerItem, const ItemEncoder &encoder) {
+    if (isStandardStream(filePath)) {
+        if (!std::cout.write(prefix.data(), static_cast<std::streamsize>(prefix.size()))) {
+            throw std::runtime_error("Error al guardar el archivo");
+        }
+        writeEncodedBlocks(std::cout, count, bytesPerItem, encoder);
+        if (!std::cout.flush()) {
+            throw std::runtime_error("Error al guardar el archivo");
+        }
+        return;
+    }
+
+    if (isSharedMemory(filePath)) {
+        // Los bloques se codifican directamente en las páginas del segmento
+        const SharedMemorySegment segment(filePath, prefix.size() + (count * bytesPerItem));
+        const std::span<uint8_t> destino = segment.data();
+        std::ranges::copy(prefix, destino.begin());
+        if (count == 0 || bytesPerItem == 0) {
+            return;
+        }
+        const std::size_t itemsPorBloque = std::max<std::size_t>(1, OUTPUT_BLOCK_SIZE / bytesPerItem);
+        parallelForRanges(count, itemsPorBloque, [&](const std::size_t first, const std::size_t last) {
+            encoder(first, last, destino.subspan(prefix.size() + (first * bytesPerItem), (last - first) * bytesPerItem));
+        });
+        return;
+    }
+
+    PositionalWriter writer(filePath, prefix.size() + (count * bytesPerItem));
+    writer.writeAt(0, prefix);
+    writer.writeEncoded(prefix.size(), count, bytesPerItem, encoder);
+    writer.close();
+}
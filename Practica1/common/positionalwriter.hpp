@@ -0,0 +1,49 @@
+#ifndef PRACTICA1_POSITIONALWRITER_HPP
+#define PRACTICA1_POSITIONALWRITER_HPP
+
+#include "ppmstream.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Archivo de salida cuyo tamaño final se conoce de antemano. Se reserva entero al abrirlo
+// (fallocate) y cada parte se escribe con pwrite en su desplazamiento, de modo que varios
+// hilos pueden codificar y escribir rangos distintos a la vez sin compartir un flujo.
+class PositionalWriter {
+public:
+    PositionalWriter(const std::string &filePath, std::size_t totalSize);
+    ~PositionalWriter();
+
+    PositionalWriter(const PositionalWriter &) = delete;
+    PositionalWriter &operator=(const PositionalWriter &) = delete;
+    PositionalWriter(PositionalWriter &&) = delete;
+    PositionalWriter &operator=(PositionalWriter &&) = delete;
+
+    // Escribe `data` a partir de `offset`; se puede llamar desde varios hilos a la vez
+    void writeAt(std::size_t offset, std::span<const uint8_t> data) const;
+    void writeAt(std::size_t offset, std::string_view text) const;
+
+    // Codifica `count` elementos de `bytesPerItem` bytes a partir de `offset`: los bloques
+    // de OUTPUT_BLOCK_SIZE se reparten entre hilos y cada uno escribe el suyo con pwrite.
+    // El codificador debe poder llamarse concurrentemente sobre rangos distintos.
+    void writeEncoded(std::size_t offset, std::size_t count, std::size_t bytesPerItem,
+                      const ItemEncoder &encoder) const;
+
+    // Cierra el archivo comprobando errores de escritura diferidos
+    void close();
+
+private:
+    int descriptor = -1;
+};
+
+// Escribe `prefix` seguido de `count` elementos codificados. Un archivo se escribe en
+// paralelo con PositionalWriter; "-" (salida estándar) no admite pwrite, así que se
+// escribe por bloques secuenciales con writeEncodedBlocks. Con "shm:nombre" se crea un
+// segmento de memoria compartida del tamaño exacto y se codifica directamente en él.
+void writeEncodedOutput(const std::string &filePath, std::string_view prefix, std::size_t count,
+                        std::size_t bytesPerItem, const ItemEncoder &encoder);
+
+#endif // PRACTICA1_POSITIONALWRITER_HPP
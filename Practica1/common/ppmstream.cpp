@@ -0,0 +1,232 @@
+#include "ppmstream.hpp"
+#include "binaryio.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+    // Bytes que se leen primero para localizar el encabezado; si no basta se duplica
+    constexpr std::size_t HEADER_PREFIX_SIZE = 4096;
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr std::size_t RGBA_CHANNELS = 4;
+    // Bytes de texto que se leen de una vez en un P3 o P2
+    constexpr std::size_t TEXT_BLOCK_SIZE = static_cast<std::size_t>(64) * 1024;
+    constexpr int DECIMAL_BASE = 10;
+    constexpr unsigned BYTE_SHIFT = 8;
+    constexpr int BYTE_MASK = 0xFF;
+}
+
+std::size_t rowsForBudget(const std::size_t memoryBudget, const std::size_t bytesPerRow) {
+    if (bytesPerRow == 0) {
+        return 1;
+    }
+    return std::max<std::size_t>(1, memoryBudget / bytesPerRow);
+}
+
+void writeEncodedBlocks(std::ostream &output, const std::size_t count, const std::size_t bytesPerItem,
+                        const ItemEncoder &encoder) {
+    if (count == 0 || bytesPerItem == 0) {
+        return;
+    }
+
+    const std::size_t itemsPorBloque = std::max<std::size_t>(1, OUTPUT_BLOCK_SIZE / bytesPerItem);
+    BinaryWriter writer(output, std::min(count, itemsPorBloque) * bytesPerItem);
+
+    // Cada bloque se codifica directamente en el búfer del escritor
+    for (std::size_t first = 0; first < count; first += itemsPorBloque) {
+        const std::size_t last = std::min(count, first + itemsPorBloque);
+        encoder(first, last, writer.append((last - first) * bytesPerItem));
+    }
+    writer.flush();
+}
+
+std::string formatPPMHeader(const int width, const int height, const int maxColorValue, const std::size_t channels) {
+    if (channels == RGBA_CHANNELS) {
+        return "P7\nWIDTH " + std::to_string(width) + "\nHEIGHT " + std::to_string(height) + "\nDEPTH 4\nMAXVAL " +
+               std::to_string(maxColorValue) + "\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    }
+    return (channels == RGB_CHANNELS ? "P6\n" : "P5\n") + std::to_string(width) + " " + std::to_string(height) + "\n" +
+           std::to_string(maxColorValue) + "\n";
+}
+
+PPMHeader rasterPPMHeader(const int width, const int height, const int maxColorValue, const std::size_t channels) {
+    PPMHeader header;
+    if (channels == RGBA_CHANNELS) {
+        header.magicNumber = "P7";
+        header.tupleType = "RGB_ALPHA";
+    } else {
+        header.magicNumber = channels == RGB_CHANNELS ? "P6" : "P5";
+    }
+    header.width = width;
+    header.height = height;
+    header.maxColorValue = maxColorValue;
+    header.depth = static_cast<int>(channels);
+    return header;
+}
+
+std::vector<uint8_t> encodeRaster(const PPMHeader &header, const ItemEncoder &encoder) {
+    const std::size_t bytesPorPixel = header.channels() * header.bytesPerSample();
+    std::vector<uint8_t> raster(header.rasterSize());
+    parallelForRanges(header.pixelCount(), PARALLEL_GRAIN_PIXELS, [&](const std::size_t first, const std::size_t last) {
+        encoder(first, last, std::span(raster).subspan(first * bytesPorPixel, (last - first) * bytesPorPixel));
+    });
+    return raster;
+}
+
+PPMStripReader::PPMStripReader(const std::string &filePath) : input(&file) {
+    if (isStandardStream(filePath)) {
+        input = &std::cin;
+    } else {
+        file.open(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error al abrir el archivo");
+        }
+    }
+
+    // Se lee un prefijo que contiene el encabezado completo; lo que sobre ya es raster. Un
+    // encabezado con comentarios largos puede no caber: se sigue leyendo hasta que termine
+    std::vector<uint8_t> prefijo;
+    std::size_t bloque = HEADER_PREFIX_SIZE;
+    do {
+        const std::size_t leidos = prefijo.size();
+        prefijo.resize(leidos + bloque);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        input->read(reinterpret_cast<char *>(std::span(prefijo).subspan(leidos).data()), static_cast<std::streamsize>(bloque));
+        prefijo.resize(leidos + static_cast<std::size_t>(input->gcount()));
+        bloque = prefijo.size();
+    } while (*input && isTruncatedPPMHeader(prefijo));
+
+    cabecera = parsePPMHeader(prefijo);
+    if (cabecera.isPlain()) {
+        validatePlainHeader(cabecera);
+    } else {
+        validateBinaryHeader(cabecera);
+    }
+
+    pendiente.assign(prefijo.begin() + static_cast<std::ptrdiff_t>(cabecera.dataOffset), prefijo.end());
+    filasRestantes = static_cast<std::size_t>(cabecera.height);
+}
+
+std::size_t PPMStripReader::rowBytes() const {
+    return static_cast<std::size_t>(cabecera.width) * cabecera.channels() * cabecera.bytesPerSample();
+}
+
+std::size_t PPMStripReader::readRows(std::span<uint8_t> buffer) {
+    const std::size_t filas = std::min(filasRestantes, buffer.size() / std::max<std::size_t>(1, rowBytes()));
+    const std::size_t total = filas * rowBytes();
+    if (cabecera.isPlain()) {
+        decodeText(buffer.first(total));
+        filasRestantes -= filas;
+        return filas;
+    }
+
+    // Primero se consumen los bytes leídos junto con el encabezado
+    const std::size_t desdePendiente = std::min(total, pendiente.size());
+    std::copy_n(pendiente.begin(), desdePendiente, buffer.begin());
+    pendiente.erase(pendiente.begin(), pendiente.begin() + static_cast<std::ptrdiff_t>(desdePendiente));
+
+    if (total > desdePendiente) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        input->read(reinterpret_cast<char *>(buffer.data() + desdePendiente),
+                    static_cast<std::streamsize>(total - desdePendiente));
+        if (static_cast<std::size_t>(input->gcount()) != total - desdePendiente) {
+            throw std::runtime_error("Archivo PPM incompleto");
+        }
+    }
+
+    filasRestantes -= filas;
+    return filas;
+}
+
+int PPMStripReader::nextTextByte() {
+    if (posicionTexto == pendiente.size()) {
+        pendiente.resize(TEXT_BLOCK_SIZE);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        input->read(reinterpret_cast<char *>(pendiente.data()), static_cast<std::streamsize>(pendiente.size()));
+        pendiente.resize(static_cast<std::size_t>(input->gcount()));
+        posicionTexto = 0;
+        if (pendiente.empty()) {
+            return -1;
+        }
+    }
+    return pendiente[posicionTexto++];
+}
+
+// Mismas reglas que parseDecimalRaster: enteros decimales separados por espacios en blanco,
+// sin comentarios, cada uno entre 0 y maxval
+void PPMStripReader::decodeText(const std::span<uint8_t> destino) {
+    const std::size_t bytesMuestra = cabecera.bytesPerSample();
+    for (std::size_t pos = 0; pos < destino.size(); pos += bytesMuestra) {
+        int byte = nextTextByte();
+        while (byte >= 0 && std::isspace(byte) != 0) {
+            byte = nextTextByte();
+        }
+        if (byte < 0) {
+            throw std::runtime_error("Archivo PPM incompleto");
+        }
+        if (std::isdigit(byte) == 0) {
+            throw std::runtime_error("Archivo PPM no válido");
+        }
+        int valor = 0;
+        while (byte >= 0 && std::isdigit(byte) != 0) {
+            valor = (valor * DECIMAL_BASE) + (byte - '0');
+            if (valor > cabecera.maxColorValue) {
+                throw std::runtime_error("Valor de muestra fuera de rango");
+            }
+            byte = nextTextByte();
+        }
+        if (byte >= 0 && std::isspace(byte) == 0) {
+            throw std::runtime_error("Archivo PPM no válido");
+        }
+        if (bytesMuestra == 1) {
+            destino[pos] = static_cast<uint8_t>(valor);
+        } else {
+            destino[pos] = static_cast<uint8_t>(static_cast<unsigned>(valor) >> BYTE_SHIFT);
+            destino[pos + 1] = static_cast<uint8_t>(valor & BYTE_MASK);
+        }
+    }
+}
+
+PPMRowReader::PPMRowReader(PPMStripReader &reader, const std::size_t memoryBudget)
+    : reader(reader), franja(rowsForBudget(memoryBudget, reader.rowBytes()) * reader.rowBytes()) {}
+
+std::span<const uint8_t> PPMRowReader::nextRow() {
+    if (siguiente == filasEnFranja) {
+        filasEnFranja = reader.readRows(franja);
+        siguiente = 0;
+        if (filasEnFranja == 0) {
+            throw std::runtime_error("Archivo PPM incompleto");
+        }
+    }
+    return std::span(franja).subspan(reader.rowBytes() * siguiente++, reader.rowBytes());
+}
+
+PPMStripWriter::PPMStripWriter(const std::string &filePath, const int width, const int height,
+                               const int maxColorValue, const std::size_t channels)
+    : output(&file) {
+    if (isStandardStream(filePath)) {
+        output = &std::cout;
+    } else {
+        file.open(filePath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error al guardar el archivo");
+        }
+    }
+    *output << formatPPMHeader(width, height, maxColorValue, channels);
+}
+
+void PPMStripWriter::writeRows(std::span<const uint8_t> rows) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (!output->write(reinterpret_cast<const char *>(rows.data()), static_cast<std::streamsize>(rows.size()))) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+}
+
+void PPMStripWriter::finish() {
+    if (!output->flush()) {
+        throw std::runtime_error("Error al guardar el archivo");
+    }
+}
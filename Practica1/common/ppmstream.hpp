@@ -0,0 +1,106 @@
+#ifndef PRACTICA1_PPMSTREAM_HPP
+#define PRACTICA1_PPMSTREAM_HPP
+
+#include "ppmview.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Memoria por defecto para el modo por franjas (en MiB)
+constexpr std::size_t DEFAULT_STRIP_BUDGET_MIB = 64;
+
+// Tamaño de los bloques en los que se codifica la salida antes de escribirla
+constexpr std::size_t OUTPUT_BLOCK_SIZE = static_cast<std::size_t>(4) * 1024 * 1024;
+
+// Codifica los elementos [first, last) (píxeles, índices...) en el búfer de salida
+using ItemEncoder = std::function<void(std::size_t first, std::size_t last, std::span<uint8_t> out)>;
+
+// Codifica `count` elementos de `bytesPerItem` bytes por bloques de OUTPUT_BLOCK_SIZE
+// sobre un único búfer reutilizado y escribe cada bloque con una sola llamada a write
+void writeEncodedBlocks(std::ostream &output, std::size_t count, std::size_t bytesPerItem,
+                        const ItemEncoder &encoder);
+
+// Número de filas por franja que caben en el presupuesto de memoria (al menos una)
+std::size_t rowsForBudget(std::size_t memoryBudget, std::size_t bytesPerRow);
+
+// Genera el encabezado "P6\nancho alto\nmaxval\n" ("P5" con un solo canal y un PAM
+// RGB_ALPHA con cuatro)
+std::string formatPPMHeader(int width, int height, int maxColorValue, std::size_t channels = 3);
+
+// El mismo encabezado ya analizado, para un raster que se codifica en memoria
+[[nodiscard]] PPMHeader rasterPPMHeader(int width, int height, int maxColorValue, std::size_t channels = 3);
+
+// Codifica todos los píxeles con el formato de `header` en un único búfer, por bloques de
+// PARALLEL_GRAIN_PIXELS píxeles en paralelo; el codificador no debe lanzar
+[[nodiscard]] std::vector<uint8_t> encodeRaster(const PPMHeader &header, const ItemEncoder &encoder);
+
+// Lector de un PPM (P6), PGM (P5) o PAM (P7) por franjas de filas: nunca mantiene en memoria más que
+// la franja que el llamante le pide. Con "-" lee de la entrada estándar. Un P3 o P2 en texto
+// se decodifica al leerlo y las filas se entregan como el raster equivalente de un P6 o P5.
+class PPMStripReader {
+public:
+    explicit PPMStripReader(const std::string &filePath);
+
+    [[nodiscard]] const PPMHeader &header() const { return cabecera; }
+
+    // Bytes de una fila del raster
+    [[nodiscard]] std::size_t rowBytes() const;
+
+    // Lee tantas filas completas como quepan en el búfer; devuelve las filas leídas (0 al final)
+    std::size_t readRows(std::span<uint8_t> buffer);
+
+private:
+    // Decodifica las muestras en texto que llenan `destino` (1 o 2 bytes big-endian cada una)
+    void decodeText(std::span<uint8_t> destino);
+
+    // Siguiente byte del texto, o -1 al final de la entrada
+    int nextTextByte();
+
+    std::ifstream file;
+    std::istream *input; // `file` o std::cin
+    PPMHeader cabecera;
+    std::vector<uint8_t> pendiente; // Bytes del raster leídos junto con el encabezado; en P3 y P2, el bloque de texto en curso
+    std::size_t posicionTexto = 0;  // Solo P3 y P2: siguiente byte de `pendiente` por analizar
+    std::size_t filasRestantes = 0;
+};
+
+// Entrega las filas de un PPMStripReader de una en una; las lee por franjas de hasta
+// `memoryBudget` bytes para no hacer una lectura por fila
+class PPMRowReader {
+public:
+    PPMRowReader(PPMStripReader &reader, std::size_t memoryBudget);
+
+    // Siguiente fila del raster; lanza una excepción si ya no quedan filas
+    std::span<const uint8_t> nextRow();
+
+private:
+    PPMStripReader &reader;
+    std::vector<uint8_t> franja;
+    std::size_t filasEnFranja = 0;
+    std::size_t siguiente = 0;
+};
+
+// Escritor de un PPM (P6), o PGM (P5) con un solo canal y PAM (P7) con cuatro, por franjas
+// de filas. Con "-" escribe en la salida estándar.
+class PPMStripWriter {
+public:
+    PPMStripWriter(const std::string &filePath, int width, int height, int maxColorValue, std::size_t channels = 3);
+
+    void writeRows(std::span<const uint8_t> rows);
+
+    // Vuelca lo que quede en el búfer del flujo y comprueba que se haya escrito
+    void finish();
+
+private:
+    std::ofstream file;
+    std::ostream *output; // `file` o std::cout
+};
+
+#endif // PRACTICA1_PPMSTREAM_HPP
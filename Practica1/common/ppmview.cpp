@@ -0,0 +1,220 @@
+#include "ppmview.hpp"
+#include "decimalparser.hpp"
+
+#include <cctype>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+    constexpr int MAX_COLOR_8_BIT = 255;
+    constexpr int MAX_COLOR_16_BIT = 65535;
+    constexpr int DECIMAL_BASE = 10;
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr int RGBA_CHANNELS = 4;
+
+    // Los datos se acaban antes de terminar el encabezado: con más bytes podría ser válido
+    class EncabezadoIncompleto : public std::runtime_error {
+    public:
+        EncabezadoIncompleto() : std::runtime_error("Encabezado PPM no válido") {}
+    };
+
+    bool isSeparator(const uint8_t byte) {
+        return std::isspace(byte) != 0;
+    }
+
+    // Salta espacios en blanco y comentarios hasta el siguiente campo
+    std::size_t skipSeparators(std::span<const uint8_t> data, std::size_t pos) {
+        while (pos < data.size()) {
+            if (data[pos] == '#') {
+                while (pos < data.size() && data[pos] != '\n') {
+                    ++pos;
+                }
+            } else if (isSeparator(data[pos])) {
+                ++pos;
+            } else {
+                break;
+            }
+        }
+        return pos;
+    }
+
+    // Lee un campo sin espacios: el número mágico o una palabra clave de PAM
+    std::size_t readMagicNumber(std::span<const uint8_t> data, std::size_t pos, std::string &magicNumber) {
+        pos = skipSeparators(data, pos);
+        while (pos < data.size() && !isSeparator(data[pos]) && data[pos] != '#') {
+            magicNumber.push_back(static_cast<char>(data[pos]));
+            ++pos;
+        }
+        // El campo podría seguir en los bytes que aún no se han leído
+        if (pos >= data.size()) {
+            throw EncabezadoIncompleto();
+        }
+        return pos;
+    }
+
+    std::size_t readInteger(std::span<const uint8_t> data, std::size_t pos, int &value) {
+        pos = skipSeparators(data, pos);
+        if (pos >= data.size()) {
+            throw EncabezadoIncompleto();
+        }
+        if (std::isdigit(data[pos]) == 0) {
+            throw std::runtime_error("Encabezado PPM no válido");
+        }
+
+        long long acumulado = 0;
+        while (pos < data.size() && std::isdigit(data[pos]) != 0) {
+            acumulado = (acumulado * DECIMAL_BASE) + (data[pos] - '0');
+            if (acumulado > std::numeric_limits<int>::max()) {
+                throw std::runtime_error("Encabezado PPM no válido");
+            }
+            ++pos;
+        }
+        if (pos >= data.size()) {
+            throw EncabezadoIncompleto();
+        }
+        value = static_cast<int>(acumulado);
+        return pos;
+    }
+
+    // Encabezado PAM: líneas "CLAVE valor" en cualquier orden hasta ENDHDR, tras el que
+    // empieza el raster en la línea siguiente
+    std::size_t readPAMFields(std::span<const uint8_t> data, std::size_t pos, PPMHeader &header) {
+        while (true) {
+            std::string clave;
+            pos = readMagicNumber(data, pos, clave);
+            if (clave == "ENDHDR") {
+                return pos;
+            }
+            if (clave == "WIDTH") {
+                pos = readInteger(data, pos, header.width);
+            } else if (clave == "HEIGHT") {
+                pos = readInteger(data, pos, header.height);
+            } else if (clave == "DEPTH") {
+                pos = readInteger(data, pos, header.depth);
+            } else if (clave == "MAXVAL") {
+                pos = readInteger(data, pos, header.maxColorValue);
+            } else if (clave == "TUPLTYPE") {
+                pos = readMagicNumber(data, pos, header.tupleType);
+            } else {
+                throw std::runtime_error("Encabezado PPM no válido");
+            }
+        }
+    }
+
+    void validateMaxColorValue(const PPMHeader &header) {
+        if (header.maxColorValue <= 0 || header.maxColorValue > MAX_COLOR_16_BIT) {
+            throw std::runtime_error("Valor de maxColorValue fuera de rango");
+        }
+    }
+}
+
+std::size_t PPMHeader::bytesPerSample() const {
+    return maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2;
+}
+
+std::size_t PPMHeader::pixelCount() const {
+    return static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+}
+
+std::size_t PPMHeader::rasterSize() const {
+    return pixelCount() * channels() * bytesPerSample();
+}
+
+PPMHeader parsePPMHeader(std::span<const uint8_t> data) {
+    PPMHeader header;
+    std::size_t pos = readMagicNumber(data, 0, header.magicNumber);
+    if (header.magicNumber == "P7") {
+        pos = readPAMFields(data, pos, header);
+    } else {
+        pos = readInteger(data, pos, header.width);
+        pos = readInteger(data, pos, header.height);
+        pos = readInteger(data, pos, header.maxColorValue);
+        if (header.magicNumber.starts_with("C6")) {
+            pos = readInteger(data, pos, header.colorCount);
+            if (header.magicNumber.find('T') != std::string::npos) {
+                pos = readInteger(data, pos, header.tileSize);
+                if (header.tileSize == 0) {
+                    throw std::runtime_error("Encabezado PPM no válido");
+                }
+            } else if (header.magicNumber.find('Z') != std::string::npos) {
+                pos = readInteger(data, pos, header.stripRows);
+                if (header.stripRows == 0) {
+                    throw std::runtime_error("Encabezado PPM no válido");
+                }
+            }
+        }
+    }
+
+    // Tras maxval hay exactamente un carácter separador antes del raster
+    if (pos >= data.size()) {
+        throw EncabezadoIncompleto();
+    }
+    if (!isSeparator(data[pos])) {
+        throw std::runtime_error("Encabezado PPM no válido");
+    }
+    header.dataOffset = pos + 1;
+    return header;
+}
+
+bool isTruncatedPPMHeader(const std::span<const uint8_t> data) {
+    try {
+        static_cast<void>(parsePPMHeader(data));
+    } catch (const EncabezadoIncompleto &) {
+        return true;
+    } catch (const std::runtime_error &) {
+        return false;
+    }
+    return false;
+}
+
+bool PPMHeader::isPlain() const {
+    return magicNumber == "P3" || magicNumber == "P2";
+}
+
+std::size_t PPMHeader::channels() const {
+    if (magicNumber == "P7") {
+        return static_cast<std::size_t>(depth);
+    }
+    return magicNumber == "P5" || magicNumber == "P2" ? 1 : RGB_CHANNELS;
+}
+
+void validateBinaryHeader(const PPMHeader &header) {
+    // De PAM solo se admiten tuplas RGB_ALPHA
+    const bool rgba = header.magicNumber == "P7" && header.depth == RGBA_CHANNELS && header.tupleType == "RGB_ALPHA";
+    if (header.magicNumber != "P6" && header.magicNumber != "P5" && !rgba) {
+        throw std::runtime_error("Formato no soportado");
+    }
+    validateMaxColorValue(header);
+}
+
+void validatePlainHeader(const PPMHeader &header) {
+    if (!header.isPlain()) {
+        throw std::runtime_error("Formato no soportado");
+    }
+    validateMaxColorValue(header);
+}
+
+PPMView::PPMView(const std::string &filePath) : PPMView(MappedFile(filePath)) {}
+
+PPMView::PPMView(MappedFile mappedFile) : file(std::move(mappedFile)) {
+    cabecera = parsePPMHeader(file.data());
+    if (cabecera.isPlain()) {
+        // El texto se convierte una sola vez al raster binario equivalente de un P6 (o P5)
+        validatePlainHeader(cabecera);
+        decodificado = parseDecimalRaster(file.data().subspan(cabecera.dataOffset), cabecera.pixelCount() * cabecera.channels(),
+                                          cabecera.maxColorValue);
+        return;
+    }
+    validateBinaryHeader(cabecera);
+    if (file.size() - cabecera.dataOffset < cabecera.rasterSize()) {
+        throw std::runtime_error("Archivo PPM incompleto");
+    }
+}
+
+std::span<const uint8_t> PPMView::raster() const {
+    if (cabecera.isPlain()) {
+        return decodificado;
+    }
+    return file.data().subspan(cabecera.dataOffset, cabecera.rasterSize());
+}
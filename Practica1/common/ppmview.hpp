@@ -0,0 +1,81 @@
+#ifndef PRACTICA1_PPMVIEW_HPP
+#define PRACTICA1_PPMVIEW_HPP
+
+#include "mappedfile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Encabezado de un archivo PPM ("P6 ancho alto maxval", o "P3" en texto), de su
+// equivalente en escala de grises PGM ("P5", o "P2" en texto) o de un PAM ("P7" con
+// campos WIDTH, HEIGHT, DEPTH, MAXVAL y TUPLTYPE)
+struct PPMHeader {
+    std::string magicNumber;
+    int width = 0;
+    int height = 0;
+    int maxColorValue = 0;
+    int depth = 0;          // Solo PAM
+    std::string tupleType;  // Solo PAM
+    int colorCount = 0;     // Solo CPPM (C6 y variantes): colores de la tabla
+    int tileSize = 0;       // Solo CPPM en mosaico ("C6T"): lado de las teselas
+    int stripRows = 0;      // Solo CPPM comprimido sin mosaico ("C6Z"): filas por franja
+    std::size_t dataOffset = 0; // Posición del primer byte del raster
+
+    // Bytes por muestra: 1 si maxval <= 255, 2 en otro caso
+    [[nodiscard]] std::size_t bytesPerSample() const;
+
+    [[nodiscard]] std::size_t pixelCount() const;
+
+    // Tamaño en bytes del raster (RGB, o un solo canal en escala de grises)
+    [[nodiscard]] std::size_t rasterSize() const;
+
+    // Indica si es un formato en texto (P3 o P2)
+    [[nodiscard]] bool isPlain() const;
+
+    // Canales por píxel: DEPTH en PAM, 1 en escala de grises (P5 y P2) y 3 en otro caso
+    [[nodiscard]] std::size_t channels() const;
+};
+
+// Analiza el encabezado directamente sobre los bytes del archivo, sin copiarlos.
+// Admite comentarios '#' entre los campos del encabezado. También reconoce el encabezado
+// "C6 ancho alto maxval colores" de CPPM (y de sus variantes "C6P"...; en mosaico sigue
+// el lado de tesela, y comprimido sin mosaico, las filas por franja); dataOffset apunta
+// entonces a la tabla de colores.
+PPMHeader parsePPMHeader(std::span<const uint8_t> data);
+
+// Indica si `data` se acaba antes de que termine el encabezado (por ejemplo, en medio de un
+// comentario largo): quien lee por partes debe leer más antes de llamar a parsePPMHeader
+[[nodiscard]] bool isTruncatedPPMHeader(std::span<const uint8_t> data);
+
+// Comprueba que el encabezado sea de un P6, un P5 o un PAM RGB_ALPHA con maxval entre 1 y 65535
+void validateBinaryHeader(const PPMHeader &header);
+
+// Lo mismo para un P3 o un P2 en texto
+void validatePlainHeader(const PPMHeader &header);
+
+// Vista de solo lectura de un PPM (P6) o PGM (P5) proyectado en memoria: el encabezado se
+// analiza en el sitio y el raster queda accesible sin copiarse. Un P3 o P2 se convierte
+// al abrirlo con parseDecimalRaster y raster() devuelve el resultado, idéntico al de un
+// P6 o P5.
+class PPMView {
+public:
+    explicit PPMView(const std::string &filePath);
+
+    // Vista sobre un archivo ya proyectado, para quien necesita mirar antes su formato
+    explicit PPMView(MappedFile mappedFile);
+
+    [[nodiscard]] const PPMHeader &header() const { return cabecera; }
+
+    // Bytes del raster tal y como están en un P6 o P5
+    [[nodiscard]] std::span<const uint8_t> raster() const;
+
+private:
+    MappedFile file;
+    PPMHeader cabecera;
+    std::vector<uint8_t> decodificado; // Solo para P3
+};
+
+#endif // PRACTICA1_PPMVIEW_HPP
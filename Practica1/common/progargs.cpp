@@ -1,19 +1,41 @@
 #include "progargs.hpp"
+#include "cppmview.hpp"
+#include "resample.hpp"
+
+#include <limits>
 #include <stdexcept>
 #include <vector>
+#include <set>
 #include <string>
-#include <iostream>
+#include <span>
+#include <string_view>
+#include <map>
+
+namespace {
+    constexpr std::string_view OPTION_PREFIX = "--";
+    constexpr std::size_t MAX_TILE_DIGITS = 9;
+    constexpr std::size_t MAX_LEVEL_DIGITS = 2;
+    // Hasta 999999999 MiB: el valor siempre cabe en unsigned long
+    constexpr std::size_t MAX_STREAM_DIGITS = 9;
+    constexpr std::size_t BYTES_PER_MIB = std::size_t{1024} * 1024;
+    // resize: <width> <height> sobre la salida principal y tríos <width> <height> <output>
+    constexpr std::size_t RESIZE_ARG_COUNT = 6;
+    constexpr std::size_t RESIZE_TARGET_ARGS = 3;
+}
 
 ProgArgs::ProgArgs(const std::vector<std::string>& args) {
-    inputFile = (args.size() > 1) ? args[1] : "";
-    outputFile = (args.size() > 2) ? args[2] : "";
-    operation = (args.size() > 3) ? args[3] : "";
+    const std::vector<std::string> positional = splitOptions(args, options);
+
+    inputFile = (positional.size() > 1) ? positional[1] : "";
+    outputFile = (positional.size() > 2) ? positional[2] : "";
+    operation = (positional.size() > 3) ? positional[3] : "";
 
-    validateArgs(args);
+    validateArgs(positional);
+    validateOptions(operation, options);
 
     // Los argumentos adicionales dependen de la operación seleccionada
-    for (std::size_t i = 4; i < args.size(); ++i) {
-        additionalParams.emplace_back(args[i]);
+    for (std::size_t i = 4; i < positional.size(); ++i) {
+        additionalParams.emplace_back(positional[i]);
     }
 }
 
@@ -34,13 +56,103 @@ std::vector<std::string> ProgArgs::getAdditionalParams() const {
     return additionalParams;
 }
 
+bool ProgArgs::hasOption(const std::string& name) const {
+    return options.contains(name);
+}
+
+std::string ProgArgs::getOption(const std::string& name, const std::string& defaultValue) const {
+    const auto option = options.find(name);
+    return option != options.end() ? option->second : defaultValue;
+}
+
 
 bool ProgArgs::parse(const std::vector<std::string>& args) {
     try {
-        validateArgs(args);
+        std::map<std::string, std::string> parsedOptions;
+        const std::vector<std::string> positional = splitOptions(args, parsedOptions);
+        validateArgs(positional);
+        validateOptions(positional[3], parsedOptions);
         return true;  // La validación fue exitosa
     } catch ([[maybe_unused]] const std::invalid_argument& e) {
         return false;  // Hubo un error en la validación
+    } catch ([[maybe_unused]] const std::out_of_range& e) {
+        return false;  // Un número demasiado grande para std::stoi
+    }
+}
+
+bool ProgArgs::parse(const int argc, const char* const* argv) {
+    const std::span<const char* const> argumentos(argv, static_cast<std::size_t>(argc));
+    return parse(std::vector<std::string>(argumentos.begin(), argumentos.end()));
+}
+
+std::vector<std::string> ProgArgs::splitOptions(const std::vector<std::string>& args,
+                                                std::map<std::string, std::string>& options) {
+    std::vector<std::string> positional;
+    for (const std::string& arg : args) {
+        if (arg.size() > OPTION_PREFIX.size() && arg.starts_with(OPTION_PREFIX)) {
+            const std::size_t separator = arg.find('=');
+            const std::string name = arg.substr(OPTION_PREFIX.size(), separator - OPTION_PREFIX.size());
+            options[name] = (separator == std::string::npos) ? "" : arg.substr(separator + 1);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    return positional;
+}
+
+void ProgArgs::validateOptions(const std::string& operation, const std::map<std::string, std::string>& options) {
+    for (const auto& [name, value] : options) {
+        if (name == "stream") {
+            // Modo por franjas con presupuesto de memoria en MiB (operaciones que trabajan por filas)
+            if (operation != "maxlevel" && operation != "resize") {
+                throw std::invalid_argument("Error: La opción --stream solo es válida con maxlevel y resize.");
+            }
+            static_cast<void>(streamBudgetBytes(value));
+        } else if (name == "packed") {
+            // Índices CPPM empaquetados en bits
+            if (operation != "compress" || !value.empty()) {
+                throw std::invalid_argument("Error: La opción --packed solo es válida con compress y no lleva valor.");
+            }
+        } else if (name == "lz") {
+            // Índices CPPM comprimidos con rachas y repeticiones
+            if (operation != "compress" || !value.empty()) {
+                throw std::invalid_argument("Error: La opción --lz solo es válida con compress y no lleva valor.");
+            }
+        } else if (name == "tiles") {
+            // CPPM en mosaico con teselas del lado indicado
+            if (operation != "compress") {
+                throw std::invalid_argument("Error: La opción --tiles solo es válida con compress.");
+            }
+            if (value.empty() || value.size() > MAX_TILE_DIGITS || value.find_first_not_of("0123456789") != std::string::npos ||
+                std::stoi(value) == 0) {
+                throw std::invalid_argument("Error: La opción --tiles requiere un lado de tesela mayor que 0.");
+            }
+        } else if (name == "region") {
+            // Rectángulo que se expande al descomprimir
+            if (operation != "decompress") {
+                throw std::invalid_argument("Error: La opción --region solo es válida con decompress.");
+            }
+            static_cast<void>(parseRegion(value));
+        } else if (name == "levels") {
+            // Número máximo de niveles de pyramid; sin la opción se llega hasta 1x1
+            if (operation != "pyramid") {
+                throw std::invalid_argument("Error: La opción --levels solo es válida con pyramid.");
+            }
+            if (value.empty() || value.size() > MAX_LEVEL_DIGITS || value.find_first_not_of("0123456789") != std::string::npos ||
+                std::stoi(value) == 0) {
+                throw std::invalid_argument("Error: La opción --levels requiere un número de niveles entre 1 y 99.");
+            }
+        } else if (name == "filter") {
+            // Filtro de remuestreo de resize; los separables necesitan la imagen completa
+            if (operation != "resize") {
+                throw std::invalid_argument("Error: La opción --filter solo es válida con resize.");
+            }
+            if (parseResizeFilter(value) != ResizeFilter::bilinear && options.contains("stream")) {
+                throw std::invalid_argument("Error: La opción --filter=" + value + " no se puede combinar con --stream.");
+            }
+        } else {
+            throw std::invalid_argument("Error: Opción no válida: --" + name);
+        }
     }
 }
 
@@ -55,7 +167,8 @@ void ProgArgs::validateArgs(const std::vector<std::string>& args) {
 
     const std::string& operation = args[3];
     if (operation != "info" && operation != "maxlevel" && operation != "resize" &&
-        operation != "cutfreq" && operation != "compress") {
+        operation != "cutfreq" && operation != "compress" && operation != "toplanar" && operation != "fromplanar" &&
+        operation != "decompress" && operation != "pyramid") {
         throw std::invalid_argument("Error: Operación no válida: " + operation);
     }
 
@@ -71,8 +184,18 @@ void ProgArgs::validateArgs(const std::vector<std::string>& args) {
         }
     }
 
-    if (constexpr int RESIZE_ARG_COUNT = 6; operation == "resize" && args.size() != RESIZE_ARG_COUNT) {
-        throw std::invalid_argument("Error: La operación resize requiere dos argumentos adicionales (nuevo ancho y alto).");
+    // Varios tamaños de una sola carga: cada uno se escribe en paralelo en su propia salida
+    if (operation == "resize") {
+        if (args.size() < RESIZE_ARG_COUNT || (args.size() - RESIZE_ARG_COUNT) % RESIZE_TARGET_ARGS != 0) {
+            throw std::invalid_argument("Error: La operación resize requiere nuevo ancho y alto, seguidos opcionalmente de "
+                                        "ancho, alto y salida de cada tamaño adicional.");
+        }
+        std::set<std::string> salidas{args[2]};
+        for (std::size_t i = RESIZE_ARG_COUNT + 2; i < args.size(); i += RESIZE_TARGET_ARGS) {
+            if (!salidas.insert(args[i]).second) {
+                throw std::invalid_argument("Error: Cada tamaño de resize necesita una salida distinta: " + args[i]);
+            }
+        }
     }
 
     if (operation == "cutfreq" && args.size() != MAXLEVEL_ARG_COUNT) {
@@ -82,28 +205,53 @@ void ProgArgs::validateArgs(const std::vector<std::string>& args) {
     if (operation == "compress" && args.size() != MIN_ARG_COUNT) {
         throw std::invalid_argument("Error: La operación compress no acepta argumentos adicionales.");
     }
-}
 
-// Función principal modificada
-int mainWithArgs(const std::vector<std::string>& args) {
-    // Crear una instancia de ProgArgs y analizar los argumentos
-    ProgArgs progArgs(args);
-    if (!progArgs.parse(args)) {
-        std::cerr << "Error en los argumentos." << '\n';
-        return 1;
+    // Conversión entre PPM y la caché planar, en cualquiera de los dos sentidos, y de CPPM a PPM
+    if ((operation == "toplanar" || operation == "fromplanar" || operation == "decompress") && args.size() != MIN_ARG_COUNT) {
+        throw std::invalid_argument("Error: La operación " + operation + " no acepta argumentos adicionales.");
     }
 
-    // Resto del código...
-    return 0;
+    // Un archivo por nivel, con nombres derivados de la salida
+    if (operation == "pyramid") {
+        if (args.size() != MIN_ARG_COUNT) {
+            throw std::invalid_argument("Error: La operación pyramid no acepta argumentos adicionales.");
+        }
+        if (args[2] == "-") {
+            throw std::invalid_argument("Error: La operación pyramid escribe un archivo por nivel y no admite la salida estándar.");
+        }
+    }
 }
 
-int main(int argc, char* argv[]) {
-    // Convierte los argumentos a un vector de strings sin aritmética de punteros
-    std::vector<std::string> args(argc);
-    for (int i = 0; i < argc; ++i) {
-        args[i] = argv[i];
+std::string pyramidLevelFile(const std::string& outputFile, const int level) {
+    const std::size_t punto = outputFile.rfind('.');
+    const std::size_t nombre = outputFile.rfind('/') == std::string::npos ? 0 : outputFile.rfind('/') + 1;
+    const std::string sufijo = "_" + std::to_string(level);
+    // Un punto al principio del nombre (archivo oculto) no marca una extensión
+    if (punto == std::string::npos || punto <= nombre) {
+        return outputFile + sufijo;
     }
+    return outputFile.substr(0, punto) + sufijo + outputFile.substr(punto);
+}
+
+std::vector<ResizeTarget> resizeTargets(const std::string& outputFile, const std::vector<std::string>& params) {
+    std::vector<ResizeTarget> targets{{.width = std::stoi(params.at(0)), .height = std::stoi(params.at(1)), .outputFile = outputFile}};
+    for (std::size_t i = 2; i + 2 < params.size(); i += RESIZE_TARGET_ARGS) {
+        targets.push_back({.width = std::stoi(params[i]), .height = std::stoi(params[i + 1]), .outputFile = params[i + 2]});
+    }
+    return targets;
+}
 
-    // Llama a la función principal con los argumentos como std::vector<std::string>
-    return mainWithArgs(args);
+std::size_t streamBudgetBytes(const std::string& mebibytes) {
+    if (mebibytes.empty() || mebibytes.size() > MAX_STREAM_DIGITS ||
+        mebibytes.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::invalid_argument("Error: La opción --stream requiere un tamaño en MiB entre 1 y 999999999.");
+    }
+    const unsigned long megas = std::stoul(mebibytes);
+    if (megas == 0) {
+        throw std::invalid_argument("Error: La opción --stream requiere un tamaño en MiB entre 1 y 999999999.");
+    }
+    if (megas > std::numeric_limits<std::size_t>::max() / BYTES_PER_MIB) {
+        throw std::invalid_argument("Error: El tamaño de --stream no cabe en memoria direccionable.");
+    }
+    return static_cast<std::size_t>(megas) * BYTES_PER_MIB;
 }
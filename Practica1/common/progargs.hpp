@@ -1,6 +1,10 @@
 #ifndef PRACTICA1_PROGARGS_HPP
 #define PRACTICA1_PROGARGS_HPP
 
+#include "resample.hpp"
+
+#include <cstddef>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -21,17 +25,41 @@ public:
     // Obtener parámetros adicionales si existen
     [[nodiscard]] std::vector<std::string> getAdditionalParams() const;
 
+    // Opciones de la forma --nombre=valor (o --nombre) que acompañan a la operación
+    [[nodiscard]] bool hasOption(const std::string& name) const;
+    [[nodiscard]] std::string getOption(const std::string& name, const std::string& defaultValue = "") const;
+
     // Función para analizar y validar los argumentos
     static bool parse(const std::vector<std::string>& args);
+    static bool parse(int argc, const char* const* argv);
 
 private:
     // Función para validar los argumentos recibidos
     static void validateArgs(const std::vector<std::string>& args);
 
+    // Separa las opciones "--" de los argumentos posicionales
+    static std::vector<std::string> splitOptions(const std::vector<std::string>& args,
+                                                 std::map<std::string, std::string>& options);
+
+    static void validateOptions(const std::string& operation, const std::map<std::string, std::string>& options);
+
     std::string inputFile;
     std::string outputFile;
     std::string operation;
     std::vector<std::string> additionalParams;
+    std::map<std::string, std::string> options;
 };
 
+// Archivo del nivel `level` de pyramid: el sufijo _<level> se inserta antes de la extensión
+// (salida.ppm -> salida_1.ppm) o se añade al final si no la hay
+std::string pyramidLevelFile(const std::string& outputFile, int level);
+
+// Presupuesto de --stream en bytes a partir de su valor en MiB; lanza std::invalid_argument
+// si no es un número mayor que 0 o si en bytes no cabe en std::size_t
+std::size_t streamBudgetBytes(const std::string& mebibytes);
+
+// Tamaños de resize: <width> <height> de la salida principal y después los de cada trío
+// <width> <height> <output> adicional
+std::vector<ResizeTarget> resizeTargets(const std::string& outputFile, const std::vector<std::string>& params);
+
 #endif // PRACTICA1_PROGARGS_HPP
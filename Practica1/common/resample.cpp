@@ -0,0 +1,517 @@
+#include "resample.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <numbers>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+    // Filas de origen que se filtran a la vez en horizontal
+    constexpr std::size_t FILAS_BLOQUE = 8;
+    // Filas de salida por tarea, en múltiplos de las filas de origen que se repiten entre tareas
+    constexpr std::size_t SOLAPES_POR_TAREA = 8;
+
+    constexpr double RADIO_AREA = 0.5;
+    constexpr double RADIO_BICUBICO = 2.0;
+    constexpr double RADIO_LANCZOS = 3.0;
+    constexpr double A_BICUBICO = -0.5;
+
+    double filtroArea(const double x) {
+        return (x > -RADIO_AREA && x <= RADIO_AREA) ? 1.0 : 0.0;
+    }
+
+    // Núcleo cúbico de Keys con a = -0.5 (interpola: vale 1 en 0 y 0 en los demás enteros)
+    double filtroBicubico(const double x) {
+        const double distancia = std::abs(x);
+        if (distancia < 1.0) {
+            return ((((A_BICUBICO + 2) * distancia) - (A_BICUBICO + 3)) * distancia * distancia) + 1;
+        }
+        if (distancia < RADIO_BICUBICO) {
+            constexpr double C5 = 5.0;
+            constexpr double C8 = 8.0;
+            constexpr double C4 = 4.0;
+            return ((((distancia - C5) * distancia) + C8) * distancia - C4) * A_BICUBICO;
+        }
+        return 0.0;
+    }
+
+    double sinc(const double x) {
+        if (x == 0.0) {
+            return 1.0;
+        }
+        const double angulo = std::numbers::pi * x;
+        return std::sin(angulo) / angulo;
+    }
+
+    // Lanczos de tres lóbulos
+    double filtroLanczos(const double x) {
+        return std::abs(x) < RADIO_LANCZOS ? sinc(x) * sinc(x / RADIO_LANCZOS) : 0.0;
+    }
+
+    struct Filtro {
+        double (*funcion)(double);
+        double radio;
+    };
+
+    Filtro filtroDe(const ResizeFilter filter) {
+        switch (filter) {
+            case ResizeFilter::area:
+                return {.funcion = filtroArea, .radio = RADIO_AREA};
+            case ResizeFilter::bicubic:
+                return {.funcion = filtroBicubico, .radio = RADIO_BICUBICO};
+            case ResizeFilter::lanczos:
+                return {.funcion = filtroLanczos, .radio = RADIO_LANCZOS};
+            case ResizeFilter::bilinear:
+                break;
+        }
+        throw std::invalid_argument("Error: El filtro bilinear no usa el remuestreo separable.");
+    }
+
+    // Remuestreo de una imagen: el origen de ancho x alto píxeles se filtra en horizontal a
+    // nuevoAncho columnas y en vertical a las filas del destino
+    struct Remuestreo {
+        std::span<const uint16_t> origen;
+        std::size_t ancho;
+        std::size_t alto;
+        std::size_t nuevoAncho;
+        const Resampler::AxisWeights *columnas;
+        const Resampler::AxisWeights *filas;
+        std::span<uint16_t> destino;
+        float limite;
+    };
+
+    // Columnas de bloque y coeficientes de varias salidas de una pasada horizontal
+    template <std::size_t SALIDAS>
+    using PunterosSalidas = std::array<const float *, SALIDAS>;
+
+    // resultado[s][c] = sum(coeficientes[s][t] * columnas[s][t * CARRILES + c]) para t en
+    // [0, taps). Las SALIDAS sumas son independientes, así que sus cadenas de sumas se
+    // solapan en lugar de esperar cada una a la anterior. Con AVX2 los carriles se acumulan
+    // de 8 en 8 en registros, con los mismos productos y sumas en el mismo orden que el
+    // bucle escalar, así que el resultado es idéntico (sin contracción a FMA; véase
+    // CMakeLists.txt).
+    template <std::size_t CARRILES, std::size_t SALIDAS>
+    void filtrarCarriles(const PunterosSalidas<SALIDAS> &coeficientes, const std::size_t taps,
+                         const PunterosSalidas<SALIDAS> &columnas,
+                         std::array<std::array<float, CARRILES>, SALIDAS> &resultado) {
+#if defined(__AVX2__)
+        constexpr std::size_t POR_REGISTRO = 8;
+        constexpr std::size_t REGISTROS = CARRILES / POR_REGISTRO;
+        static_assert(CARRILES % POR_REGISTRO == 0, "Los carriles deben llenar registros completos");
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+        __m256 acumulado[SALIDAS][REGISTROS];
+        for (auto &registros : acumulado) {
+            for (__m256 &registro : registros) {
+                registro = _mm256_setzero_ps();
+            }
+        }
+        for (std::size_t tap = 0; tap < taps; ++tap) {
+            for (std::size_t salida = 0; salida < SALIDAS; ++salida) {
+                const __m256 peso = _mm256_set1_ps(coeficientes[salida][tap]);
+                const float *fila = columnas[salida] + (tap * CARRILES);
+                for (std::size_t registro = 0; registro < REGISTROS; ++registro) {
+                    acumulado[salida][registro] = _mm256_add_ps(
+                            acumulado[salida][registro], _mm256_mul_ps(peso, _mm256_loadu_ps(fila + (registro * POR_REGISTRO))));
+                }
+            }
+        }
+        for (std::size_t salida = 0; salida < SALIDAS; ++salida) {
+            for (std::size_t registro = 0; registro < REGISTROS; ++registro) {
+                _mm256_storeu_ps(resultado[salida].data() + (registro * POR_REGISTRO), acumulado[salida][registro]);
+            }
+        }
+#else
+        for (std::size_t salida = 0; salida < SALIDAS; ++salida) {
+            resultado[salida].fill(0.0F);
+            for (std::size_t tap = 0; tap < taps; ++tap) {
+                for (std::size_t carril = 0; carril < CARRILES; ++carril) {
+                    resultado[salida][carril] += coeficientes[salida][tap] * columnas[salida][(tap * CARRILES) + carril];
+                }
+            }
+        }
+#endif
+    }
+
+    // Redondeo al más cercano y límite a [0, limite] (los lóbulos negativos pueden salirse
+    // del rango)
+    uint16_t muestraSalida(const float suma, const float limite) {
+        return static_cast<uint16_t>(std::clamp(suma + 0.5F, 0.0F, limite));
+    }
+
+    // destino[x] = sum(coeficientes[t] * filas[t][x]) para t en [0, taps), redondeado y
+    // limitado. Con AVX2 cada iteración acumula 32 muestras en cuatro registros
+    // independientes; el orden de las sumas de cada muestra es el del bucle escalar.
+    void filtrarVertical(const float *coeficientes, const std::vector<const float *> &filas, const float limite,
+                         const std::span<uint16_t> destino) {
+        std::size_t inicio = 0;
+#if defined(__AVX2__)
+        constexpr std::size_t POR_REGISTRO = 8;
+        constexpr std::size_t REGISTROS = 4;
+        constexpr std::size_t POR_ITERACION = POR_REGISTRO * REGISTROS;
+        const __m256 mitad = _mm256_set1_ps(0.5F);
+        const __m256 cero = _mm256_setzero_ps();
+        const __m256 maximo = _mm256_set1_ps(limite);
+        for (; inicio + POR_ITERACION <= destino.size(); inicio += POR_ITERACION) {
+            // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays, modernize-avoid-c-arrays)
+            __m256 acumulado[REGISTROS];
+            for (__m256 &registro : acumulado) {
+                registro = _mm256_setzero_ps();
+            }
+            for (std::size_t tap = 0; tap < filas.size(); ++tap) {
+                const __m256 peso = _mm256_set1_ps(coeficientes[tap]);
+                const float *fila = filas[tap] + inicio;
+                for (std::size_t registro = 0; registro < REGISTROS; ++registro) {
+                    acumulado[registro] = _mm256_add_ps(
+                            acumulado[registro], _mm256_mul_ps(peso, _mm256_loadu_ps(fila + (registro * POR_REGISTRO))));
+                }
+            }
+            for (std::size_t registro = 0; registro < REGISTROS; ++registro) {
+                const __m256 redondeado = _mm256_add_ps(acumulado[registro], mitad);
+                const __m256i enteros = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(redondeado, cero), maximo));
+                const __m128i empaquetados =
+                        _mm_packus_epi32(_mm256_castsi256_si128(enteros), _mm256_extracti128_si256(enteros, 1));
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(destino.data() + inicio + (registro * POR_REGISTRO)),
+                                 empaquetados);
+            }
+        }
+#endif
+        for (std::size_t muestra = inicio; muestra < destino.size(); ++muestra) {
+            float suma = 0.0F;
+            for (std::size_t tap = 0; tap < filas.size(); ++tap) {
+                suma += coeficientes[tap] * filas[tap][muestra];
+            }
+            destino[muestra] = muestraSalida(suma, limite);
+        }
+    }
+
+    using FilasBloque = std::array<const uint16_t *, FILAS_BLOQUE>;
+
+    // Copia las columnas [desde, hasta) de las filas del bloque a `bloque` como floats, en
+    // orden [columna][fila][canal]
+    template <std::size_t CANALES>
+    void llenarEscalar(const FilasBloque &filas, const std::size_t desde, const std::size_t hasta, float *bloque) {
+        float *escritura = bloque + (desde * FILAS_BLOQUE * CANALES);
+        for (std::size_t columna = desde; columna < hasta; ++columna) {
+            for (const uint16_t *muestras : filas) {
+                for (std::size_t canal = 0; canal < CANALES; ++canal) {
+                    *escritura++ = static_cast<float>(muestras[(columna * CANALES) + canal]);
+                }
+            }
+        }
+    }
+
+#if defined(__AVX2__)
+    __m256 cargarFloats(const uint16_t *muestras) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(muestras))));
+    }
+
+    // Un plano: 8 columnas de las 8 filas se convierten y se trasponen en registros
+    std::size_t llenarPlano(const FilasBloque &filas, const std::size_t longitud, float *bloque) {
+        constexpr std::size_t COLUMNAS = 8;
+        std::size_t columna = 0;
+        for (; columna + COLUMNAS <= longitud; columna += COLUMNAS) {
+            const __m256 bajo01 = _mm256_unpacklo_ps(cargarFloats(filas[0] + columna), cargarFloats(filas[1] + columna));
+            const __m256 alto01 = _mm256_unpackhi_ps(cargarFloats(filas[0] + columna), cargarFloats(filas[1] + columna));
+            const __m256 bajo23 = _mm256_unpacklo_ps(cargarFloats(filas[2] + columna), cargarFloats(filas[3] + columna));
+            const __m256 alto23 = _mm256_unpackhi_ps(cargarFloats(filas[2] + columna), cargarFloats(filas[3] + columna));
+            const __m256 bajo45 = _mm256_unpacklo_ps(cargarFloats(filas[4] + columna), cargarFloats(filas[5] + columna));
+            const __m256 alto45 = _mm256_unpackhi_ps(cargarFloats(filas[4] + columna), cargarFloats(filas[5] + columna));
+            const __m256 bajo67 = _mm256_unpacklo_ps(cargarFloats(filas[6] + columna), cargarFloats(filas[7] + columna));
+            const __m256 alto67 = _mm256_unpackhi_ps(cargarFloats(filas[6] + columna), cargarFloats(filas[7] + columna));
+            // Columnas (0, 4), (1, 5), (2, 6) y (3, 7) de las filas 0-3 y 4-7 en cada mitad
+            constexpr int PARES_BAJOS = 0x44;
+            constexpr int PARES_ALTOS = 0xEE;
+            const __m256 columnas04Bajas = _mm256_shuffle_ps(bajo01, bajo23, PARES_BAJOS);
+            const __m256 columnas15Bajas = _mm256_shuffle_ps(bajo01, bajo23, PARES_ALTOS);
+            const __m256 columnas26Bajas = _mm256_shuffle_ps(alto01, alto23, PARES_BAJOS);
+            const __m256 columnas37Bajas = _mm256_shuffle_ps(alto01, alto23, PARES_ALTOS);
+            const __m256 columnas04Altas = _mm256_shuffle_ps(bajo45, bajo67, PARES_BAJOS);
+            const __m256 columnas15Altas = _mm256_shuffle_ps(bajo45, bajo67, PARES_ALTOS);
+            const __m256 columnas26Altas = _mm256_shuffle_ps(alto45, alto67, PARES_BAJOS);
+            const __m256 columnas37Altas = _mm256_shuffle_ps(alto45, alto67, PARES_ALTOS);
+            constexpr int MITADES_BAJAS = 0x20;
+            constexpr int MITADES_ALTAS = 0x31;
+            float *escritura = bloque + (columna * FILAS_BLOQUE);
+            const auto guardar = [escritura](const std::size_t indice, const __m256 valores) {
+                _mm256_storeu_ps(escritura + (indice * FILAS_BLOQUE), valores);
+            };
+            guardar(0, _mm256_permute2f128_ps(columnas04Bajas, columnas04Altas, MITADES_BAJAS));
+            guardar(1, _mm256_permute2f128_ps(columnas15Bajas, columnas15Altas, MITADES_BAJAS));
+            guardar(2, _mm256_permute2f128_ps(columnas26Bajas, columnas26Altas, MITADES_BAJAS));
+            guardar(3, _mm256_permute2f128_ps(columnas37Bajas, columnas37Altas, MITADES_BAJAS));
+            guardar(4, _mm256_permute2f128_ps(columnas04Bajas, columnas04Altas, MITADES_ALTAS));
+            guardar(5, _mm256_permute2f128_ps(columnas15Bajas, columnas15Altas, MITADES_ALTAS));
+            guardar(6, _mm256_permute2f128_ps(columnas26Bajas, columnas26Altas, MITADES_ALTAS));
+            guardar(7, _mm256_permute2f128_ps(columnas37Bajas, columnas37Altas, MITADES_ALTAS));
+        }
+        return columna;
+    }
+
+    // Píxeles de 3 o 4 canales: cada uno se convierte con 4 carriles. Con 3 canales el
+    // cuarto float invade el siguiente píxel, que se escribe justo después, y la última
+    // columna (cuya lectura saldría de la fila) queda para el bucle escalar.
+    template <std::size_t CANALES>
+    std::size_t llenarPixeles(const FilasBloque &filas, const std::size_t longitud, float *bloque) {
+        const std::size_t columnas = longitud - 1;
+        float *escritura = bloque;
+        for (std::size_t columna = 0; columna < columnas; ++columna) {
+            for (const uint16_t *muestras : filas) {
+                // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+                const __m128i enteros = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(muestras + (columna * CANALES)));
+                _mm_storeu_ps(escritura, _mm_cvtepi32_ps(_mm_cvtepu16_epi32(enteros)));
+                escritura += CANALES;
+            }
+        }
+        return columnas;
+    }
+#endif
+
+    template <std::size_t CANALES>
+    void llenarBloque(const FilasBloque &filas, const std::size_t longitud, float *bloque) {
+        std::size_t copiadas = 0;
+#if defined(__AVX2__)
+        if constexpr (CANALES == 1) {
+            copiadas = llenarPlano(filas, longitud, bloque);
+        } else {
+            copiadas = llenarPixeles<CANALES>(filas, longitud, bloque);
+        }
+#endif
+        llenarEscalar<CANALES>(filas, copiadas, longitud, bloque);
+    }
+
+    // Filas de origen ya filtradas en horizontal (nuevoAncho píxeles en float) que necesita
+    // la fila de salida en curso; la fila s ocupa la posición s % capacidad
+    class AnilloFilas {
+    public:
+        AnilloFilas(const std::size_t capacidad, const std::size_t muestrasFila)
+                : datos(capacidad * muestrasFila), capacidad(capacidad), muestrasFila(muestrasFila) {}
+
+        float *fila(const std::size_t fila) { return datos.data() + ((fila % capacidad) * muestrasFila); }
+
+    private:
+        std::vector<float> datos;
+        std::size_t capacidad;
+        std::size_t muestrasFila;
+    };
+
+    // Salidas [salida, salida + SALIDAS) de un bloque ya copiado: se calculan a la vez y
+    // cada fila real del bloque recibe sus canales en el anillo
+    template <std::size_t CANALES, std::size_t SALIDAS>
+    void filtrarSalidas(const Resampler::AxisWeights &pesos, const std::vector<float> &bloque,
+                        const std::array<float *, FILAS_BLOQUE> &filas, const std::size_t filasBloque,
+                        const std::size_t salida) {
+        constexpr std::size_t CARRILES = FILAS_BLOQUE * CANALES;
+        PunterosSalidas<SALIDAS> coeficientes{};
+        PunterosSalidas<SALIDAS> columnas{};
+        for (std::size_t indice = 0; indice < SALIDAS; ++indice) {
+            coeficientes[indice] = pesos.weights.data() + ((salida + indice) * pesos.taps);
+            columnas[indice] = bloque.data() + (pesos.first[salida + indice] * CARRILES);
+        }
+        std::array<std::array<float, CARRILES>, SALIDAS> resultado{};
+        filtrarCarriles<CARRILES, SALIDAS>(coeficientes, pesos.taps, columnas, resultado);
+        for (std::size_t indice = 0; indice < SALIDAS; ++indice) {
+            for (std::size_t fila = 0; fila < filasBloque; ++fila) {
+                std::copy_n(resultado[indice].begin() + static_cast<std::ptrdiff_t>(fila * CANALES), CANALES,
+                            filas[fila] + ((salida + indice) * CANALES));
+            }
+        }
+    }
+
+    // Filtra en horizontal las filas [inicio, inicio + filasBloque) del origen y las guarda en
+    // el anillo. El bloque se copia primero a `bloque` como floats, con las muestras de la
+    // misma columna de todas las filas contiguas ([columna][fila][canal]), así que cada
+    // salida es una suma de `taps` vectores de FILAS_BLOQUE * CANALES carriles. Las salidas
+    // se calculan de dos en dos. Un bloque incompleto repite su última fila y solo se
+    // guardan los carriles de las filas reales.
+    template <std::size_t CANALES>
+    void filtrarBloque(const Remuestreo &remuestreo, const std::size_t inicio, const std::size_t filasBloque,
+                       std::vector<float> &bloque, AnilloFilas &anillo) {
+        constexpr std::size_t PAREJA = 2;
+        const Resampler::AxisWeights &pesos = *remuestreo.columnas;
+        FilasBloque filas{};
+        std::array<float *, FILAS_BLOQUE> salidas{};
+        for (std::size_t fila = 0; fila < FILAS_BLOQUE; ++fila) {
+            const std::size_t real = inicio + std::min(fila, filasBloque - 1);
+            filas[fila] = remuestreo.origen.data() + (real * remuestreo.ancho * CANALES);
+            salidas[fila] = anillo.fila(real);
+        }
+        llenarBloque<CANALES>(filas, remuestreo.ancho, bloque.data());
+
+        std::size_t salida = 0;
+        for (; salida + PAREJA <= pesos.first.size(); salida += PAREJA) {
+            filtrarSalidas<CANALES, PAREJA>(pesos, bloque, salidas, filasBloque, salida);
+        }
+        if (salida < pesos.first.size()) {
+            filtrarSalidas<CANALES, 1>(pesos, bloque, salidas, filasBloque, salida);
+        }
+    }
+
+    // Filas [primera, ultima) del destino. Las filas de origen se filtran en horizontal por
+    // bloques a medida que las pide la ventana vertical y se guardan en un anillo con sitio
+    // para la ventana y un bloque más, así que cada fila de origen se filtra una vez por tarea
+    // y el resultado intermedio (en float, sin redondear) no sale de la caché.
+    template <std::size_t CANALES>
+    void remuestrearFilas(const Remuestreo &remuestreo, const std::size_t primera, const std::size_t ultima) {
+        const Resampler::AxisWeights &pesos = *remuestreo.filas;
+        const std::size_t muestrasFila = remuestreo.nuevoAncho * CANALES;
+        AnilloFilas anillo(pesos.taps + FILAS_BLOQUE, muestrasFila);
+        std::vector<float> bloque(remuestreo.ancho * FILAS_BLOQUE * CANALES);
+        std::vector<const float *> ventana(pesos.taps);
+
+        std::size_t filtradas = pesos.first[primera];
+        for (std::size_t salida = primera; salida < ultima; ++salida) {
+            const std::size_t desde = pesos.first[salida];
+            filtradas = std::max(filtradas, desde);
+            while (filtradas < desde + pesos.taps) {
+                const std::size_t filasBloque = std::min(FILAS_BLOQUE, remuestreo.alto - filtradas);
+                filtrarBloque<CANALES>(remuestreo, filtradas, filasBloque, bloque, anillo);
+                filtradas += filasBloque;
+            }
+            for (std::size_t tap = 0; tap < pesos.taps; ++tap) {
+                ventana[tap] = anillo.fila(desde + tap);
+            }
+            filtrarVertical(pesos.weights.data() + (salida * pesos.taps), ventana, remuestreo.limite,
+                            remuestreo.destino.subspan(salida * muestrasFila, muestrasFila));
+        }
+    }
+}
+
+ResizeFilter parseResizeFilter(const std::string &name) {
+    if (name == "bilinear") {
+        return ResizeFilter::bilinear;
+    }
+    if (name == "area") {
+        return ResizeFilter::area;
+    }
+    if (name == "bicubic") {
+        return ResizeFilter::bicubic;
+    }
+    if (name == "lanczos") {
+        return ResizeFilter::lanczos;
+    }
+    throw std::invalid_argument("Error: Filtro no válido: " + name + " (bilinear, area, bicubic o lanczos).");
+}
+
+// Cada salida se centra en (j + 0.5) * escala. Al reducir, el filtro se ensancha por la
+// escala para cubrir todo el origen que le corresponde; al ampliar conserva su radio. Las
+// ventanas que se salen de la imagen se recortan y se renormalizan, y todas las salidas
+// usan el mismo número de taps (con ceros) para que el bucle interior sea uniforme.
+Resampler::AxisWeights Resampler::axisWeights(const int size, const int newSize, const ResizeFilter filter) {
+    const Filtro filtro = filtroDe(filter);
+    const double escala = static_cast<double>(size) / static_cast<double>(newSize);
+    const double ensanche = std::max(escala, 1.0);
+    const double soporte = filtro.radio * ensanche;
+    const auto origen = static_cast<std::size_t>(size);
+    const auto taps = std::min(origen, static_cast<std::size_t>(std::ceil(2 * soporte)) + 1);
+
+    AxisWeights pesos{.taps = taps, .first = std::vector<uint32_t>(static_cast<std::size_t>(newSize)),
+                      .weights = std::vector<float>(static_cast<std::size_t>(newSize) * taps, 0.0F)};
+    for (std::size_t salida = 0; salida < pesos.first.size(); ++salida) {
+        const double centro = (static_cast<double>(salida) + 0.5) * escala;
+        const auto desde = static_cast<std::size_t>(std::max(0.0, std::floor(centro - soporte + 0.5)));
+        const std::size_t hasta = std::min({origen, desde + taps,
+                                            static_cast<std::size_t>(std::max(0.0, std::floor(centro + soporte + 0.5)))});
+        const std::size_t primero = std::min(desde, origen - taps);
+
+        std::vector<double> valores(taps, 0.0);
+        double suma = 0.0;
+        for (std::size_t muestra = desde; muestra < hasta; ++muestra) {
+            const double valor = filtro.funcion((static_cast<double>(muestra) - centro + 0.5) / ensanche);
+            valores[muestra - primero] = valor;
+            suma += valor;
+        }
+        for (std::size_t tap = 0; tap < taps; ++tap) {
+            pesos.weights[(salida * taps) + tap] = static_cast<float>(suma != 0.0 ? valores[tap] / suma : 0.0);
+        }
+        pesos.first[salida] = static_cast<uint32_t>(primero);
+    }
+    return pesos;
+}
+
+Resampler::Resampler(const int width, const int height, const int newWidth, const int newHeight,
+                     const ResizeFilter filter)
+        : width(width), height(height), newWidth(newWidth),
+          columns(axisWeights(width, newWidth, filter)), rows(axisWeights(height, newHeight, filter)) {}
+
+void Resampler::resample(std::span<const uint16_t> source, const std::size_t channels, const int maxColorValue,
+                         std::span<uint16_t> destination) const {
+    const Remuestreo remuestreo{.origen = source, .ancho = static_cast<std::size_t>(width),
+                                .alto = static_cast<std::size_t>(height), .nuevoAncho = static_cast<std::size_t>(newWidth),
+                                .columnas = &columns, .filas = &rows, .destino = destination,
+                                .limite = static_cast<float>(maxColorValue)};
+
+    // Cada tarea vuelve a filtrar las filas de origen que comparte con la anterior (la
+    // ventana y el último bloque): con bandas de al menos SOLAPES_POR_TAREA veces ese solape
+    // se repite poco trabajo
+    const std::size_t nuevoAlto = rows.first.size();
+    const std::size_t solape = ((rows.taps + FILAS_BLOQUE) * nuevoAlto / remuestreo.alto) + 1;
+    const std::size_t filasTarea = std::max(rowsPerTask(remuestreo.nuevoAncho), SOLAPES_POR_TAREA * solape);
+    constexpr std::size_t CANALES_RGB = 3;
+    constexpr std::size_t CANALES_RGBA = 4;
+    parallelForRanges(nuevoAlto, filasTarea, [&](const std::size_t primera, const std::size_t ultima) {
+        switch (channels) {
+            case 1:
+                remuestrearFilas<1>(remuestreo, primera, ultima);
+                break;
+            case CANALES_RGB:
+                remuestrearFilas<CANALES_RGB>(remuestreo, primera, ultima);
+                break;
+            default:
+                remuestrearFilas<CANALES_RGBA>(remuestreo, primera, ultima);
+                break;
+        }
+    });
+}
+
+ResizeCascade planResizeCascade(const int width, const int height, const std::span<const ResizeTarget> targets,
+                                const ResizeFilter filter) {
+    const auto pixeles = [](const ResizeTarget &target) {
+        return static_cast<int64_t>(target.width) * static_cast<int64_t>(target.height);
+    };
+    const auto reduceExacto = [](const int ancho, const int alto, const ResizeTarget &target) {
+        return ancho % target.width == 0 && alto % target.height == 0;
+    };
+
+    // De mayor a menor: los posibles orígenes de cada tamaño se han decidido antes que él
+    std::vector<std::size_t> orden(targets.size());
+    std::iota(orden.begin(), orden.end(), std::size_t{0});
+    std::ranges::stable_sort(orden, std::greater{}, [&](const std::size_t indice) { return pixeles(targets[indice]); });
+
+    ResizeCascade cascada{.sources = std::vector<std::optional<std::size_t>>(targets.size()), .stages = {}};
+    std::vector<std::size_t> etapa(targets.size(), 0);
+    for (std::size_t posicion = 0; posicion < orden.size(); ++posicion) {
+        const ResizeTarget &target = targets[orden[posicion]];
+        std::optional<std::size_t> origen;
+        for (std::size_t anterior = 0; anterior < posicion; ++anterior) {
+            const ResizeTarget &mayor = targets[orden[anterior]];
+            if (mayor.width == target.width && mayor.height == target.height) {
+                origen = orden[anterior];
+                break;
+            }
+            // Los candidatos van de mayor a menor: el último válido es el más cercano y, entre
+            // varios iguales, se queda el primero
+            if (filter == ResizeFilter::area && reduceExacto(width, height, mayor) &&
+                reduceExacto(mayor.width, mayor.height, target) && (!origen || pixeles(mayor) < pixeles(targets[*origen]))) {
+                origen = orden[anterior];
+            }
+        }
+        cascada.sources[orden[posicion]] = origen;
+        etapa[orden[posicion]] = origen ? etapa[*origen] + 1 : 0;
+    }
+
+    for (std::size_t indice = 0; indice < targets.size(); ++indice) {
+        cascada.stages.resize(std::max(cascada.stages.size(), etapa[indice] + 1));
+        cascada.stages[etapa[indice]].push_back(indice);
+    }
+    return cascada;
+}
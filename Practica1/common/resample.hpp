@@ -0,0 +1,79 @@
+#ifndef PRACTICA1_RESAMPLE_HPP
+#define PRACTICA1_RESAMPLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Filtros de resize. bilinear es la interpolación de siempre de cada implementación; el
+// resto se aplican con el motor separable de Resampler y, al reducir, ensanchan el filtro en
+// proporción para promediar todo el origen (sin aliasing).
+enum class ResizeFilter {
+    bilinear,
+    area,
+    bicubic,
+    lanczos
+};
+
+// Convierte el valor de --filter; lanza std::invalid_argument si no es ninguno de los anteriores
+ResizeFilter parseResizeFilter(const std::string &name);
+
+// Remuestreo separable en dos pasadas con tablas de pesos normalizados calculadas una vez
+// por eje. Las filas de salida se reparten entre hilos por bandas. En cada banda las filas
+// de origen se filtran en horizontal de 8 en 8, traspuestas en un bloque para que cada
+// carril sea una fila, y se guardan en float en un anillo de filas; cada fila de salida
+// combina en vertical las del anillo que le tocan, recorriendo memoria contigua. El
+// resultado intermedio no se redondea y no sale de la caché.
+class Resampler {
+public:
+    Resampler(int width, int height, int newWidth, int newHeight, ResizeFilter filter);
+
+    // Remuestrea píxeles de `channels` muestras contiguas (1, 3 o 4), fila a fila, de
+    // `source` a `destination`; el resultado se redondea y se limita a [0, maxColorValue]
+    void resample(std::span<const uint16_t> source, std::size_t channels, int maxColorValue,
+                  std::span<uint16_t> destination) const;
+
+    // Pesos de un eje: la salida j combina `taps` muestras consecutivas de origen desde
+    // first[j] con weights[j * taps ...]; los pesos de cada salida suman 1
+    struct AxisWeights {
+        std::size_t taps;
+        std::vector<uint32_t> first;
+        std::vector<float> weights;
+    };
+
+    static AxisWeights axisWeights(int size, int newSize, ResizeFilter filter);
+
+private:
+    int width;
+    int height;
+    int newWidth;
+    AxisWeights columns;
+    AxisWeights rows;
+};
+
+// Uno de los tamaños de resize y el archivo en el que se guarda
+struct ResizeTarget {
+    int width;
+    int height;
+    std::string outputFile;
+};
+
+// Orden en el que se calculan varios tamaños de una misma imagen. sources[i] es el tamaño ya
+// calculado del que se obtiene el i (sin valor: de la imagen original) y cada etapa de
+// stages reúne tamaños cuyos orígenes están listos, que pueden calcularse a la vez.
+struct ResizeCascade {
+    std::vector<std::optional<std::size_t>> sources;
+    std::vector<std::vector<std::size_t>> stages;
+};
+
+// Un tamaño se obtiene en cascada desde otro mayor solo si el filtro da lo mismo: un tamaño
+// repetido es una copia del primero con cualquier filtro, y con el de área se parte del
+// menor tamaño que reduce el original y reduce a este por factores enteros (la media de las
+// medias de bloques iguales es la media del bloque; solo cambia el redondeo intermedio, en
+// 1 como mucho). El resto se calcula desde el original.
+ResizeCascade planResizeCascade(int width, int height, std::span<const ResizeTarget> targets, ResizeFilter filter);
+
+#endif // PRACTICA1_RESAMPLE_HPP
@@ -0,0 +1,54 @@
+#include "sharedmemory.hpp"
+
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    // Los mismos permisos que crearía std::ofstream (sujetos a la umask)
+    constexpr mode_t SEGMENT_MODE = 0666;
+}
+
+bool isSharedMemory(const std::string &path) {
+    return path.starts_with(SHARED_MEMORY_PREFIX);
+}
+
+std::string sharedMemoryName(const std::string &path) {
+    const std::string nombre = path.substr(SHARED_MEMORY_PREFIX.size());
+    if (nombre.empty() || nombre.find('/') != std::string::npos) {
+        throw std::invalid_argument("Nombre de memoria compartida no válido: " + path);
+    }
+    return "/" + nombre;
+}
+
+SharedMemorySegment::SharedMemorySegment(const std::string &path, const std::size_t size) : length(size) {
+    const std::string nombre = sharedMemoryName(path);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+    const int descriptor = ::shm_open(nombre.c_str(), O_RDWR | O_CREAT | O_TRUNC, SEGMENT_MODE);
+    if (descriptor < 0) {
+        throw std::runtime_error("Error al crear la memoria compartida: " + path);
+    }
+    if (::ftruncate(descriptor, static_cast<off_t>(size)) != 0) {
+        ::close(descriptor);
+        throw std::runtime_error("Error al crear la memoria compartida: " + path);
+    }
+
+    if (size > 0) {
+        void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+        if (address == MAP_FAILED) {
+            ::close(descriptor);
+            throw std::runtime_error("Error al proyectar la memoria compartida: " + path);
+        }
+        mapping = static_cast<uint8_t *>(address);
+    }
+
+    // La proyección se mantiene válida después de cerrar el descriptor
+    ::close(descriptor);
+}
+
+SharedMemorySegment::~SharedMemorySegment() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, length);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef PRACTICA1_SHAREDMEMORY_HPP
+#define PRACTICA1_SHAREDMEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Prefijo de las rutas que designan un segmento de memoria compartida POSIX ("shm:nombre")
+constexpr std::string_view SHARED_MEMORY_PREFIX = "shm:";
+
+[[nodiscard]] bool isSharedMemory(const std::string &path);
+
+// Nombre del segmento para shm_open ("shm:nombre" -> "/nombre")
+[[nodiscard]] std::string sharedMemoryName(const std::string &path);
+
+// Segmento de memoria compartida creado (o reemplazado) con un tamaño fijo y proyectado
+// para escritura. El contenido se compone directamente en las páginas del segmento; el
+// segmento sobrevive al proceso hasta que otro lo lee como entrada: MappedFile lo elimina
+// (shm_unlink) al proyectarlo.
+class SharedMemorySegment {
+public:
+    SharedMemorySegment(const std::string &path, std::size_t size);
+    ~SharedMemorySegment();
+
+    SharedMemorySegment(const SharedMemorySegment &) = delete;
+    SharedMemorySegment &operator=(const SharedMemorySegment &) = delete;
+    SharedMemorySegment(SharedMemorySegment &&) = delete;
+    SharedMemorySegment &operator=(SharedMemorySegment &&) = delete;
+
+    [[nodiscard]] std::span<uint8_t> data() const { return {mapping, length}; }
+
+private:
+    uint8_t *mapping = nullptr;
+    std::size_t length = 0;
+};
+
+#endif // PRACTICA1_SHAREDMEMORY_HPP
@@ -1,244 +1,478 @@
 #include "imageaos.hpp"
+#include "common/ppmstream.hpp"
+#include "common/outputtarget.hpp"
+#include "common/parallel.hpp"
+#include "common/pixelkernels.hpp"
+#include "common/planarcache.hpp"
+#include "common/cppmview.hpp"
+#include "common/cppmpalette.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
-#include <cmath>
 #include <unordered_map>
 #include <string>
-#include <cstring>
 #include <ranges>
+#include <utility>
 
 namespace {
     constexpr int MAX_COLOR_8_BIT = 255;
     constexpr int BYTE_SHIFT = 8;
     constexpr int BYTE_MASK = 0xFF;
-    constexpr int RED_SHIFT = 16;
-    constexpr int GREEN_SHIFT = 8;
     constexpr int BYTE_MASK_SHIFT_16 = 16;
-    constexpr int BYTE_MASK_SHIFT_24 = 24;
-    constexpr int MAX_COLOR_8_BIT_RANGE = 256;
-    constexpr int MAX_COLOR_16_BIT_RANGE = 65536;
+    constexpr std::size_t RGB_CHANNELS = 3;
+    constexpr std::size_t RGBA_CHANNELS = 4;
+
+    // Los píxeles AoS tienen tres canales, o cuatro con alfa: las imágenes en escala de
+    // grises (P5, P2) solo las admite el backend SoA
+    void requireColor(const PPMHeader &header) {
+        if (header.channels() != RGB_CHANNELS && header.channels() != RGBA_CHANNELS) {
+            throw std::runtime_error("Formato no soportado");
+        }
+    }
+
+    // La tabla de colores CPPM no tiene canal alfa
+    void requireOpaque(const bool hasAlpha) {
+        if (hasAlpha) {
+            throw std::runtime_error("Formato no soportado");
+        }
+    }
 
+    // Posiciones de origen de cada columna de destino (originalX = newX * xRatio) en punto
+    // fijo con pesos de `bits` bits. Con yRatio y la altura sirve igual para las filas.
+    std::vector<ResizeColumn> resizeColumns(const int newWidth, const float xRatio, const int width,
+                                            const unsigned bits) {
+        std::vector<ResizeColumn> columnas(static_cast<size_t>(newWidth));
+        for (int newX = 0; newX < newWidth; ++newX) {
+            const float originalX = static_cast<float>(newX) * xRatio;
+            const int baseX = static_cast<int>(originalX);
+            columnas[static_cast<size_t>(newX)] =
+                    fixedResizeColumn(static_cast<size_t>(baseX), static_cast<size_t>(std::min(baseX + 1, width - 1)),
+                                      originalX - static_cast<float>(baseX), bits);
+        }
+        return columnas;
+    }
 }
 
-// Cargar una imagen PPM
+// Cargar una imagen PPM: el archivo se proyecta en memoria y los píxeles se copian
+// directamente desde las páginas proyectadas, sin búfer intermedio.
 void Image::loadPPM(const std::string &filename) {
-  std::ifstream file(filename, std::ios::binary);
-  if (!file.is_open()) {
-    throw std::runtime_error("Error al abrir el archivo");
-  }
+    MappedFile file(filename);
+    if (isPlanarCache(file.data())) {
+        loadPlanar(PlanarView(std::move(file)));
+    } else {
+        const PPMView view(std::move(file));
+        readHeader(view.header());
+        loadPixels(view.raster());
+    }
+    checkSampleRange(std::as_const(*this).samples(), maxColorValue);
+}
 
-  readHeader(file);
-  loadPixels(file);
+// Cada píxel toma su muestra de cada plano; los planos de 16 bits ya están en el orden
+// del host, así que solo se copian. Los bloques de píxeles se reparten entre hilos.
+void Image::loadPlanar(const PlanarView &view) {
+    const PlanarHeader &header = view.header();
+    if (header.channels != RGB_CHANNELS && header.channels != RGBA_CHANNELS) {
+        throw std::runtime_error("Formato no soportado");
+    }
+
+    width = header.width;
+    height = header.height;
+    maxColorValue = header.maxColorValue;
+    hasAlpha = header.channels == RGBA_CHANNELS;
+    if (hasAlpha) {
+        pixelsRGBA.resize(header.pixelCount());
+    } else {
+        pixels.resize(header.pixelCount());
+    }
 
-  file.close();
+    const std::span<uint16_t> destination = samples();
+    const size_t pixelChannels = header.channels;
+    const bool eightBit = maxColorValue <= MAX_COLOR_8_BIT;
+    parallelForRanges(header.pixelCount(), PARALLEL_GRAIN_PIXELS, [&](const size_t first, const size_t last) {
+        for (size_t channel = 0; channel < pixelChannels; ++channel) {
+            const std::span<const uint8_t> plane = view.plane(channel);
+            for (size_t i = first; i < last; ++i) {
+                uint16_t sample = 0;
+                if (eightBit) {
+                    sample = plane[i];
+                } else {
+                    std::memcpy(&sample, &plane[2 * i], sizeof(sample));
+                }
+                destination[(i * pixelChannels) + channel] = sample;
+            }
+        }
+    });
 }
 
-// Lee el encabezado del archivo PPM para obtener el ancho, alto y valor máximo de color.
-void Image::readHeader(std::ifstream &file) {
-    std::string magicNumber;
-    file >> magicNumber;
-    if (magicNumber != "P6") {
-        throw std::runtime_error("Formato no soportado");
+// Toma el ancho, alto y valor máximo de color del encabezado PPM.
+void Image::readHeader(const PPMHeader &header) {
+    requireColor(header);
+
+    width = header.width;
+    height = header.height;
+    maxColorValue = header.maxColorValue;
+    hasAlpha = header.channels() == RGBA_CHANNELS;
+}
+
+std::span<uint16_t> Image::samples() {
+    static_assert(sizeof(Pixel) == 3 * sizeof(uint16_t), "Pixel debe ser tres uint16_t contiguos");
+    static_assert(sizeof(PixelRGBA) == 4 * sizeof(uint16_t), "PixelRGBA debe ser cuatro uint16_t contiguos");
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (hasAlpha) {
+        return {reinterpret_cast<uint16_t *>(pixelsRGBA.data()), pixelsRGBA.size() * RGBA_CHANNELS};
     }
+    return {reinterpret_cast<uint16_t *>(pixels.data()), pixels.size() * RGB_CHANNELS};
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+}
 
-    file >> width >> height >> maxColorValue;
-    file.ignore(1); // Ignorar el espacio en blanco o salto de línea después del maxColorValue
+std::span<const uint16_t> Image::samples() const {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (hasAlpha) {
+        return {reinterpret_cast<const uint16_t *>(pixelsRGBA.data()), pixelsRGBA.size() * RGBA_CHANNELS};
+    }
+    return {reinterpret_cast<const uint16_t *>(pixels.data()), pixels.size() * RGB_CHANNELS};
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
 }
 
 // Determina el formato de bits de los píxeles y los carga en la estructura de la imagen.
-void Image::loadPixels(std::ifstream &file) {
+void Image::loadPixels(std::span<const uint8_t> raster) {
+    if (hasAlpha) {
+        loadPixelsRGBA(raster);
+        return;
+    }
     pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
 
     if (maxColorValue <= MAX_COLOR_8_BIT) {
-        loadPixels8Bit(file);
+        loadPixels8Bit(raster);
     } else {
-        loadPixels16Bit(file);
+        loadPixels16Bit(raster);
     }
 }
 
 // Carga los píxeles de la imagen en formato de 8 bits por canal.
-void Image::loadPixels8Bit(std::ifstream &file) {
-    std::vector<char> tempBuffer(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
-    file.read(tempBuffer.data(), static_cast<std::streamsize>(tempBuffer.size()));
-
-    std::vector<uint8_t> buffer(tempBuffer.begin(), tempBuffer.end());
+void Image::loadPixels8Bit(std::span<const uint8_t> raster) {
     for (size_t i = 0; i < pixels.size(); ++i) {
-        pixels[i].red = buffer[i * 3];
-        pixels[i].green = buffer[(i * 3) + 1];
-        pixels[i].blue = buffer[(i * 3) + 2];
+        pixels[i].red = raster[i * 3];
+        pixels[i].green = raster[(i * 3) + 1];
+        pixels[i].blue = raster[(i * 3) + 2];
     }
 }
 
-// Carga los píxeles de la imagen en formato de 16 bits por canal.
-void Image::loadPixels16Bit(std::ifstream &file) {
-    std::vector<char> tempBuffer(static_cast<size_t>(width) * static_cast<size_t>(height) * 3 * sizeof(uint16_t));
-    file.read(tempBuffer.data(), static_cast<std::streamsize>(tempBuffer.size()));
-
-    std::vector<uint16_t> buffer(tempBuffer.size() / 2);
-    std::memcpy(buffer.data(), tempBuffer.data(), tempBuffer.size());
+// Carga los píxeles de la imagen en formato de 16 bits por canal. Las muestras del archivo
+// son big-endian: se invierten en una sola pasada y se escriben directamente en `pixels`,
+// repartiendo bloques de filas entre hilos.
+void Image::loadPixels16Bit(std::span<const uint8_t> raster) {
+    const std::span<uint16_t> muestras = samples();
+
+    auto const muestrasFila = static_cast<size_t>(width) * 3;
+    parallelForRanges(static_cast<size_t>(height), rowsPerTask(static_cast<size_t>(width)),
+                      [&](const size_t primera, const size_t ultima) {
+                          const size_t inicio = primera * muestrasFila;
+                          const size_t cantidad = (ultima - primera) * muestrasFila;
+                          loadSamples16BE(raster.subspan(inicio * 2, cantidad * 2), muestras.subspan(inicio, cantidad));
+                      });
+}
 
-    for (size_t i = 0; i < pixels.size(); ++i) {
-        pixels[i].red = buffer[i * 3];
-        pixels[i].green = buffer[(i * 3) + 1];
-        pixels[i].blue = buffer[(i * 3) + 2];
-    }
+// Un píxel RGBA son cuatro muestras contiguas: el raster entero se carga como un solo canal
+// (ampliando bytes o invirtiendo el orden de bytes), por bloques de filas en paralelo
+void Image::loadPixelsRGBA(std::span<const uint8_t> raster) {
+    pixelsRGBA.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    const std::span<uint16_t> muestras = samples();
+
+    const bool ochoBits = maxColorValue <= MAX_COLOR_8_BIT;
+    auto const muestrasFila = static_cast<size_t>(width) * RGBA_CHANNELS;
+    parallelForRanges(static_cast<size_t>(height), rowsPerTask(static_cast<size_t>(width)),
+                      [&](const size_t primera, const size_t ultima) {
+                          const size_t inicio = primera * muestrasFila;
+                          const size_t cantidad = (ultima - primera) * muestrasFila;
+                          if (ochoBits) {
+                              widenSamples8(raster.subspan(inicio, cantidad), muestras.subspan(inicio, cantidad));
+                          } else {
+                              loadSamples16BE(raster.subspan(inicio * 2, cantidad * 2), muestras.subspan(inicio, cantidad));
+                          }
+                      });
 }
 
-// Guardar la imagen PPM
+// Guardar la imagen PPM (PAM si tiene alfa): el encabezado fija el tamaño final, así que el
+// archivo se reserva entero y los bloques de píxeles se codifican y escriben en paralelo, cada
+// uno en su posición ("-" escribe en la salida estándar por bloques secuenciales)
 void Image::savePPM(const std::string &filename) const {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error al guardar el archivo");
-    }
-
-    file << "P6\n" << width << " " << height << "\n" << maxColorValue << "\n";
+    const size_t bytesPorPixel = channels() * (maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2);
+    writeEncodedOutput(filename, formatPPMHeader(width, height, maxColorValue, channels()), pixelCount(), bytesPorPixel,
+                       [this](const size_t first, const size_t last, const std::span<uint8_t> out) {
+                           encodePixels(first, last, out);
+                       });
+}
 
-    if (maxColorValue <= MAX_COLOR_8_BIT) {
-        for (const Pixel &pixel : pixels) {
-            file.put(static_cast<char>(pixel.red));
-            file.put(static_cast<char>(pixel.green));
-            file.put(static_cast<char>(pixel.blue));
-        }
-    } else {
-        for (const Pixel &pixel : pixels) {
-            file.put(static_cast<char>(pixel.red >> BYTE_SHIFT));
-            file.put(static_cast<char>(pixel.red & BYTE_MASK));
-            file.put(static_cast<char>(pixel.green >> BYTE_SHIFT));
-            file.put(static_cast<char>(pixel.green & BYTE_MASK));
-            file.put(static_cast<char>(pixel.blue >> BYTE_SHIFT));
-            file.put(static_cast<char>(pixel.blue & BYTE_MASK));
-        }
+// Cargar una imagen CPPM: la tabla se convierte a píxeles y los índices se expanden en
+// paralelo (por bloques de filas o por teselas), copiando a cada píxel su color
+void Image::loadCPPM(const std::string &filename, const std::optional<CPPMRegion> &region) {
+    const CPPMView view(filename);
+    const CPPMRegion area = region.value_or(view.fullRegion());
+    width = area.width;
+    height = area.height;
+    maxColorValue = view.header().maxColorValue;
+    hasAlpha = false;
+    pixelsRGBA.clear();
+
+    std::vector<Pixel> palette;
+    palette.reserve(view.palette().size());
+    for (const PaletteColor &color : view.palette()) {
+        palette.push_back({.red = color[0], .green = color[1], .blue = color[2]});
     }
 
-    file.close();
+    pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+    const auto rowWidth = static_cast<size_t>(width);
+    view.expandRegion(area, [&](const size_t x, const size_t y, const size_t index) {
+        pixels[(y * rowWidth) + x] = palette[index];
+    });
 }
 
-void Image::compress(const std::string &filename) const {
-    // Genera la tabla de colores
-    auto [colorTable, colorList] = generateColorTable();
+// Guardar en la caché planar: cada bloque de un plano recoge un canal de los píxeles
+void Image::savePlanar(const std::string &filename) const {
+    const std::span<const uint16_t> source = samples();
+    const size_t pixelChannels = channels();
+    const bool eightBit = maxColorValue <= MAX_COLOR_8_BIT;
+    writePlanarCache(filename, PlanarHeader{.width = width, .height = height, .maxColorValue = maxColorValue, .channels = pixelChannels},
+                     [&](const size_t plane, const size_t first, const size_t last, const std::span<uint8_t> out) {
+                         for (size_t i = first; i < last; ++i) {
+                             const uint16_t sample = source[(i * pixelChannels) + plane];
+                             if (eightBit) {
+                                 out[i - first] = static_cast<uint8_t>(sample);
+                             } else {
+                                 std::memcpy(&out[2 * (i - first)], &sample, sizeof(sample));
+                             }
+                         }
+                     });
+}
 
-    // Abre el archivo de salida
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error al guardar el archivo comprimido");
-    }
+// Compresión CPPM: los píxeles se codifican como raster P6 y se comprimen con compressImage,
+// así que la tabla y los índices coinciden con los de compressMapped. El raster codificado
+// es una copia completa que se suma a la memoria de la imagen
+void Image::compress(const std::string &filename) const {
+    requireOpaque(hasAlpha);
+    compressImage(rasterHeader(), pixelEncoder(), filename);
+}
 
-    // Escribir el encabezado y la tabla de colores
-    writeHeaderAndColorTable(file, colorList);
+// Tabla de colores en orden de primera aparición, con la clave de colorKey
+ColorPalette Image::generateColorTable() const {
+    return buildPalette(encodedRaster(), rasterHeader());
+}
 
-    // Determinar el tamaño de los índices
-    int indexSize = 0;
-    if (colorList.size() <= MAX_COLOR_8_BIT_RANGE) {
-        indexSize = 1;
-    } else if (colorList.size() <= MAX_COLOR_16_BIT_RANGE) {
-        indexSize = 2;
-    } else {
-        indexSize = 4;
-    }
+// Encabezado P6 (o PAM con alfa) equivalente a la imagen
+PPMHeader Image::rasterHeader() const {
+    return rasterPPMHeader(width, height, maxColorValue, channels());
+}
 
-    // Escribir los índices de los píxeles
-    writePixelIndices(file, colorTable, indexSize);
+// Raster completo codificado en memoria por bloques en paralelo
+std::vector<uint8_t> Image::encodedRaster() const {
+    return encodeRaster(rasterHeader(), pixelEncoder());
+}
 
-    file.close();
+ItemEncoder Image::pixelEncoder() const {
+    return [this](const size_t first, const size_t last, const std::span<uint8_t> out) {
+        encodePixels(first, last, out);
+    };
 }
 
 
-// Generar la tabla de colores
-std::pair<std::unordered_map<int, int>, std::vector<int>> Image::generateColorTable() const {
-    std::unordered_map<int, int> colorTable;
-    std::vector<int> colorList;
-    int index = 0;
+// Escalar la intensidad de los colores para la versión AOS
+void Image::scaleIntensity(float nuevoMaxLevel) {
+
+    // Calcular el factor de escala basado en el nuevo valor máximo
+    float const factor = nuevoMaxLevel / static_cast<float>(maxColorValue);
 
-    for (const Pixel &pixel : pixels) {
-        int const colorValue = (pixel.red << RED_SHIFT) | (pixel.green << GREEN_SHIFT) | pixel.blue;
-        if (!colorTable.contains(colorValue)) {
-            colorTable[colorValue] = index++;
-            colorList.push_back(colorValue);
-        }
-    }
-    return {colorTable, colorList};
+    // Todas las muestras se escalan igual: se recorren como un vector plano con el núcleo
+    // SIMD, repartiendo bloques entre hilos
+    const std::span<uint16_t> muestras = samples();
+    parallelForRanges(muestras.size(), PARALLEL_GRAIN_PIXELS, [&](const size_t primera, const size_t ultima) {
+        scaleSamples(muestras.subspan(primera, ultima - primera), factor);
+    });
+
+    maxColorValue = static_cast<int>(nuevoMaxLevel);
 }
 
-// Escribir el encabezado y la tabla de colores
-void Image::writeHeaderAndColorTable(std::ofstream &file, const std::vector<int> &colorList) const {
-    file << "C6 " << width << " " << height << " " << maxColorValue << " " << colorList.size() << "\n";
+void Image::scaleIntensityCPPM(const std::string &inputFile, const std::string &outputFile, const float nuevoMaxLevel) {
+    rewriteCPPMPalette(inputFile, outputFile, static_cast<int>(nuevoMaxLevel),
+                       [nuevoMaxLevel](const std::span<uint16_t> muestras, const int maximoActual) {
+                           scaleSamples(muestras, nuevoMaxLevel / static_cast<float>(maximoActual));
+                       });
+}
 
-    for (int const color : colorList) {
-        uint16_t const red = (color >> RED_SHIFT) & BYTE_MASK;
-        uint16_t const green = (color >> GREEN_SHIFT) & BYTE_MASK;
-        uint16_t const blue = color & BYTE_MASK;
+// Escala la intensidad por franjas: cada franja se carga, escala y codifica con las mismas
+// funciones que el camino en memoria, por lo que la salida es idéntica byte a byte.
+void Image::scaleIntensityStreaming(const std::string &inputFile, const std::string &outputFile,
+                                    const float nuevoMaxLevel, const std::size_t memoryBudget) {
+    PPMStripReader reader(inputFile);
+    const PPMHeader &cabecera = reader.header();
+    requireColor(cabecera);
+    const int nuevoMax = static_cast<int>(nuevoMaxLevel);
+    // La entrada se lee mientras se escribe: sobre la misma ruta se escribe en un temporal
+    OutputTarget objetivo(inputFile, outputFile);
+    PPMStripWriter writer(objetivo.path(), cabecera.width, cabecera.height, nuevoMax, cabecera.channels());
+
+    const size_t anchoFila = static_cast<size_t>(cabecera.width);
+    const size_t bytesSalida = anchoFila * cabecera.channels() * (nuevoMax <= MAX_COLOR_8_BIT ? 1 : 2);
+    const size_t filasPorFranja =
+            rowsForBudget(memoryBudget, reader.rowBytes() + (anchoFila * sizeof(PixelRGBA)) + bytesSalida);
+
+    std::vector<uint8_t> entrada(filasPorFranja * reader.rowBytes());
+    std::vector<uint8_t> salida(filasPorFranja * bytesSalida);
+    Image franja({.width = cabecera.width, .height = 0}, cabecera.maxColorValue);
+    franja.hasAlpha = cabecera.channels() == RGBA_CHANNELS;
+
+    for (size_t filas = reader.readRows(entrada); filas > 0; filas = reader.readRows(entrada)) {
+        franja.height = static_cast<int>(filas);
+        franja.maxColorValue = cabecera.maxColorValue;
+        franja.loadPixels(std::span(entrada).first(filas * reader.rowBytes()));
+        franja.scaleIntensity(nuevoMaxLevel);
+        franja.encodePixels(0, franja.pixelCount(), salida);
+        writer.writeRows(std::span(salida).first(filas * bytesSalida));
+    }
+    writer.finish();
+    objetivo.commit();
+}
 
-        if (maxColorValue <= DEFAULT_MAX_COLOR_VALUE) {
-            file.put(static_cast<char>(red));
-            file.put(static_cast<char>(green));
-            file.put(static_cast<char>(blue));
-        } else {
-            file.put(static_cast<char>(red >> BYTE_SHIFT));
-            file.put(static_cast<char>(red & BYTE_MASK));
-            file.put(static_cast<char>(green >> BYTE_SHIFT));
-            file.put(static_cast<char>(green & BYTE_MASK));
-            file.put(static_cast<char>(blue >> BYTE_SHIFT));
-            file.put(static_cast<char>(blue & BYTE_MASK));
-        }
+// Codifica los píxeles [first, last) como raster P6 (o PAM)
+void Image::encodePixels(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    if (hasAlpha) {
+        encodePixelsRGBA(first, last, out);
+    } else if (maxColorValue <= MAX_COLOR_8_BIT) {
+        encodePixels8Bit(first, last, out);
+    } else {
+        encodePixels16Bit(first, last, out);
     }
 }
 
-// Escribir los índices de los píxeles
-void Image::writePixelIndices(std::ofstream &file, const std::unordered_map<int, int> &colorTable, int indexSize) const {
-    for (const Pixel &pixel : pixels) {
-        int const colorValue = (pixel.red << RED_SHIFT) | (pixel.green << GREEN_SHIFT) | pixel.blue;
-        int const colorIndex = colorTable.at(colorValue);
-
-        if (indexSize == 1) {
-            file.put(static_cast<char>(colorIndex));
-        } else if (indexSize == 2) {
-            file.put(static_cast<char>(colorIndex & BYTE_MASK));
-            file.put(static_cast<char>(colorIndex >> BYTE_SHIFT));
-        } else if (indexSize == 4) {
-            file.put(static_cast<char>(colorIndex & BYTE_MASK));
-            file.put(static_cast<char>((colorIndex >> BYTE_SHIFT) & BYTE_MASK));
-            file.put(static_cast<char>((colorIndex >> BYTE_MASK_SHIFT_16) & BYTE_MASK));
-            file.put(static_cast<char>((colorIndex >> BYTE_MASK_SHIFT_24) & BYTE_MASK));
-        }
+// Una muestra por byte
+void Image::encodePixels8Bit(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    size_t pos = 0;
+    for (size_t i = first; i < last; ++i) {
+        out[pos] = static_cast<uint8_t>(pixels[i].red);
+        out[pos + 1] = static_cast<uint8_t>(pixels[i].green);
+        out[pos + 2] = static_cast<uint8_t>(pixels[i].blue);
+        pos += 3;
     }
 }
 
+// Dos bytes por muestra, el más significativo primero
+void Image::encodePixels16Bit(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    size_t pos = 0;
+    for (size_t i = first; i < last; ++i) {
+        out[pos] = static_cast<uint8_t>(pixels[i].red >> BYTE_SHIFT);
+        out[pos + 1] = static_cast<uint8_t>(pixels[i].red & BYTE_MASK);
+        out[pos + 2] = static_cast<uint8_t>(pixels[i].green >> BYTE_SHIFT);
+        out[pos + 3] = static_cast<uint8_t>(pixels[i].green & BYTE_MASK);
+        out[pos + 4] = static_cast<uint8_t>(pixels[i].blue >> BYTE_SHIFT);
+        out[pos + 5] = static_cast<uint8_t>(pixels[i].blue & BYTE_MASK);
+        pos += 6;
+    }
+}
 
-// Escalar la intensidad de los colores para la versión AOS
-void Image::scaleIntensity(float nuevoMaxLevel) {
+// Con alfa las muestras ya están en el orden del raster: basta reducirlas a bytes o
+// escribirlas big-endian con los núcleos de un canal
+void Image::encodePixelsRGBA(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    const std::span<const uint16_t> muestras = samples().subspan(first * RGBA_CHANNELS, (last - first) * RGBA_CHANNELS);
+    if (maxColorValue <= MAX_COLOR_8_BIT) {
+        narrowSamples8(muestras, out.first(muestras.size()));
+    } else {
+        storeSamples16BE(muestras, out.first(2 * muestras.size()));
+    }
+}
 
-    // Calcular el factor de escala basado en el nuevo valor máximo
-    float const factor = nuevoMaxLevel / static_cast<float>(maxColorValue);
+void Image::resize(const int nuevo_ancho, const int nuevo_alto, const ResizeFilter filter) {
+    *this = resized(nuevo_ancho, nuevo_alto, filter);
+}
 
-    // Escalar los valores de los píxeles
-    for (Pixel &pixel : pixels) {
-        pixel.red = static_cast<uint16_t>(std::round(static_cast<float>(pixel.red) * factor));
-        pixel.green = static_cast<uint16_t>(std::round(static_cast<float>(pixel.green) * factor));
-        pixel.blue = static_cast<uint16_t>(std::round(static_cast<float>(pixel.blue) * factor));
+// Las posiciones y pesos de origen de columnas y filas se calculan una vez en dos tablas de
+// punto fijo; después se reparten bloques de filas de destino entre hilos y cada fila se
+// interpola con el núcleo entero en una sola pasada para todos los canales (3 o 4)
+Image Image::resized(const int nuevo_ancho, const int nuevo_alto, const ResizeFilter filter) const {
+    if (filter == ResizeFilter::area && width % nuevo_ancho == 0 && height % nuevo_alto == 0) {
+        return boxReduced(width / nuevo_ancho, height / nuevo_alto);
     }
+    if (filter != ResizeFilter::bilinear) {
+        return resampled(nuevo_ancho, nuevo_alto, filter);
+    }
+    const unsigned bits = resizeWeightBits(maxColorValue);
+    const auto [xRatio, yRatio] = calculateRatios({.width = nuevo_ancho, .height = nuevo_alto});
+    const std::vector<ResizeColumn> columnas = resizeColumns(nuevo_ancho, xRatio, width, bits);
+    const std::vector<ResizeColumn> filas = resizeColumns(nuevo_alto, yRatio, height, bits);
+
+    Image destino = withSize(nuevo_ancho, nuevo_alto);
+    const std::span<const uint16_t> origen = samples();
+    const std::span<uint16_t> salida = destino.samples();
+    const size_t canales = channels();
+    auto const muestrasFila = static_cast<size_t>(width) * canales;
+    auto const muestrasFilaNueva = static_cast<size_t>(nuevo_ancho) * canales;
+    parallelForRanges(filas.size(), rowsPerTask(static_cast<size_t>(nuevo_ancho)),
+                      [&](const size_t primera, const size_t ultima) {
+                          for (size_t newY = primera; newY < ultima; ++newY) {
+                              const ResizeColumn &fila = filas[newY];
+                              const size_t abajo = nextSample(fila, static_cast<size_t>(height));
+                              interpolateRow(origen.subspan(fila.left * muestrasFila, muestrasFila),
+                                             origen.subspan(abajo * muestrasFila, muestrasFila), columnas,
+                                             fila.weight, bits, canales,
+                                             salida.subspan(newY * muestrasFilaNueva, muestrasFilaNueva));
+                          }
+                      });
 
-    maxColorValue = static_cast<int>(nuevoMaxLevel);
+    return destino;
 }
 
-void Image::resize(const int nuevo_ancho, const int nuevo_alto) {
-    const ImageDimensions newDimensions = {.width = nuevo_ancho, .height = nuevo_alto};
-    auto [xRatio, yRatio] = calculateRatios(newDimensions);
+// Los píxeles se remuestrean como muestras intercaladas, con los tres o cuatro canales en
+// el mismo recorrido
+Image Image::resampled(const int newWidth, const int newHeight, const ResizeFilter filter) const {
+    const Resampler resampler(width, height, newWidth, newHeight, filter);
+    Image destino = withSize(newWidth, newHeight);
+    resampler.resample(samples(), channels(), maxColorValue, destino.samples());
+    return destino;
+}
 
-    const Ratios ratios = {.xRatio = xRatio, .yRatio = yRatio};
+void Image::reduceBox(const int factorX, const int factorY) {
+    *this = boxReduced(factorX, factorY);
+}
 
-    std::vector<Pixel> newPixels(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto));
+// Cada fila de destino reúne las factorY filas de origen de su bloque (la última se repite
+// en el borde inferior) y el núcleo las reduce con todos los canales en el mismo recorrido
+Image Image::boxReduced(const int factorX, const int factorY) const {
+    const int nuevoAncho = (width + factorX - 1) / factorX;
+    const int nuevoAlto = (height + factorY - 1) / factorY;
+    Image destino = withSize(nuevoAncho, nuevoAlto);
+
+    const std::span<const uint16_t> origen = samples();
+    const std::span<uint16_t> salida = destino.samples();
+    const size_t canales = channels();
+    auto const muestrasFila = static_cast<size_t>(width) * canales;
+    auto const muestrasFilaNueva = static_cast<size_t>(nuevoAncho) * canales;
+    auto const filasBloque = static_cast<size_t>(factorY);
+    parallelForRanges(static_cast<size_t>(nuevoAlto), rowsPerTask(static_cast<size_t>(nuevoAncho)),
+                      [&](const size_t primera, const size_t ultima) {
+                          std::vector<std::span<const uint16_t>> filas(filasBloque);
+                          for (size_t newY = primera; newY < ultima; ++newY) {
+                              for (size_t fila = 0; fila < filasBloque; ++fila) {
+                                  const size_t origenY = std::min((newY * filasBloque) + fila, static_cast<size_t>(height) - 1);
+                                  filas[fila] = origen.subspan(origenY * muestrasFila, muestrasFila);
+                              }
+                              boxReduceRow(filas, static_cast<size_t>(factorX), canales,
+                                           salida.subspan(newY * muestrasFilaNueva, muestrasFilaNueva));
+                          }
+                      });
 
-    for (int newY = 0; newY < nuevo_alto; ++newY) {
-        for (int newX = 0; newX < nuevo_ancho; ++newX) {
-            newPixels[(static_cast<size_t>(newY) * static_cast<size_t>(nuevo_ancho)) +
-                      static_cast<size_t>(newX)] = getInterpolatedPixel(newX, newY, ratios);
-        }
-    }
+    return destino;
+}
 
-    updateImage(newDimensions, newPixels);
+Image Image::withSize(const int newWidth, const int newHeight) const {
+    Image destino({.width = newWidth, .height = newHeight}, maxColorValue);
+    destino.hasAlpha = hasAlpha;
+    const size_t pixeles = static_cast<size_t>(newWidth) * static_cast<size_t>(newHeight);
+    destino.pixels.resize(hasAlpha ? 0 : pixeles);
+    destino.pixelsRGBA.resize(hasAlpha ? pixeles : 0);
+    return destino;
 }
 
 std::pair<float, float> Image::calculateRatios(ImageDimensions dimensions) const {
@@ -247,44 +481,58 @@ std::pair<float, float> Image::calculateRatios(ImageDimensions dimensions) const
     return {xRatio, yRatio};
 }
 
-Pixel Image::getInterpolatedPixel(const int newX, const int newY, const Ratios ratios) const {
-    const float originalX = static_cast<float>(newX) * ratios.xRatio;
-    const float originalY = static_cast<float>(newY) * ratios.yRatio;
-    const int baseX = static_cast<int>(originalX);
-    const int baseY = static_cast<int>(originalY);
-
-    const float deltaX = originalX - static_cast<float>(baseX);
-    const float deltaY = originalY - static_cast<float>(baseY);
-
-    const Pixel topLeft = pixels[(static_cast<size_t>(baseY) * static_cast<size_t>(width)) +
-                                 static_cast<size_t>(baseX)];
-    const Pixel topRight = pixels[(static_cast<size_t>(baseY) * static_cast<size_t>(width)) +
-                                  static_cast<size_t>(baseX + 1)];
-    const Pixel bottomLeft = pixels[(static_cast<size_t>(baseY + 1) * static_cast<size_t>(width)) +
-                                    static_cast<size_t>(baseX)];
-    const Pixel bottomRight = pixels[(static_cast<size_t>(baseY + 1) * static_cast<size_t>(width)) +
-                                     static_cast<size_t>(baseX + 1)];
-
-    Pixel interpolatedPixel = {.red = 0, .green = 0, .blue = 0};
-    interpolatedPixel.red = static_cast<uint16_t>(((1 - deltaX) * (1 - deltaY) * static_cast<float>(topLeft.red)) +
-                                                (deltaX * (1 - deltaY) * static_cast<float>(topRight.red)) +
-                                                ((1 - deltaX) * deltaY * static_cast<float>(bottomLeft.red)) +
-                                                (deltaX * deltaY * static_cast<float>(bottomRight.red)));
-    interpolatedPixel.green = static_cast<uint16_t>(((1 - deltaX) * (1 - deltaY) * static_cast<float>(topLeft.green)) +
-                                                (deltaX * (1 - deltaY) * static_cast<float>(topRight.green)) +
-                                                ((1 - deltaX) * deltaY * static_cast<float>(bottomLeft.green)) +
-                                                (deltaX * deltaY * static_cast<float>(bottomRight.green)));
-    interpolatedPixel.blue = static_cast<uint16_t>(((1 - deltaX) * (1 - deltaY) * static_cast<float>(topLeft.blue)) +
-                                                (deltaX * (1 - deltaY) * static_cast<float>(topRight.blue)) +
-                                                ((1 - deltaX) * deltaY * static_cast<float>(bottomLeft.blue)) +
-                                                (deltaX * deltaY * static_cast<float>(bottomRight.blue)));
-    return interpolatedPixel;
-}
-
-void Image::updateImage(const ImageDimensions& dimensions, const std::vector<Pixel>& newPixels) {
-    width = dimensions.width;
-    height = dimensions.height;
-    pixels = newPixels;
+// Redimensiona leyendo el origen fila a fila: cada fila de destino solo necesita las dos
+// filas de origen que la rodean, que se guardan en una ventana circular de dos filas.
+// El resultado es idéntico al de resize().
+void Image::resizeStreaming(const std::string &inputFile, const std::string &outputFile, const int newWidth,
+                            const int newHeight, const std::size_t memoryBudget) {
+    PPMStripReader reader(inputFile);
+    const PPMHeader &cabecera = reader.header();
+    requireColor(cabecera);
+    const bool alfa = cabecera.channels() == RGBA_CHANNELS;
+    // La entrada se lee mientras se escribe: sobre la misma ruta se escribe en un temporal
+    OutputTarget objetivo(inputFile, outputFile);
+    PPMStripWriter writer(objetivo.path(), newWidth, newHeight, cabecera.maxColorValue, cabecera.channels());
+    PPMRowReader filasOrigen(reader, memoryBudget);
+
+    const Image origen({.width = cabecera.width, .height = cabecera.height}, cabecera.maxColorValue);
+    const auto [xRatio, yRatio] = origen.calculateRatios({.width = newWidth, .height = newHeight});
+    const unsigned bits = resizeWeightBits(cabecera.maxColorValue);
+    const std::vector<ResizeColumn> columnas = resizeColumns(newWidth, xRatio, cabecera.width, bits);
+    const std::vector<ResizeColumn> filas = resizeColumns(newHeight, yRatio, cabecera.height, bits);
+
+    // La fila de origen r se guarda en ventana[r % 2]
+    std::array<Image, 2> ventana = {Image({.width = cabecera.width, .height = 1}, cabecera.maxColorValue),
+                                    Image({.width = cabecera.width, .height = 1}, cabecera.maxColorValue)};
+    for (Image &fila : ventana) {
+        fila.hasAlpha = alfa;
+    }
+    int filasCargadas = 0;
+
+    Image destino({.width = newWidth, .height = 1}, cabecera.maxColorValue);
+    destino.hasAlpha = alfa;
+    destino.pixels.resize(alfa ? 0 : static_cast<size_t>(newWidth));
+    destino.pixelsRGBA.resize(alfa ? static_cast<size_t>(newWidth) : 0);
+    std::vector<uint8_t> salida(static_cast<size_t>(newWidth) * cabecera.channels() *
+                                (cabecera.maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2));
+
+    for (const ResizeColumn &fila : filas) {
+        // Se avanza hasta tener cargada la fila inferior (la última si la imagen tiene una sola)
+        const size_t filaInferior = nextSample(fila, static_cast<size_t>(cabecera.height));
+        while (filasCargadas <= static_cast<int>(filaInferior)) {
+            ventana.at(static_cast<size_t>(filasCargadas % 2)).loadPixels(filasOrigen.nextRow());
+            ++filasCargadas;
+        }
+
+        const Image &arriba = ventana.at(fila.left % 2);
+        const Image &abajo = ventana.at(filaInferior % 2);
+        interpolateRow(arriba.samples(), abajo.samples(), columnas, fila.weight, bits, cabecera.channels(),
+                       destino.samples());
+        destino.encodePixels(0, destino.pixelCount(), salida);
+        writer.writeRows(salida);
+    }
+    writer.finish();
+    objetivo.commit();
 }
 
 std::vector<std::pair<int, int>> Image::calculateColorFrequencies() const {
@@ -374,6 +622,7 @@ KDTreeNode* Image::findNearestColor(KDTreeNode* root, const Color& targetColor,
 
 // Eliminar colores poco frecuentes
 void Image::removeRareColors(const int threshold) {
+    requireOpaque(hasAlpha);
     auto sortedColors = calculateColorFrequencies();
 
     std::unordered_map<int, int> rareColors;
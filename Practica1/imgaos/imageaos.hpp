@@ -3,11 +3,23 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <ostream>
+#include <span>
 #include <unordered_map>
 #include <utility>
 
+#include "common/ppmview.hpp"
+#include "common/positionalwriter.hpp"
+#include "common/cppmview.hpp"
+#include "common/cppmcompress.hpp"
+#include "common/resample.hpp"
+
+class PlanarView;
+
 struct KDTreeNode;
 constexpr int DEFAULT_MAX_COLOR_VALUE = 255;  // Constante global para el valor máximo del color
 
@@ -16,17 +28,17 @@ struct Pixel {
     uint16_t red, green, blue;  // Soporte para valores de 0 a 65535 (2 bytes por canal de color)
 };
 
+// Píxel con transparencia (PAM RGB_ALPHA): 8 bytes, dos píxeles por registro de 128 bits
+struct PixelRGBA {
+    uint16_t red, green, blue, alpha;
+};
+
 // Estructura para representar las dimensiones de la imagen
 struct ImageDimensions {
     int width;
     int height;
 };
 
-struct Ratios {
-    float xRatio;
-    float yRatio;
-};
-
 struct Color {
     uint16_t red;
     uint16_t green;
@@ -48,6 +60,30 @@ class Image {
 private:
     int width, height, maxColorValue;
     std::vector<Pixel> pixels;
+    std::vector<PixelRGBA> pixelsRGBA; // Solo se usa si hasAlpha
+    bool hasAlpha = false;
+
+    // Muestras de todos los píxeles como un único vector plano (3 o 4 por píxel)
+    std::span<uint16_t> samples();
+    [[nodiscard]] std::span<const uint16_t> samples() const;
+    [[nodiscard]] std::size_t channels() const { return hasAlpha ? 4 : 3; }
+    [[nodiscard]] std::size_t pixelCount() const { return hasAlpha ? pixelsRGBA.size() : pixels.size(); }
+
+    // Versiones RGBA: cargan y guardan las muestras con los núcleos de un canal
+    void loadPixelsRGBA(std::span<const uint8_t> raster);
+    void encodePixelsRGBA(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+
+    // Imagen del tamaño indicado, con la misma profundidad y canales y los píxeles a cero
+    [[nodiscard]] Image withSize(int newWidth, int newHeight) const;
+
+    // Resultado de resize con uno de los filtros separables de Resampler
+    [[nodiscard]] Image resampled(int newWidth, int newHeight, ResizeFilter filter) const;
+
+    // Resultado de reduceBox
+    [[nodiscard]] Image boxReduced(int factorX, int factorY) const;
+
+    // Intercala los planos de la caché planar en los píxeles
+    void loadPlanar(const PlanarView &view);
 
 public:
     // Constructor con inicialización
@@ -58,40 +94,76 @@ public:
     [[nodiscard]] int getWidth() const { return width; }
     [[nodiscard]] int getHeight() const { return height; }
     [[nodiscard]] int getMaxColorValue() const { return maxColorValue; }
+    [[nodiscard]] bool getHasAlpha() const { return hasAlpha; }
+    [[nodiscard]] const std::vector<PixelRGBA> &getPixelsRGBA() const { return pixelsRGBA; }
 
-    // Cargar imagen PPM
+    // Cargar imagen PPM (también PAM o la caché planar, que se detecta por su firma)
     void loadPPM(const std::string &filename);
 
-    // Lee el encabezado del archivo PPM para obtener el ancho, alto y valor máximo de color.
-    void readHeader(std::ifstream &file);
+    // Toma el ancho, alto y valor máximo de color del encabezado PPM.
+    void readHeader(const PPMHeader &header);
 
     // Determina el formato de bits de los píxeles y los carga en la estructura de la imagen.
-    void loadPixels(std::ifstream &file);
+    void loadPixels(std::span<const uint8_t> raster);
 
     // Carga los píxeles de la imagen en formato de 8 bits por canal.
-    void loadPixels8Bit(std::ifstream &file);
+    void loadPixels8Bit(std::span<const uint8_t> raster);
 
     // Carga los píxeles de la imagen en formato de 16 bits por canal.
-    void loadPixels16Bit(std::ifstream &file);
+    void loadPixels16Bit(std::span<const uint8_t> raster);
 
     // Guardar imagen PPM
     void savePPM(const std::string &filename) const;
 
+    // Guardar en la caché planar: un plano por canal (ver common/planarcache.hpp)
+    void savePlanar(const std::string &filename) const;
+
+    // Cargar una imagen CPPM (C6) expandiendo sus índices a píxeles; con `region` solo se
+    // carga ese rectángulo
+    void loadCPPM(const std::string &filename, const std::optional<CPPMRegion> &region = std::nullopt);
+
     // Escalar la intensidad de los colores
     void scaleIntensity(float factor);
 
-    // Redimensionar usando interpolación bilineal
-    void resize(int newWidth, int newHeight);
+    // Escala la intensidad de un CPPM reescribiendo solo su tabla de colores, con el mismo
+    // redondeo que scaleIntensity
+    static void scaleIntensityCPPM(const std::string &inputFile, const std::string &outputFile, float nuevoMaxLevel);
+
+    // Escala la intensidad por franjas de filas sin cargar la imagen completa; memoryBudget
+    // limita los bytes de trabajo (franja leída, píxeles y franja codificada). La salida puede
+    // ser la propia entrada: se escribe en un temporal que se renombra (ver OutputTarget)
+    static void scaleIntensityStreaming(const std::string &inputFile, const std::string &outputFile,
+                                        float nuevoMaxLevel, std::size_t memoryBudget);
+
+    // Codifica los píxeles [first, last) como raster P6 (o PAM con alfa) de 8 o 16 bits según maxColorValue
+    void encodePixels(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    void encodePixels8Bit(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    void encodePixels16Bit(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    // encodePixels como codificador de encodeRaster y compressImage
+    [[nodiscard]] ItemEncoder pixelEncoder() const;
+
+    // Redimensionar usando interpolación bilineal, por bloques de filas en paralelo, o con
+    // uno de los filtros separables de Resampler. El filtro de área con factores enteros es
+    // la media de cada bloque y se calcula con reduceBox
+    void resize(int newWidth, int newHeight, ResizeFilter filter = ResizeFilter::bilinear);
+
+    // Como resize, pero devuelve la imagen redimensionada y deja esta intacta
+    [[nodiscard]] Image resized(int newWidth, int newHeight, ResizeFilter filter = ResizeFilter::bilinear) const;
+
+    // Reduce cada bloque de factorX x factorY píxeles a su media redondeada. El tamaño nuevo
+    // se redondea hacia arriba: los bloques incompletos de los bordes derecho e inferior
+    // repiten la última columna o fila, así que con factor 2 son la media de lo que hay
+    void reduceBox(int factorX, int factorY);
+
+    // Redimensiona por filas sin cargar la imagen completa: solo mantiene dos filas de
+    // origen; memoryBudget limita las franjas en las que se lee la entrada. Como en
+    // scaleIntensityStreaming, la salida puede ser la propia entrada
+    static void resizeStreaming(const std::string &inputFile, const std::string &outputFile, int newWidth,
+                                int newHeight, std::size_t memoryBudget);
 
     // Declaración de la función `calculateRatios`
     [[nodiscard]] std::pair<float, float> calculateRatios(ImageDimensions dimensions) const;
 
-    // Declaración de la función `updateImage`
-    void updateImage(const ImageDimensions& dimensions, const std::vector<Pixel>& newPixels);
-
-    // Calcula el color interpolado de un píxel en una posición redimensionada
-    [[nodiscard]] Pixel getInterpolatedPixel(int newX, int newY, Ratios ratios) const;
-
     // Eliminar colores poco frecuentes
 
     static std::unordered_map<int, int> replaceRareColorsOptimized(std::unordered_map<int, int> &rareColors,
@@ -105,14 +177,15 @@ public:
 
     // Calcula la frecuencia de cada color en la imagen
 
-    // Genera la tabla de colores y su mapeo en el archivo comprimido
-    [[nodiscard]] std::pair<std::unordered_map<int, int>, std::vector<int>> generateColorTable() const;
+    // Genera la tabla de colores del archivo comprimido, la misma que usa compress
+    [[nodiscard]] ColorPalette generateColorTable() const;
 
-    // Escribe el encabezado y la tabla de colores en el archivo comprimido
-    void writeHeaderAndColorTable(std::ofstream &file, const std::vector<int> &colorList) const;
+    // Encabezado y raster P6 (o PAM con alfa) equivalentes a la imagen
+    [[nodiscard]] PPMHeader rasterHeader() const;
+    [[nodiscard]] std::vector<uint8_t> encodedRaster() const;
 
-    // Escribe los índices de los píxeles en el archivo comprimido
-    void writePixelIndices(std::ofstream &file, const std::unordered_map<int, int> &colorTable, int indexSize) const;
+    // compress construye encodedRaster() entero, una copia que se suma a la memoria de la
+    // imagen; compressMapped, en cambio, comprime el raster del archivo proyectado
 
     [[nodiscard]] std::vector<std::pair<int, int>> calculateColorFrequencies() const;
 
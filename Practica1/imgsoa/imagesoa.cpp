@@ -1,13 +1,26 @@
 #include "imagesoa.hpp"
+#include "common/ppmview.hpp"
+#include "common/ppmstream.hpp"
+#include "common/outputtarget.hpp"
+#include "common/parallel.hpp"
+#include "common/pixelkernels.hpp"
+#include "common/planarcache.hpp"
+#include "common/cppmview.hpp"
+#include "common/cppmpalette.hpp"
+#include "common/cppmcompress.hpp"
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <unordered_map>
 #include <vector>
 #include <execution>
-#include <tuple>
 #include <memory>
+#include <iterator>
+#include <numeric>
+#include <utility>
 
 namespace {
     constexpr int MAX_COLOR_8_BIT = 255;
@@ -16,200 +29,502 @@ namespace {
     constexpr int MASCARA_BYTE = 0xFF;
     constexpr int CANTIDAD_CANALES_8_BITS = 3;
     constexpr int CANTIDAD_CANALES_16_BITS = 6;
-    constexpr int MAXIMO_COLOR_16_BITS = 65535;
-    constexpr int LIMITE_COLOR_TABLA = 256;
-    constexpr int BYTE_INFERIOR_AZUL = 5;
-}
 
-// Función auxiliar para cargar datos de 8 bits
-void Image::loadPPM_8bit(std::ifstream &file) {
-    std::vector<char> buffer(static_cast<size_t>(width) * static_cast<size_t>(height) * CANTIDAD_CANALES_8_BITS);
-    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    // Los planos SoA son RGB o un único plano gris: los PAM con alfa solo los admite AoS
+    void rechazarAlfa(const PPMHeader &cabecera) {
+        if (cabecera.channels() > static_cast<size_t>(CANTIDAD_CANALES_8_BITS)) {
+            throw std::runtime_error("Formato no soportado");
+        }
+    }
+
+    // Regla de maxlevel: la muestra escalada se trunca y se limita al nuevo máximo
+    uint16_t escalarMuestra(const uint16_t canal, const float factor, const float nuevoMaxLevel) {
+        return static_cast<uint16_t>(std::clamp(static_cast<int>(static_cast<float>(canal) * factor), 0, static_cast<int>(nuevoMaxLevel)));
+    }
+}
 
+// Separa el raster en los tres planos con los núcleos SIMD, repartiendo bloques de filas entre hilos
+void Image::loadPPM_8bit(std::span<const uint8_t> raster) {
     red.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
     green.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
     blue.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
 
-    for (size_t i = 0; i < red.size(); ++i) {
-        red[i] = static_cast<uint8_t>(buffer[i * CANTIDAD_CANALES_8_BITS]);
-        green[i] = static_cast<uint8_t>(buffer[(i * CANTIDAD_CANALES_8_BITS) + 1]);
-        blue[i] = static_cast<uint8_t>(buffer[(i * CANTIDAD_CANALES_8_BITS) + 2]);
-    }
+    auto const ancho = static_cast<size_t>(width);
+    parallelForRanges(static_cast<size_t>(height), rowsPerTask(ancho), [&](const size_t primera, const size_t ultima) {
+        const size_t inicio = primera * ancho;
+        const size_t pixeles = (ultima - primera) * ancho;
+        deinterleaveRGB8(raster.subspan(inicio * CANTIDAD_CANALES_8_BITS, pixeles * CANTIDAD_CANALES_8_BITS),
+                         std::span(red).subspan(inicio, pixeles), std::span(green).subspan(inicio, pixeles),
+                         std::span(blue).subspan(inicio, pixeles));
+    });
 }
 
-// Función auxiliar para cargar datos de 16 bits
-void Image::loadPPM_16bit(std::ifstream &file) {
-    std::vector<char> buffer(static_cast<size_t>(width) * static_cast<size_t>(height) * CANTIDAD_CANALES_16_BITS);
-    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-
+// Igual que la versión de 8 bits; el núcleo invierte además el orden de bytes de cada muestra
+void Image::loadPPM_16bit(std::span<const uint8_t> raster) {
     red.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
     green.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
     blue.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
 
-    for (size_t i = 0; i < red.size(); ++i) {
-        red[i] = static_cast<uint16_t>((static_cast<unsigned char>(buffer[i * CANTIDAD_CANALES_16_BITS]) << DESPLAZAMIENTO_8_BITS) |
-                                        static_cast<unsigned char>(buffer[(i * CANTIDAD_CANALES_16_BITS) + 1]));
-        green[i] = static_cast<uint16_t>((static_cast<unsigned char>(buffer[(i * CANTIDAD_CANALES_16_BITS) + 2]) << DESPLAZAMIENTO_8_BITS) |
-                                          static_cast<unsigned char>(buffer[(i * CANTIDAD_CANALES_16_BITS) + 3]));
-        blue[i] = static_cast<uint16_t>((static_cast<unsigned char>(buffer[(i * CANTIDAD_CANALES_16_BITS) + 4]) << DESPLAZAMIENTO_8_BITS) |
-                                         static_cast<unsigned char>(buffer[(i * CANTIDAD_CANALES_16_BITS) + BYTE_INFERIOR_AZUL]));
-    }
+    auto const ancho = static_cast<size_t>(width);
+    parallelForRanges(static_cast<size_t>(height), rowsPerTask(ancho), [&](const size_t primera, const size_t ultima) {
+        const size_t inicio = primera * ancho;
+        const size_t pixeles = (ultima - primera) * ancho;
+        deinterleaveRGB16BE(raster.subspan(inicio * CANTIDAD_CANALES_16_BITS, pixeles * CANTIDAD_CANALES_16_BITS),
+                            std::span(red).subspan(inicio, pixeles), std::span(green).subspan(inicio, pixeles),
+                            std::span(blue).subspan(inicio, pixeles));
+    });
 }
 
-void Image::loadPPM(const std::string &filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error al abrir el archivo");
-    }
+// Un P5 tiene un solo canal: las muestras se copian al plano gris ampliándolas a 16 bits
+// o invirtiendo su orden de bytes, por bloques en paralelo
+void Image::loadGray(std::span<const uint8_t> raster) {
+    gray.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+
+    const bool ochoBits = maxColorValue <= MAX_COLOR_8_BIT;
+    parallelForRanges(gray.size(), PARALLEL_GRAIN_PIXELS, [&](const size_t primero, const size_t ultimo) {
+        const std::span<uint16_t> muestras = std::span(gray).subspan(primero, ultimo - primero);
+        if (ochoBits) {
+            widenSamples8(raster.subspan(primero, muestras.size()), muestras);
+        } else {
+            loadSamples16BE(raster.subspan(2 * primero, 2 * muestras.size()), muestras);
+        }
+    });
+}
 
-    std::string esperar_P6;
-    file >> esperar_P6;
-    if (esperar_P6 != "P6") {
-        throw std::runtime_error("Formato no adecuado");
+// La caché ya está separada en planos: cada uno se copia por bloques en paralelo (o se
+// amplía a 16 bits si es de 8), sin desintercalar ni invertir bytes
+void Image::loadPlanar(const PlanarView &vista) {
+    const PlanarHeader &cabecera = vista.header();
+    // Como en rechazarAlfa: SoA solo tiene planos RGB o un único plano gris
+    if (cabecera.channels != 1 && cabecera.channels != static_cast<size_t>(CANTIDAD_CANALES_8_BITS)) {
+        throw std::runtime_error("Formato no soportado");
     }
 
-    file >> width >> height >> maxColorValue;
-    file.ignore(1);
+    width = cabecera.width;
+    height = cabecera.height;
+    maxColorValue = cabecera.maxColorValue;
+    grayscale = cabecera.channels == 1;
+
+    const bool ochoBits = maxColorValue <= MAX_COLOR_8_BIT;
+    const std::vector<std::vector<uint16_t> *> destinos = planos();
+    for (size_t canal = 0; canal < destinos.size(); ++canal) {
+        std::vector<uint16_t> &plano = *destinos[canal];
+        plano.resize(cabecera.pixelCount());
+        const std::span<const uint8_t> origen = vista.plane(canal);
+        parallelForRanges(plano.size(), PARALLEL_GRAIN_PIXELS, [&](const size_t primero, const size_t ultimo) {
+            const std::span<uint16_t> muestras = std::span(plano).subspan(primero, ultimo - primero);
+            if (ochoBits) {
+                widenSamples8(origen.subspan(primero, muestras.size()), muestras);
+            } else {
+                std::memcpy(muestras.data(), origen.subspan(2 * primero).data(), muestras.size_bytes());
+            }
+        });
+    }
+}
 
-    if (maxColorValue <= MAX_COLOR_8_BIT) {
-        loadPPM_8bit(file);
-    } else if (maxColorValue <= MAXIMO_COLOR_16_BITS) {
-        loadPPM_16bit(file);
-    } else {
-        throw std::runtime_error("Valor de maxColorValue fuera de rango");
+// Los índices se expanden en paralelo (por bloques de filas o por teselas): cada píxel toma
+// su color de la tabla, separada de antemano en un vector por canal
+void Image::loadCPPM(const std::string &filename, const std::optional<CPPMRegion> &region) {
+    const CPPMView vista(filename);
+    const CPPMRegion rectangulo = region.value_or(vista.fullRegion());
+    width = rectangulo.width;
+    height = rectangulo.height;
+    maxColorValue = vista.header().maxColorValue;
+    grayscale = false;
+    gray.clear();
+
+    std::array<std::vector<uint16_t>, CANTIDAD_CANALES_8_BITS> tabla;
+    for (size_t canal = 0; canal < tabla.size(); ++canal) {
+        tabla[canal].reserve(vista.palette().size());
+        for (const PaletteColor &color : vista.palette()) {
+            tabla[canal].push_back(color[canal]);
+        }
     }
 
-    file.close();
+    const auto ancho = static_cast<size_t>(width);
+    const size_t pixeles = ancho * static_cast<size_t>(height);
+    red.resize(pixeles);
+    green.resize(pixeles);
+    blue.resize(pixeles);
+    vista.expandRegion(rectangulo, [&](const size_t x, const size_t y, const size_t indice) {
+        const size_t pixel = (y * ancho) + x;
+        red[pixel] = tabla[0][indice];
+        green[pixel] = tabla[1][indice];
+        blue[pixel] = tabla[2][indice];
+    });
 }
 
-// Guardar la imagen PPM
-void Image::savePPM(const std::string &filename) const {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error al guardar el archivo");
+std::vector<std::vector<uint16_t> *> Image::planos() {
+    if (grayscale) {
+        return {&gray};
     }
+    return {&red, &green, &blue};
+}
 
-    file << "P6\n" << width << " " << height << "\n" << maxColorValue << "\n";
+std::vector<const std::vector<uint16_t> *> Image::planos() const {
+    if (grayscale) {
+        return {&gray};
+    }
+    return {&red, &green, &blue};
+}
 
-    if (maxColorValue <= MAX_COLOR_8_BIT) {
-        for (size_t i = 0; i < red.size(); ++i) {
-            file.put(static_cast<char>(red[i]));
-            file.put(static_cast<char>(green[i]));
-            file.put(static_cast<char>(blue[i]));
-        }
+// Cargar una imagen PPM o PGM: el archivo se proyecta en memoria (mmap) y los canales se
+// separan directamente desde las páginas proyectadas, sin copia intermedia.
+void Image::loadPPM(const std::string &filename) {
+    MappedFile archivo(filename);
+    if (isPlanarCache(archivo.data())) {
+        loadPlanar(PlanarView(std::move(archivo)));
     } else {
-        for (size_t i = 0; i < red.size(); ++i) {
-            file.put(static_cast<char>(red[i] >> DESPLAZAMIENTO_8_BITS));
-            file.put(static_cast<char>(red[i] & MASCARA_BYTE));
-            file.put(static_cast<char>(green[i] >> DESPLAZAMIENTO_8_BITS));
-            file.put(static_cast<char>(green[i] & MASCARA_BYTE));
-            file.put(static_cast<char>(blue[i] >> DESPLAZAMIENTO_8_BITS));
-            file.put(static_cast<char>(blue[i] & MASCARA_BYTE));
-        }
+        const PPMView view(std::move(archivo));
+        const PPMHeader &cabecera = view.header();
+        rechazarAlfa(cabecera);
+
+        width = cabecera.width;
+        height = cabecera.height;
+        maxColorValue = cabecera.maxColorValue;
+        grayscale = cabecera.channels() == 1;
+
+        loadRaster(view.raster());
     }
+    // El histograma y la tabla de índices en gris tienen maxColorValue + 1 entradas
+    for (const std::vector<uint16_t> *plano : std::as_const(*this).planos()) {
+        checkSampleRange(*plano, maxColorValue);
+    }
+}
 
-    file.close();
+// Guardar la imagen PPM: el encabezado fija el tamaño final, así que el archivo se reserva
+// entero y los bloques de píxeles se intercalan y escriben en paralelo, cada uno en su posición
+// ("-" escribe en la salida estándar por bloques secuenciales)
+void Image::savePPM(const std::string &filename) const {
+    const size_t bytesPorPixel = canales() * (maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2);
+    writeEncodedOutput(filename, formatPPMHeader(width, height, maxColorValue, canales()), pixelCount(), bytesPorPixel,
+                       [this](const size_t first, const size_t last, const std::span<uint8_t> out) {
+                           encodePixels(first, last, out);
+                       });
+}
+
+// Cada plano se vuelca en su ancho nativo; writePlanarCache reparte los bloques entre hilos
+void Image::savePlanar(const std::string &filename) const {
+    const std::vector<const std::vector<uint16_t> *> origen = planos();
+    const bool ochoBits = maxColorValue <= MAX_COLOR_8_BIT;
+    writePlanarCache(filename, PlanarHeader{.width = width, .height = height, .maxColorValue = maxColorValue, .channels = canales()},
+                     [&](const size_t plano, const size_t first, const size_t last, const std::span<uint8_t> out) {
+                         const std::span<const uint16_t> muestras = std::span(*origen[plano]).subspan(first, last - first);
+                         if (ochoBits) {
+                             narrowSamples8(muestras, out);
+                         } else {
+                             std::memcpy(out.data(), muestras.data(), muestras.size_bytes());
+                         }
+                     });
 }
 
 void Image::scaleIntensity(float nuevoMaxLevel) {
     float const factor = nuevoMaxLevel / static_cast<float>(maxColorValue);
 
-    std::for_each(std::execution::par, red.begin(), red.end(), [factor, nuevoMaxLevel](uint16_t &canal) {
-        canal = static_cast<uint16_t>(std::clamp(static_cast<int>(static_cast<float>(canal) * factor), 0, static_cast<int>(nuevoMaxLevel)));
-    });
-    std::for_each(std::execution::par, green.begin(), green.end(), [factor, nuevoMaxLevel](uint16_t &canal) {
-        canal = static_cast<uint16_t>(std::clamp(static_cast<int>(static_cast<float>(canal) * factor), 0, static_cast<int>(nuevoMaxLevel)));
-    });
-    std::for_each(std::execution::par, blue.begin(), blue.end(), [factor, nuevoMaxLevel](uint16_t &canal) {
-        canal = static_cast<uint16_t>(std::clamp(static_cast<int>(static_cast<float>(canal) * factor), 0, static_cast<int>(nuevoMaxLevel)));
-    });
+    for (std::vector<uint16_t> *plano : planos()) {
+        std::for_each(std::execution::par, plano->begin(), plano->end(), [factor, nuevoMaxLevel](uint16_t &canal) {
+            canal = escalarMuestra(canal, factor, nuevoMaxLevel);
+        });
+    }
 
     maxColorValue = static_cast<int>(nuevoMaxLevel);
 }
 
-// Función para obtener un valor rojo
-[[nodiscard]] uint16_t Image::getPixelRed(int posX, int posY) const {
-    return red[(static_cast<size_t>(posY) * static_cast<size_t>(width)) + static_cast<size_t>(posX)];
-}
-
-// Función para obtener un valor verde
-[[nodiscard]] uint16_t Image::getPixelGreen(int posX, int posY) const {
-    return green[(static_cast<size_t>(posY) * static_cast<size_t>(width)) + static_cast<size_t>(posX)];
+void Image::scaleIntensityCPPM(const std::string &inputFile, const std::string &outputFile, const float nuevoMaxLevel) {
+    rewriteCPPMPalette(inputFile, outputFile, static_cast<int>(nuevoMaxLevel),
+                       [nuevoMaxLevel](const std::span<uint16_t> muestras, const int maximoActual) {
+                           const float factor = nuevoMaxLevel / static_cast<float>(maximoActual);
+                           for (uint16_t &canal : muestras) {
+                               canal = escalarMuestra(canal, factor, nuevoMaxLevel);
+                           }
+                       });
 }
 
-// Función para obtener un valor azul
-[[nodiscard]] uint16_t Image::getPixelBlue(int posX, int posY) const {
-    return blue[(static_cast<size_t>(posY) * static_cast<size_t>(width)) + static_cast<size_t>(posX)];
+// Escala la intensidad por franjas: cada franja se carga, escala y codifica con las mismas
+// funciones que el camino en memoria, por lo que la salida es idéntica byte a byte.
+void Image::scaleIntensityStreaming(const std::string &inputFile, const std::string &outputFile,
+                                    const float nuevoMaxLevel, const std::size_t memoryBudget) {
+    PPMStripReader reader(inputFile);
+    const PPMHeader &cabecera = reader.header();
+    rechazarAlfa(cabecera);
+    const int nuevoMax = static_cast<int>(nuevoMaxLevel);
+    // La entrada se lee mientras se escribe: sobre la misma ruta se escribe en un temporal
+    OutputTarget objetivo(inputFile, outputFile);
+    PPMStripWriter writer(objetivo.path(), cabecera.width, cabecera.height, nuevoMax, cabecera.channels());
+
+    const size_t anchoFila = static_cast<size_t>(cabecera.width);
+    const size_t bytesSalida = anchoFila * cabecera.channels() * (nuevoMax <= MAX_COLOR_8_BIT ? 1 : 2);
+    const size_t filasPorFranja =
+            rowsForBudget(memoryBudget, reader.rowBytes() + (anchoFila * cabecera.channels() * sizeof(uint16_t)) + bytesSalida);
+
+    std::vector<uint8_t> entrada(filasPorFranja * reader.rowBytes());
+    std::vector<uint8_t> salida(filasPorFranja * bytesSalida);
+    Image franja{};
+    franja.width = cabecera.width;
+    franja.grayscale = cabecera.channels() == 1;
+
+    for (size_t filas = reader.readRows(entrada); filas > 0; filas = reader.readRows(entrada)) {
+        franja.height = static_cast<int>(filas);
+        franja.maxColorValue = cabecera.maxColorValue;
+        franja.loadRaster(std::span(entrada).first(filas * reader.rowBytes()));
+        franja.scaleIntensity(nuevoMaxLevel);
+        franja.encodePixels(0, franja.pixelCount(), salida);
+        writer.writeRows(std::span(salida).first(filas * bytesSalida));
+    }
+    writer.finish();
+    objetivo.commit();
 }
 
-namespace {
-    template<typename T>
-    inline T linearInterpolate(T value0, T value1, float tValue) {
-        return static_cast<T>(value0 + (tValue * (value1 - value0)));
+// Codifica los píxeles [first, last) como raster P6 (o P5)
+void Image::encodePixels(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    if (grayscale) {
+        encodeGray(first, last, out);
+    } else if (maxColorValue <= MAX_COLOR_8_BIT) {
+        encodePixels_8bit(first, last, out);
+    } else {
+        encodePixels_16bit(first, last, out);
     }
 }
 
-// Función para redimensionar la imagen
-void Image::resize(int nuevo_ancho, int nuevo_alto) {
-    std::vector<uint16_t> nuevoRed(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto));
-    std::vector<uint16_t> nuevoGreen(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto));
-    std::vector<uint16_t> nuevoBlue(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto));
+// Intercala los tres canales con una muestra por byte; el bloque se reparte entre hilos por
+// tramos de filas y cada tramo lo intercala el núcleo SIMD
+void Image::encodePixels_8bit(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    const size_t tramo = rowsPerTask(static_cast<size_t>(width)) * static_cast<size_t>(width);
+    parallelForRanges(last - first, tramo, [&](const size_t primero, const size_t ultimo) {
+        const size_t inicio = first + primero;
+        const size_t pixeles = ultimo - primero;
+        interleaveRGB8(std::span(red).subspan(inicio, pixeles), std::span(green).subspan(inicio, pixeles),
+                       std::span(blue).subspan(inicio, pixeles),
+                       out.subspan(primero * CANTIDAD_CANALES_8_BITS, pixeles * CANTIDAD_CANALES_8_BITS));
+    });
+}
 
-    float const xRatio = static_cast<float>(width) / static_cast<float>(nuevo_ancho);
-    float const yRatio = static_cast<float>(height) / static_cast<float>(nuevo_alto);
+// Intercala los tres canales con dos bytes por muestra, el más significativo primero
+void Image::encodePixels_16bit(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    const size_t tramo = rowsPerTask(static_cast<size_t>(width)) * static_cast<size_t>(width);
+    parallelForRanges(last - first, tramo, [&](const size_t primero, const size_t ultimo) {
+        const size_t inicio = first + primero;
+        const size_t pixeles = ultimo - primero;
+        interleaveRGB16BE(std::span(red).subspan(inicio, pixeles), std::span(green).subspan(inicio, pixeles),
+                          std::span(blue).subspan(inicio, pixeles),
+                          out.subspan(primero * CANTIDAD_CANALES_16_BITS, pixeles * CANTIDAD_CANALES_16_BITS));
+    });
+}
 
-    for (int posY = 0; posY < nuevo_alto; ++posY) {
-        for (int posX = 0; posX < nuevo_ancho; ++posX) {
-            size_t const nuevo_indice = (static_cast<size_t>(posY) * static_cast<size_t>(nuevo_ancho)) + static_cast<size_t>(posX);
+// Un solo canal: no hay nada que intercalar, solo reducir a bytes o pasar a big-endian
+void Image::encodeGray(const std::size_t first, const std::size_t last, std::span<uint8_t> out) const {
+    const bool ochoBits = maxColorValue <= MAX_COLOR_8_BIT;
+    parallelForRanges(last - first, PARALLEL_GRAIN_PIXELS, [&](const size_t primero, const size_t ultimo) {
+        const std::span<const uint16_t> muestras = std::span(gray).subspan(first + primero, ultimo - primero);
+        if (ochoBits) {
+            narrowSamples8(muestras, out.subspan(primero, muestras.size()));
+        } else {
+            storeSamples16BE(muestras, out.subspan(2 * primero, 2 * muestras.size()));
+        }
+    });
+}
 
-            InterpolationParams const params{.posX=posX, .posY=posY, .xRatio=xRatio, .yRatio=yRatio};
+namespace {
+    // Muestra de origen de una coordenada de destino en punto fijo, ajustada para que el
+    // vecino siguiente quede dentro de la imagen; con un origen de tamaño 1 se repite la muestra
+    ResizeColumn muestrear(const int posicion, const float ratio, const int limite, const unsigned bits) {
+        float const original = static_cast<float>(posicion) * ratio;
+        int base = static_cast<int>(original);
+        float delta = original - static_cast<float>(base);
+        if (limite >= 2 && base >= limite - 1) {
+            base = limite - 2;
+            delta = 1.0F;
+        }
+        return fixedResizeColumn(static_cast<size_t>(base), static_cast<size_t>(std::min(base + 1, limite - 1)), delta,
+                                 bits);
+    }
 
-            nuevoRed[nuevo_indice] = getInterpolatedChannel(params, &Image::getPixelRed);
-            nuevoGreen[nuevo_indice] = getInterpolatedChannel(params, &Image::getPixelGreen);
-            nuevoBlue[nuevo_indice] = getInterpolatedChannel(params, &Image::getPixelBlue);
+    // Muestras de cada columna (o fila) de destino; se calculan una sola vez por redimensionado
+    std::vector<ResizeColumn> muestrearColumnas(const int nuevoAncho, const float xRatio, const int ancho,
+                                                const unsigned bits) {
+        std::vector<ResizeColumn> columnas(static_cast<size_t>(nuevoAncho));
+        for (int posX = 0; posX < nuevoAncho; ++posX) {
+            columnas[static_cast<size_t>(posX)] = muestrear(posX, xRatio, ancho, bits);
         }
+        return columnas;
     }
+}
 
-    width = nuevo_ancho;
-    height = nuevo_alto;
-    red = std::move(nuevoRed);
-    green = std::move(nuevoGreen);
-    blue = std::move(nuevoBlue);
+void Image::resize(int nuevo_ancho, int nuevo_alto, const ResizeFilter filter) {
+    *this = redimensionada(nuevo_ancho, nuevo_alto, filter);
 }
 
+Image Image::redimensionada(const int nuevo_ancho, const int nuevo_alto, const ResizeFilter filter) const {
+    if (filter == ResizeFilter::area && width % nuevo_ancho == 0 && height % nuevo_alto == 0) {
+        return bloquesReducidos(width / nuevo_ancho, height / nuevo_alto);
+    }
+    const std::vector<const std::vector<uint16_t> *> origen = planos();
+    std::vector<std::vector<uint16_t>> nuevos(origen.size(), std::vector<uint16_t>(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto)));
 
-uint16_t Image::getInterpolatedChannel(const InterpolationParams& params, uint16_t (Image::*getPixel)(int, int) const) const {
-    float const originalX = static_cast<float>(params.posX) * params.xRatio;
-    float const originalY = static_cast<float>(params.posY) * params.yRatio;
+    if (filter != ResizeFilter::bilinear) {
+        remuestrearPlanos(origen, nuevos, nuevo_ancho, nuevo_alto, filter);
+    } else {
+        interpolarPlanos(origen, nuevos, nuevo_ancho, nuevo_alto);
+    }
+    return conPlanos(nuevos, nuevo_ancho, nuevo_alto);
+}
 
-    int baseX = static_cast<int>(originalX);
-    int baseY = static_cast<int>(originalY);
+void Image::reducirBloques(const int factorX, const int factorY) {
+    *this = bloquesReducidos(factorX, factorY);
+}
 
-    float deltaX = originalX - static_cast<float>(baseX);
-    float deltaY = originalY - static_cast<float>(baseY);
+// Cada fila de destino de cada plano reúne las factorY filas de origen de su bloque (la
+// última se repite en el borde inferior); con factor 2 el núcleo suma las columnas por
+// parejas con AVX2
+Image Image::bloquesReducidos(const int factorX, const int factorY) const {
+    const int nuevo_ancho = (width + factorX - 1) / factorX;
+    const int nuevo_alto = (height + factorY - 1) / factorY;
+    const std::vector<const std::vector<uint16_t> *> origen = planos();
+    std::vector<std::vector<uint16_t>> nuevos(origen.size(), std::vector<uint16_t>(static_cast<size_t>(nuevo_ancho) * static_cast<size_t>(nuevo_alto)));
+
+    auto const ancho = static_cast<size_t>(width);
+    auto const nuevoAncho = static_cast<size_t>(nuevo_ancho);
+    auto const filasBloque = static_cast<size_t>(factorY);
+    parallelForRanges(static_cast<size_t>(nuevo_alto), rowsPerTask(nuevoAncho), [&](const size_t primera, const size_t ultima) {
+        std::vector<std::span<const uint16_t>> filas(filasBloque);
+        for (size_t posY = primera; posY < ultima; ++posY) {
+            for (size_t canal = 0; canal < origen.size(); ++canal) {
+                const std::span<const uint16_t> plano = *origen[canal];
+                for (size_t fila = 0; fila < filasBloque; ++fila) {
+                    const size_t origenY = std::min((posY * filasBloque) + fila, static_cast<size_t>(height) - 1);
+                    filas[fila] = plano.subspan(origenY * ancho, ancho);
+                }
+                boxReduceRow(filas, static_cast<size_t>(factorX), 1,
+                             std::span(nuevos[canal]).subspan(posY * nuevoAncho, nuevoAncho));
+            }
+        }
+    });
+    return conPlanos(nuevos, nuevo_ancho, nuevo_alto);
+}
 
-    // Asegurarse de que los índices estén dentro de los límites de la imagen
-    if (baseX >= width - 1) {
-        baseX = width - 2;
-        deltaX = 1.0F;
+Image Image::conPlanos(std::vector<std::vector<uint16_t>> &nuevos, const int nuevo_ancho, const int nuevo_alto) const {
+    Image destino;
+    destino.width = nuevo_ancho;
+    destino.height = nuevo_alto;
+    destino.maxColorValue = maxColorValue;
+    destino.grayscale = grayscale;
+    const std::vector<std::vector<uint16_t> *> planosDestino = destino.planos();
+    for (size_t canal = 0; canal < planosDestino.size(); ++canal) {
+        *planosDestino[canal] = std::move(nuevos[canal]);
     }
-    if (baseY >= height - 1) {
-        baseY = height - 2;
-        deltaY = 1.0F;
+    return destino;
+}
+
+// Con un filtro separable las tablas de pesos se calculan una vez y cada plano se
+// remuestrea como una imagen de un canal
+void Image::remuestrearPlanos(const std::vector<const std::vector<uint16_t> *> &origen,
+                              std::vector<std::vector<uint16_t>> &nuevos, const int nuevo_ancho, const int nuevo_alto,
+                              const ResizeFilter filter) const {
+    const Resampler remuestreo(width, height, nuevo_ancho, nuevo_alto, filter);
+    for (size_t canal = 0; canal < origen.size(); ++canal) {
+        remuestreo.resample(*origen[canal], 1, maxColorValue, nuevos[canal]);
     }
+}
 
-    uint16_t const arribaIzquierda = (this->*getPixel)(baseX, baseY);
-    uint16_t const arribaDerecha = (this->*getPixel)(baseX + 1, baseY);
-    uint16_t const abajoIzquierda = (this->*getPixel)(baseX, baseY + 1);
-    uint16_t const abajoDerecha = (this->*getPixel)(baseX + 1, baseY + 1);
+// Las muestras de origen de columnas y filas se calculan una vez en dos tablas de punto
+// fijo; después se reparten bloques de filas de destino entre hilos y cada fila de cada
+// plano se interpola con el núcleo entero, que con AVX2 avanza de 8 en 8 columnas
+void Image::interpolarPlanos(const std::vector<const std::vector<uint16_t> *> &origen,
+                             std::vector<std::vector<uint16_t>> &nuevos, const int nuevo_ancho,
+                             const int nuevo_alto) const {
+    float const xRatio = static_cast<float>(width) / static_cast<float>(nuevo_ancho);
+    float const yRatio = static_cast<float>(height) / static_cast<float>(nuevo_alto);
+    const unsigned bits = resizeWeightBits(maxColorValue);
+    const std::vector<ResizeColumn> columnas = muestrearColumnas(nuevo_ancho, xRatio, width, bits);
+    const std::vector<ResizeColumn> filas = muestrearColumnas(nuevo_alto, yRatio, height, bits);
+
+    auto const ancho = static_cast<size_t>(width);
+    auto const nuevoAncho = static_cast<size_t>(nuevo_ancho);
+    parallelForRanges(filas.size(), rowsPerTask(nuevoAncho), [&](const size_t primera, const size_t ultima) {
+        for (size_t posY = primera; posY < ultima; ++posY) {
+            const ResizeColumn &fila = filas[posY];
+            const size_t arriba = fila.left * ancho;
+            const size_t abajo = nextSample(fila, static_cast<size_t>(height)) * ancho;
+            for (size_t canal = 0; canal < origen.size(); ++canal) {
+                const std::span<const uint16_t> plano = *origen[canal];
+                interpolateRow(plano.subspan(arriba, ancho), plano.subspan(abajo, ancho), columnas, fila.weight, bits, 1,
+                               std::span(nuevos[canal]).subspan(posY * nuevoAncho, nuevoAncho));
+            }
+        }
+    });
+}
 
-    return linearInterpolate(
-        linearInterpolate(arribaIzquierda, arribaDerecha, deltaX),
-        linearInterpolate(abajoIzquierda, abajoDerecha, deltaX),
-        deltaY
-    );
+// Carga un raster P6 (o P5) de `height` filas en los planos, según la profundidad de maxColorValue
+void Image::loadRaster(std::span<const uint8_t> raster) {
+    if (grayscale) {
+        loadGray(raster);
+    } else if (maxColorValue <= MAX_COLOR_8_BIT) {
+        loadPPM_8bit(raster);
+    } else {
+        loadPPM_16bit(raster);
+    }
 }
 
+// Redimensiona leyendo el origen fila a fila: cada fila de destino solo necesita las dos
+// filas de origen que la rodean, que se guardan en una ventana circular de dos filas.
+// El resultado es idéntico al de resize().
+void Image::resizeStreaming(const std::string &inputFile, const std::string &outputFile, const int nuevo_ancho,
+                            const int nuevo_alto, const std::size_t memoryBudget) {
+    PPMStripReader reader(inputFile);
+    const PPMHeader &cabecera = reader.header();
+    rechazarAlfa(cabecera);
+    // La entrada se lee mientras se escribe: sobre la misma ruta se escribe en un temporal
+    OutputTarget objetivo(inputFile, outputFile);
+    PPMStripWriter writer(objetivo.path(), nuevo_ancho, nuevo_alto, cabecera.maxColorValue, cabecera.channels());
+    PPMRowReader filasOrigen(reader, memoryBudget);
+
+    float const xRatio = static_cast<float>(cabecera.width) / static_cast<float>(nuevo_ancho);
+    float const yRatio = static_cast<float>(cabecera.height) / static_cast<float>(nuevo_alto);
+    const unsigned bits = resizeWeightBits(cabecera.maxColorValue);
+    const std::vector<ResizeColumn> columnas = muestrearColumnas(nuevo_ancho, xRatio, cabecera.width, bits);
+    const std::vector<ResizeColumn> filas = muestrearColumnas(nuevo_alto, yRatio, cabecera.height, bits);
+
+    // La fila de origen r se guarda en ventana[r % 2]
+    std::array<Image, 2> ventana{};
+    for (Image &fila : ventana) {
+        fila.width = cabecera.width;
+        fila.height = 1;
+        fila.maxColorValue = cabecera.maxColorValue;
+        fila.grayscale = cabecera.channels() == 1;
+    }
+    int filasCargadas = 0;
+
+    Image destino{};
+    destino.width = nuevo_ancho;
+    destino.height = 1;
+    destino.maxColorValue = cabecera.maxColorValue;
+    destino.grayscale = cabecera.channels() == 1;
+    for (std::vector<uint16_t> *plano : destino.planos()) {
+        plano->resize(static_cast<size_t>(nuevo_ancho));
+    }
+    std::vector<uint8_t> salida(static_cast<size_t>(nuevo_ancho) * cabecera.channels() *
+                                (cabecera.maxColorValue <= MAX_COLOR_8_BIT ? 1 : 2));
+
+    for (const ResizeColumn &fila : filas) {
+        // Con una sola fila de origen left + 1 no existe; se repite la última
+        const size_t filaInferior = nextSample(fila, static_cast<size_t>(cabecera.height));
+        while (filasCargadas <= static_cast<int>(filaInferior)) {
+            ventana.at(static_cast<size_t>(filasCargadas % 2)).loadRaster(filasOrigen.nextRow());
+            ++filasCargadas;
+        }
+
+        const auto arriba = std::as_const(ventana.at(fila.left % 2)).planos();
+        const auto abajo = std::as_const(ventana.at(filaInferior % 2)).planos();
+        const auto planosDestino = destino.planos();
+        for (size_t canal = 0; canal < planosDestino.size(); ++canal) {
+            interpolateRow(*arriba[canal], *abajo[canal], columnas, fila.weight, bits, 1, *planosDestino[canal]);
+        }
+        destino.encodePixels(0, destino.pixelCount(), salida);
+        writer.writeRows(salida);
+    }
+    writer.finish();
+    objetivo.commit();
+}
 
 std::vector<std::pair<int, int>> Image::frecuenciaColores() const {
     std::unordered_map<int, int> histograma;
@@ -323,6 +638,10 @@ void Image::borrarKDTree(std::unique_ptr<KDTreeNode>& raiz) {
 
 //Borrar colores raros
 void Image::borrarMenosFrecuentes(int threshold) {
+    if (grayscale) {
+        borrarMenosFrecuentesGris(threshold);
+        return;
+    }
     const auto coloresOrdenados = frecuenciaColores();
 
     std::unordered_map<int, int> coloresPocoFrecuentes;
@@ -367,6 +686,51 @@ std::unordered_map<int, int> Image::remplazoColores(std::unordered_map<int, int>
     return coloresPocoFrecuentes;
 }
 
+// Con un solo canal cada color es un nivel: el histograma es un vector indexado por nivel
+// y el nivel más cercano se busca por bisección entre los que se conservan
+void Image::borrarMenosFrecuentesGris(int threshold) {
+    std::vector<int> histograma(static_cast<size_t>(maxColorValue) + 1, 0);
+    for (const uint16_t nivel : gray) {
+        histograma[nivel]++;
+    }
+
+    std::vector<uint16_t> niveles;
+    for (size_t nivel = 0; nivel < histograma.size(); ++nivel) {
+        if (histograma[nivel] > 0) {
+            niveles.push_back(static_cast<uint16_t>(nivel));
+        }
+    }
+    std::ranges::stable_sort(niveles, [&histograma](const uint16_t nivel1, const uint16_t nivel2) {
+        return histograma[nivel1] < histograma[nivel2];
+    });
+
+    const auto raros = std::min(niveles.size(), static_cast<size_t>(std::max(threshold, 0)));
+    std::vector<uint16_t> restantes(niveles.begin() + static_cast<std::ptrdiff_t>(raros), niveles.end());
+    if (restantes.empty()) {
+        return;
+    }
+    std::ranges::sort(restantes);
+
+    // Tabla de sustitución: cada nivel raro pasa al conservado más cercano (el menor si empatan)
+    std::vector<uint16_t> sustituto(histograma.size());
+    std::iota(sustituto.begin(), sustituto.end(), uint16_t{0});
+    for (size_t i = 0; i < raros; ++i) {
+        const uint16_t nivel = niveles[i];
+        const auto siguiente = std::ranges::lower_bound(restantes, nivel);
+        if (siguiente == restantes.end()) {
+            sustituto[nivel] = restantes.back();
+        } else if (siguiente == restantes.begin() || *siguiente - nivel < nivel - *std::prev(siguiente)) {
+            sustituto[nivel] = *siguiente;
+        } else {
+            sustituto[nivel] = *std::prev(siguiente);
+        }
+    }
+
+    std::for_each(std::execution::par, gray.begin(), gray.end(), [&sustituto](uint16_t &nivel) {
+        nivel = sustituto[nivel];
+    });
+}
+
 // Calcular distancia euclidea sin raíz cuadrada
 inline int Image::calcularEuclidea(const Color& color1, const Color& color2) {
     return ((color1.red - color2.red) * (color1.red - color2.red)) +
@@ -387,63 +751,13 @@ void Image::actualizarPixeles(const std::unordered_map<int, int> &coloresPocoFre
     }
 }
 
-// Función auxiliar para escribir el encabezado CPPM
-void Image::cabeceraPPM(std::ofstream &file) const {
-    file << "C6 " << width << " " << height << " " << maxColorValue << " ";
-}
-
-// Crear la tabla de colores y el mapa de índices
-void Image::calcularColorTabla(std::unordered_map<int, int> &colorTable, std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &uniqueColors) const {
-    int indice = 0;
-    for (size_t i = 0; i < red.size(); ++i) {
-        int const valorColor = (red[i] << 16) | (green[i] << 8) | blue[i];
-        if (!colorTable.contains(valorColor)) {
-            colorTable[valorColor] = indice++;
-            uniqueColors.emplace_back(red[i], green[i], blue[i]);
-        }
-    }
-}
-
-// Escribir la tabla de colores en el archivo de salida
-void Image::escribirColorTabla(std::ofstream &file, const std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &coloresUnicos) {
-    file << coloresUnicos.size() << "\n";
-    for (const auto &[r, g, b] : coloresUnicos) {
-        file.put(static_cast<char>(r));
-        file.put(static_cast<char>(g));
-        file.put(static_cast<char>(b));
-    }
-}
-
-// Escribir los índices de los píxeles en el archivo de salida
-void Image::writePixelIndices(std::ofstream &file, const std::unordered_map<int, int> &colorTabla, const std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &uniqueColors) const {
-    for (size_t i = 0; i < red.size(); ++i) {
-        int const valorColor = (red[i] << 16) | (green[i] << 8) | blue[i];
-        int const indiceColor = colorTabla.at(valorColor);
-
-        if (uniqueColors.size() <= LIMITE_COLOR_TABLA) {
-            file.put(static_cast<char>(indiceColor));
-        } else {
-            file.put(static_cast<char>(indiceColor & MASCARA_BYTE));
-            file.put(static_cast<char>((indiceColor >> DESPLAZAMIENTO_8_BITS) & MASCARA_BYTE));
-        }
-    }
-}
-
-// Compresión CPPM
+// Compresión CPPM: los planos se intercalan en un raster P6 (P5 en escala de grises) y se
+// comprimen con compressImage, así que la tabla (con las muestras completas de 16 bits) y
+// los índices coinciden con los de compressMapped. El raster intercalado es una copia
+// completa que se suma a la memoria de los planos
 void Image::compress(const std::string &filename) const {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        throw std::runtime_error("Error al guardar el archivo");
-    }
-
-    cabeceraPPM(file);
-
-    std::unordered_map<int, int> colorTable;
-    std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> uniqueColors;
-    calcularColorTabla(colorTable, uniqueColors);
-
-    escribirColorTabla(file, uniqueColors);
-    writePixelIndices(file, colorTable, uniqueColors);
-
-    file.close();
+    const ItemEncoder codificador = [this](const size_t first, const size_t last, const std::span<uint8_t> out) {
+        encodePixels(first, last, out);
+    };
+    compressImage(rasterPPMHeader(width, height, maxColorValue, canales()), codificador, filename);
 }
@@ -3,10 +3,20 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <unordered_map>
 #include <tuple>
 #include <memory>
+#include <span>
+#include <optional>
+#include <ostream>
+
+#include "common/positionalwriter.hpp"
+#include "common/cppmview.hpp"
+#include "common/resample.hpp"
+
+class PlanarView;
 
 struct Pixel {
     uint16_t r, g, b;
@@ -27,13 +37,6 @@ struct KDTreeNode {
 
 
 
-struct InterpolationParams {
-    int posX;
-    int posY;
-    float xRatio;
-    float yRatio;
-};
-
 struct Color {
     uint16_t red;
     uint16_t green;
@@ -46,32 +49,94 @@ public:
     std::vector<uint16_t> red;   // Almacena el canal rojo
     std::vector<uint16_t> green; // Almacena el canal verde
     std::vector<uint16_t> blue;  // Almacena el canal azul
+    std::vector<uint16_t> gray;  // Único canal de una imagen en escala de grises
+    bool grayscale = false;      // Si es true solo se usa `gray` y se guarda como P5
+
+    // Número de píxeles, sea cual sea la representación
+    [[nodiscard]] std::size_t pixelCount() const { return grayscale ? gray.size() : red.size(); }
 
+    // Admite PPM, PGM y la caché planar (se detecta por su firma)
     void loadPPM(const std::string &filename);
     void savePPM(const std::string &filename) const;
-    void scaleIntensity(float factor);
-    void resize(int nuevo_ancho, int nuevo_alto);
-    void borrarMenosFrecuentes(int threshold);
 
-    static void escribirColorTabla(std::ofstream &file,
-                         const std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &coloresUnicos);
+    // Guarda los planos tal cual en la caché planar (ver common/planarcache.hpp)
+    void savePlanar(const std::string &filename) const;
 
-    void writePixelIndices(std::ofstream &file, const std::unordered_map<int, int> &colorTabla,
-                           const std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &uniqueColors) const;
+    // Carga un CPPM (C6) expandiendo sus índices a los tres planos; con `region` solo se
+    // carga ese rectángulo (en mosaico, decodificando únicamente las teselas que lo cortan)
+    void loadCPPM(const std::string &filename, const std::optional<CPPMRegion> &region = std::nullopt);
+    void scaleIntensity(float factor);
 
+    // Escala la intensidad de un CPPM reescribiendo solo su tabla de colores, con la misma
+    // regla que scaleIntensity
+    static void scaleIntensityCPPM(const std::string &inputFile, const std::string &outputFile, float nuevoMaxLevel);
+
+    // Escala la intensidad por franjas de filas sin cargar la imagen completa; memoryBudget
+    // limita los bytes de trabajo (franja leída, planos y franja codificada). La salida puede
+    // ser la propia entrada: se escribe en un temporal que se renombra (ver OutputTarget)
+    static void scaleIntensityStreaming(const std::string &inputFile, const std::string &outputFile,
+                                        float nuevoMaxLevel, std::size_t memoryBudget);
+
+    // Codifica los píxeles [first, last) como raster P6 (P5 en escala de grises) de 8 o 16
+    // bits según maxColorValue
+    void encodePixels(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    // Interpolación bilineal o uno de los filtros separables de Resampler, plano a plano; el
+    // filtro de área con factores enteros es la media de cada bloque (reducirBloques)
+    void resize(int nuevo_ancho, int nuevo_alto, ResizeFilter filter = ResizeFilter::bilinear);
+
+    // Como resize, pero devuelve la imagen redimensionada y deja esta intacta
+    [[nodiscard]] Image redimensionada(int nuevo_ancho, int nuevo_alto, ResizeFilter filter = ResizeFilter::bilinear) const;
+
+    // Reduce cada bloque de factorX x factorY píxeles a su media redondeada. El tamaño nuevo
+    // se redondea hacia arriba: los bloques incompletos de los bordes derecho e inferior
+    // repiten la última columna o fila, así que con factor 2 son la media de lo que hay
+    void reducirBloques(int factorX, int factorY);
+
+    // Redimensiona por filas sin cargar la imagen completa: solo mantiene dos filas de
+    // origen; memoryBudget limita las franjas en las que se lee la entrada. Como en
+    // scaleIntensityStreaming, la salida puede ser la propia entrada
+    static void resizeStreaming(const std::string &inputFile, const std::string &outputFile, int nuevo_ancho,
+                                int nuevo_alto, std::size_t memoryBudget);
+    void borrarMenosFrecuentes(int threshold);
+
+    // Intercala los planos en un raster completo antes de comprimirlo: una copia que se suma
+    // a la memoria de los planos, a diferencia de compressMapped, que usa el archivo proyectado
     void compress(const std::string &filename) const;
 
 private:
     static constexpr int BUCKET_SIZE = 8;
 
-    void loadPPM_8bit(std::ifstream &file);
-    void loadPPM_16bit(std::ifstream &file);
+    // Canales por píxel (1 en escala de grises) y planos que los almacenan
+    [[nodiscard]] std::size_t canales() const { return grayscale ? 1 : 3; }
+    std::vector<std::vector<uint16_t> *> planos();
+    [[nodiscard]] std::vector<const std::vector<uint16_t> *> planos() const;
+
+    void loadRaster(std::span<const uint8_t> raster);
+    void loadPPM_8bit(std::span<const uint8_t> raster);
+    void loadPPM_16bit(std::span<const uint8_t> raster);
+    void loadGray(std::span<const uint8_t> raster);
+    void loadPlanar(const PlanarView &vista);
+
+    void encodePixels_8bit(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    void encodePixels_16bit(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+    void encodeGray(std::size_t first, std::size_t last, std::span<uint8_t> out) const;
+
+    // Calculan los planos redimensionados en `nuevos` a partir de los planos actuales
+    void interpolarPlanos(const std::vector<const std::vector<uint16_t> *> &origen, std::vector<std::vector<uint16_t>> &nuevos,
+                          int nuevo_ancho, int nuevo_alto) const;
+    void remuestrearPlanos(const std::vector<const std::vector<uint16_t> *> &origen, std::vector<std::vector<uint16_t>> &nuevos,
+                           int nuevo_ancho, int nuevo_alto, ResizeFilter filter) const;
 
-    [[nodiscard]] uint16_t getPixelRed(int posX, int posY) const;
-    [[nodiscard]] uint16_t getPixelGreen(int posX, int posY) const;
-    [[nodiscard]] uint16_t getPixelBlue(int posX, int posY) const;
+    // Resultado de reducirBloques
+    [[nodiscard]] Image bloquesReducidos(int factorX, int factorY) const;
+
+    // Imagen con la misma profundidad y canales que esta y los planos `nuevos`, de
+    // nuevo_ancho x nuevo_alto píxeles
+    [[nodiscard]] Image conPlanos(std::vector<std::vector<uint16_t>> &nuevos, int nuevo_ancho, int nuevo_alto) const;
+
+    // Versión de un solo canal: los niveles de gris se indexan directamente, sin tablas hash
+    void borrarMenosFrecuentesGris(int threshold);
 
-    [[nodiscard]] uint16_t getInterpolatedChannel(const InterpolationParams &params, uint16_t (Image::*getPixel)(int, int) const) const;
     [[nodiscard]] std::vector<std::pair<int, int>> frecuenciaColores() const;
 
     static std::unique_ptr<KDTreeNode> construccionKDTree(std::vector<std::unique_ptr<KDTreeNode>> &nodes, int depth = 0);
@@ -87,11 +152,6 @@ private:
     static int calcularEuclidea(const Color &color1, const Color &color2);
 
     void actualizarPixeles(const std::unordered_map<int, int> &coloresPocoFrecuentes);
-
-    void cabeceraPPM(std::ofstream &file) const;
-
-    void calcularColorTabla(std::unordered_map<int, int> &colorTable,
-                          std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> &uniqueColors) const;
 };
 
 #endif // PRACTICA1_IMAGESOA_HPP
@@ -1,22 +1,56 @@
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <string>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include "imgaos/imageaos.hpp"
 #include "common/progargs.hpp"
+#include "common/ppmview.hpp"
+#include "common/ppmstream.hpp"
+#include "common/sharedmemory.hpp"
+#include "common/planarcache.hpp"
+#include "common/cppmcompress.hpp"
+#include "common/cppmview.hpp"
+#include "common/resample.hpp"
+#include "common/parallel.hpp"
 
 namespace {
     constexpr int MAX_COLOR_VALUE = 65535;
+    constexpr std::size_t BYTES_PER_MIB = 1024 * 1024;
 
     void printUsage() {
-        std::cerr << "Usage: imtool input.ppm output.ppm [info | maxlevel <level> | resize <width> <height> | cutfreq <n> | compress]\n";
+        // input.ppm u output.ppm pueden ser "-" para leer de la entrada estándar o escribir en la salida estándar
+        // o "shm:<nombre>" para un segmento de memoria compartida POSIX (se elimina al leerlo como entrada).
+        // Todas las operaciones aceptan también una caché planar como entrada; info y maxlevel
+        // aceptan además un CPPM, que maxlevel escala sin expandir. resize solo trabaja por
+        // franjas (--stream, o siempre con una tubería) con el filtro bilineal; los demás
+        // filtros cargan la imagen entera
+        std::cerr << "Usage: imtool input.ppm output.ppm [info | maxlevel <level> [--stream=<MiB>] | resize <width> <height> [<width> <height> <output>]... [--filter=bilinear|area|bicubic|lanczos] [--stream=<MiB> (bilinear only)] | pyramid [--levels=<n>] | cutfreq <n> | compress [--packed] [--tiles=<n>] [--lz] | decompress [--region=x,y,w,h] | toplanar | fromplanar]\n";
     }
 
-    void handleInfo(Image& image, const std::string& inputFile) {
-        image.loadPPM(inputFile);
-        std::cout << "Width: " << image.getWidth()
-                  << ", Height: " << image.getHeight()
-                  << ", Max Color Value: " << image.getMaxColorValue() << '\n';
+    // Solo necesita el encabezado: el archivo se proyecta en memoria sin copiar el raster
+    void handleInfo(const std::string& inputFile) {
+        MappedFile file(inputFile);
+        if (isPlanarCache(file.data())) {
+            const PlanarHeader header = parsePlanarHeader(file.data());
+            std::cout << "Width: " << header.width << ", Height: " << header.height
+                      << ", Max Color Value: " << header.maxColorValue << '\n';
+            return;
+        }
+        if (isCPPM(file.data())) {
+            // Solo el encabezado de texto: ni la tabla ni los índices se leen
+            const PPMHeader header = parsePPMHeader(file.data());
+            std::cout << "Width: " << header.width << ", Height: " << header.height
+                      << ", Max Color Value: " << header.maxColorValue << '\n';
+            return;
+        }
+        const PPMView view(std::move(file));
+        std::cout << "Width: " << view.header().width
+                  << ", Height: " << view.header().height
+                  << ", Max Color Value: " << view.header().maxColorValue << '\n';
     }
 
     struct MaxLevelArgs {
@@ -24,14 +58,37 @@ namespace {
         std::string inputFile;
         std::string outputFile;
         std::string level;
+        std::size_t streamBudget; // 0: imagen completa en memoria; otro valor: bytes por franja
     };
 
+    // Con una tubería ("-") las operaciones que trabajan por filas (maxlevel y resize bilineal)
+    // se hacen siempre por franjas; con memoria compartida ("shm:") o una caché planar los
+    // datos ya están listos para proyectarse y se trabaja en memoria
+    std::size_t effectiveStreamBudget(const std::string& inputFile, const std::string& outputFile, const std::size_t streamBudget) {
+        if (isSharedMemory(inputFile) || isSharedMemory(outputFile) || isPlanarCacheFile(inputFile)) {
+            return 0;
+        }
+        if (streamBudget == 0 && (isStandardStream(inputFile) || isStandardStream(outputFile))) {
+            return DEFAULT_STRIP_BUDGET_MIB * BYTES_PER_MIB;
+        }
+        return streamBudget;
+    }
+
     void handleMaxLevel(const MaxLevelArgs& args) {
         const int newMaxLevel = std::stoi(args.level);
         if (newMaxLevel < 0 || newMaxLevel > MAX_COLOR_VALUE) {
             std::cerr << "Error: Invalid maxlevel: " << newMaxLevel << '\n';
             return;
         }
+        // Un CPPM se escala reescribiendo solo su tabla de colores
+        if (isCPPMFile(args.inputFile)) {
+            Image::scaleIntensityCPPM(args.inputFile, args.outputFile, static_cast<float>(newMaxLevel));
+            return;
+        }
+        if (const std::size_t budget = effectiveStreamBudget(args.inputFile, args.outputFile, args.streamBudget); budget > 0) {
+            Image::scaleIntensityStreaming(args.inputFile, args.outputFile, static_cast<float>(newMaxLevel), budget);
+            return;
+        }
         args.image->loadPPM(args.inputFile);
         args.image->scaleIntensity(static_cast<float>(newMaxLevel));
         args.image->savePPM(args.outputFile);
@@ -40,21 +97,70 @@ namespace {
     struct ResizeArgs {
         Image* image;
         std::string inputFile;
-        std::string outputFile;
-        std::string width;
-        std::string height;
+        std::vector<ResizeTarget> targets; // El primero se guarda en la salida principal
+        std::size_t streamBudget;
+        ResizeFilter filter;
     };
 
+    // Varios tamaños de una sola carga: el origen se decodifica una vez, los tamaños de cada
+    // etapa de la cascada se calculan a la vez (desde el original o desde un tamaño mayor ya
+    // calculado, ver planResizeCascade) y al final todas las salidas se escriben en paralelo
+    void handleResizeTargets(const ResizeArgs& args) {
+        if (args.streamBudget > 0) {
+            throw std::invalid_argument("La opción --stream solo admite un tamaño de salida");
+        }
+        args.image->loadPPM(args.inputFile);
+        const ResizeCascade cascada = planResizeCascade(args.image->getWidth(), args.image->getHeight(), args.targets, args.filter);
+
+        std::vector<Image> salidas(args.targets.size());
+        for (const std::vector<std::size_t>& etapa : cascada.stages) {
+            parallelForEach(etapa.size(), [&](const std::size_t tarea) {
+                const std::size_t indice = etapa[tarea];
+                const ResizeTarget& target = args.targets[indice];
+                const std::optional<std::size_t> mayor = cascada.sources[indice];
+                const Image& origen = mayor ? salidas[*mayor] : *args.image;
+                // Un tamaño repetido se copia: redimensionar al mismo tamaño no es la identidad
+                const bool repetido = mayor && origen.getWidth() == target.width && origen.getHeight() == target.height;
+                salidas[indice] = repetido ? origen : origen.resized(target.width, target.height, args.filter);
+            });
+        }
+        parallelForEach(salidas.size(), [&](const std::size_t indice) {
+            salidas[indice].savePPM(args.targets[indice].outputFile);
+        });
+    }
+
     void handleResize(const ResizeArgs& args) {
-        const int newWidth = std::stoi(args.width);
-        const int newHeight = std::stoi(args.height);
-        if (newWidth <= 0 || newHeight <= 0) {
+        if (std::ranges::any_of(args.targets, [](const ResizeTarget& target) { return target.width <= 0 || target.height <= 0; })) {
             std::cerr << "Error: Invalid dimensions for resize\n";
             return;
         }
+        if (args.targets.size() > 1) {
+            handleResizeTargets(args);
+            return;
+        }
+        const auto& [newWidth, newHeight, outputFile] = args.targets.front();
+        // Por franjas solo se mantienen dos filas de origen, que bastan para la bilineal. Los
+        // filtros separables cargan siempre la imagen entera, también desde una tubería (que
+        // MappedFile lee completa); ProgArgs ya rechaza --filter combinado con --stream
+        const std::size_t budget =
+                args.filter == ResizeFilter::bilinear ? effectiveStreamBudget(args.inputFile, outputFile, args.streamBudget) : 0;
+        if (budget > 0) {
+            Image::resizeStreaming(args.inputFile, outputFile, newWidth, newHeight, budget);
+            return;
+        }
         args.image->loadPPM(args.inputFile);
-        args.image->resize(newWidth, newHeight);
-        args.image->savePPM(args.outputFile);
+        args.image->resize(newWidth, newHeight, args.filter);
+        args.image->savePPM(outputFile);
+    }
+
+    // Todos los niveles de potencia de dos: el origen se carga una vez y cada nivel se
+    // reduce a la mitad desde el anterior; el nivel n (1/2^n) se guarda en <salida>_n
+    void handlePyramid(Image& image, const std::string& inputFile, const std::string& outputFile, const int levels) {
+        image.loadPPM(inputFile);
+        for (int nivel = 1; nivel <= levels && (image.getWidth() > 1 || image.getHeight() > 1); ++nivel) {
+            image.reduceBox(2, 2);
+            image.savePPM(pyramidLevelFile(outputFile, nivel));
+        }
     }
 
     struct CutFreqArgs {
@@ -76,14 +182,32 @@ namespace {
     }
 
     struct CompressArgs {
-        Image* image;
         std::string inputFile;
         std::string outputFile;
+        CPPMOptions options;
     };
 
+    // Se comprime directamente desde el archivo proyectado, sin cargar la imagen
     void handleCompress(const CompressArgs& args) {
-        args.image->loadPPM(args.inputFile);
-        args.image->compress(args.outputFile);
+        compressMapped(args.inputFile, args.outputFile, args.options);
+    }
+
+    // Expande un CPPM (C6) a P6; con región solo se expande ese rectángulo
+    void handleDecompress(Image& image, const std::string& inputFile, const std::string& outputFile,
+                          const std::optional<CPPMRegion>& region) {
+        image.loadCPPM(inputFile, region);
+        image.savePPM(outputFile);
+    }
+
+    // Conversión entre PPM y la caché planar; la entrada se reconoce por su firma, así que
+    // ambas operaciones aceptan cualquiera de los dos formatos
+    void handlePlanar(Image& image, const std::string& inputFile, const std::string& outputFile, const bool toPlanar) {
+        image.loadPPM(inputFile);
+        if (toPlanar) {
+            image.savePlanar(outputFile);
+        } else {
+            image.savePPM(outputFile);
+        }
     }
 
     int processOperation(const ProgArgs& progArgs, Image& image) {
@@ -91,17 +215,26 @@ namespace {
         const std::string& inputFile = progArgs.getInputFile();
         const std::string& outputFile = progArgs.getOutputFile();
         const auto& additionalParams = progArgs.getAdditionalParams();
+        const std::size_t streamBudget = progArgs.hasOption("stream") ? streamBudgetBytes(progArgs.getOption("stream")) : 0;
 
         if (operation == "info") {
-            handleInfo(image, inputFile);
+            handleInfo(inputFile);
         } else if (operation == "maxlevel") {
-            handleMaxLevel(MaxLevelArgs{.image = &image, .inputFile = inputFile, .outputFile = outputFile, .level = additionalParams.at(0)});
+            handleMaxLevel(MaxLevelArgs{.image = &image, .inputFile = inputFile, .outputFile = outputFile, .level = additionalParams.at(0), .streamBudget = streamBudget});
         } else if (operation == "resize" && additionalParams.size() >= 2) {
-            handleResize(ResizeArgs{.image = &image, .inputFile = inputFile, .outputFile = outputFile, .width = additionalParams.at(0), .height = additionalParams.at(1)});
+            handleResize(ResizeArgs{.image = &image, .inputFile = inputFile, .targets = resizeTargets(outputFile, additionalParams), .streamBudget = streamBudget, .filter = parseResizeFilter(progArgs.getOption("filter", "bilinear"))});
+        } else if (operation == "pyramid") {
+            handlePyramid(image, inputFile, outputFile,
+                          progArgs.hasOption("levels") ? std::stoi(progArgs.getOption("levels")) : std::numeric_limits<int>::max());
         } else if (operation == "cutfreq") {
             handleCutFreq(CutFreqArgs{.image = &image, .inputFile = inputFile, .outputFile = outputFile, .colorCountStr = additionalParams.at(0)});
         } else if (operation == "compress") {
-            handleCompress(CompressArgs{.image = &image, .inputFile = inputFile, .outputFile = outputFile});
+            handleCompress(CompressArgs{.inputFile = inputFile, .outputFile = outputFile, .options = CPPMOptions{.packed = progArgs.hasOption("packed"), .tileSize = progArgs.hasOption("tiles") ? std::stoi(progArgs.getOption("tiles")) : 0, .lz = progArgs.hasOption("lz")}});
+        } else if (operation == "decompress") {
+            handleDecompress(image, inputFile, outputFile,
+                             progArgs.hasOption("region") ? std::optional(parseRegion(progArgs.getOption("region"))) : std::nullopt);
+        } else if (operation == "toplanar" || operation == "fromplanar") {
+            handlePlanar(image, inputFile, outputFile, operation == "toplanar");
         } else {
             std::cerr << "Error: Invalid option: " << operation << '\n';
             printUsage();
@@ -113,6 +246,8 @@ namespace {
 
 int main(int argc, char* argv[]) {
     const std::vector<std::string> args(argv, argv + argc);
+    // Sin sincronizar con stdio, std::cin y std::cout leen y escriben bloques grandes
+    std::ios::sync_with_stdio(false);
 
     try {
         const ProgArgs progArgs(args);
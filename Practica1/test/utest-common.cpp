@@ -1,10 +1,36 @@
 #include "progargs.hpp"
 #include "binaryio.hpp"
+#include "ppmview.hpp"
+#include "ppmstream.hpp"
+#include "mappedfile.hpp"
+#include "pixelkernels.hpp"
+#include "positionalwriter.hpp"
+#include "outputtarget.hpp"
+#include "sharedmemory.hpp"
+#include "decimalparser.hpp"
+#include "planarcache.hpp"
+#include "cppmview.hpp"
+#include "cppmcompress.hpp"
+#include "bitpack.hpp"
+#include "indexlz.hpp"
+#include "cppmpalette.hpp"
+#include "parallel.hpp"
+#include "resample.hpp"
+#include <sys/mman.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 #include <fstream>
+#include <iostream>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <numbers>
 #include <cstdio>
+#include <numeric>
+#include <sstream>
+#include <vector>
 
 namespace {
     // Constantes para evitar magic numbers en el tamaño de los arrays
@@ -110,6 +136,86 @@ TEST(ProgArgsTest, ValidCompressArguments) {
     EXPECT_TRUE(programArgs.getAdditionalParams().empty());
 }
 
+// Test para la opción --stream de "maxlevel"
+TEST(ProgArgsTest, MaxLevelStreamOption) {
+    const std::vector<std::string> args = {"imtool", "input.ppm", "output.ppm", "maxlevel", "128", "--stream=16"};
+
+    const ProgArgs programArgs(args);
+    EXPECT_EQ(programArgs.getOperation(), "maxlevel");
+    EXPECT_EQ(programArgs.getAdditionalParams().size(), 1U);
+    EXPECT_TRUE(programArgs.hasOption("stream"));
+    EXPECT_EQ(programArgs.getOption("stream"), "16");
+
+    // Los valores que no caben se rechazan sin excepciones fuera de invalid_argument
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "maxlevel", "128", "--stream=99999999999999999999"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "maxlevel", "99999999999999999999"}));
+    EXPECT_EQ(streamBudgetBytes("16"), std::size_t{16} << 20);
+    EXPECT_THROW(static_cast<void>(streamBudgetBytes("0")), std::invalid_argument);
+}
+
+// La entrada y la salida estándar se indican con "-"; resize también admite --stream
+TEST(ProgArgsTest, StandardStreamsAndResizeStream) {
+    const std::vector<std::string> args = {"imtool", "-", "-", "resize", "640", "480", "--stream=8"};
+
+    const ProgArgs programArgs(args);
+    EXPECT_EQ(programArgs.getInputFile(), "-");
+    EXPECT_EQ(programArgs.getOutputFile(), "-");
+    EXPECT_TRUE(isStandardStream(programArgs.getInputFile()));
+    EXPECT_EQ(programArgs.getAdditionalParams().size(), 2U);
+    EXPECT_EQ(programArgs.getOption("stream"), "8");
+}
+
+// Test para opciones no válidas o fuera de su operación
+TEST(ProgArgsTest, InvalidOptions) {
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "maxlevel", "128", "--stream=0"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "compress", "--stream=16"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "info", "--unknown"}));
+}
+
+// Test para las conversiones a y desde la caché planar, que no llevan argumentos
+TEST(ProgArgsTest, PlanarConversions) {
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "input.ppm", "cache.planar", "toplanar"}));
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "cache.planar", "output.ppm", "fromplanar"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "cache.planar", "toplanar", "8"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "cache.planar", "output.ppm", "fromplanar", "--stream=8"}));
+}
+
+// Test para la opción --packed, que solo tiene sentido al comprimir
+TEST(ProgArgsTest, PackedOnlyWithCompress) {
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "input.ppm", "output.cppm", "compress", "--packed"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.cppm", "compress", "--packed=1"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "decompress", "--packed"}));
+}
+
+// Test para pyramid: sin argumentos, con --levels opcional y con salida a archivo
+TEST(ProgArgsTest, PyramidLevels) {
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "input.ppm", "tiles/level.ppm", "pyramid"}));
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "input.ppm", "tiles/level.ppm", "pyramid", "--levels=4"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "tiles/level.ppm", "pyramid", "4"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "tiles/level.ppm", "pyramid", "--levels=0"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "-", "pyramid"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "output.ppm", "resize", "8", "8", "--levels=2"}));
+
+    EXPECT_EQ(pyramidLevelFile("tiles/level.ppm", 1), "tiles/level_1.ppm");
+    EXPECT_EQ(pyramidLevelFile("tiles.d/level", 3), "tiles.d/level_3");
+    EXPECT_EQ(pyramidLevelFile(".level", 2), ".level_2");
+}
+
+// Test para resize con varios tamaños: tríos ancho, alto y salida, cada salida distinta
+TEST(ProgArgsTest, ResizeTargets) {
+    EXPECT_TRUE(ProgArgs::parse({"imtool", "input.ppm", "big.ppm", "resize", "1024", "768", "512", "384", "mid.ppm", "128", "96", "-"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "big.ppm", "resize", "1024", "768", "512", "384"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "big.ppm", "resize", "1024", "768", "512", "384", "big.ppm"}));
+    EXPECT_FALSE(ProgArgs::parse({"imtool", "input.ppm", "-", "resize", "1024", "768", "512", "384", "-"}));
+
+    const std::vector<ResizeTarget> targets = resizeTargets("big.ppm", {"1024", "768", "512", "384", "mid.ppm"});
+    ASSERT_EQ(targets.size(), 2U);
+    EXPECT_EQ(targets[0].width, 1024);
+    EXPECT_EQ(targets[0].outputFile, "big.ppm");
+    EXPECT_EQ(targets[1].height, 384);
+    EXPECT_EQ(targets[1].outputFile, "mid.ppm");
+}
+
 // Pruebas para BinaryIO
 
 TEST(BinaryIOTest, WriteAndReadInt) {
@@ -199,6 +305,910 @@ TEST(BinaryIOTest, ReadFromEmptyFile) {
     }
 }
 
+// Pruebas para BinaryReader y BinaryWriter; un búfer pequeño obliga a cruzar sus límites
+
+TEST(BinaryReaderWriterTest, RoundTripAcrossBufferBoundary) {
+    constexpr std::size_t SMALL_BUFFER = 16;
+    constexpr std::size_t BLOCK_SIZE = 100;
+    constexpr uint16_t TEST_U16 = 0xABCD;
+    constexpr uint32_t TEST_U32 = 0x01234567;
+    constexpr int64_t TEST_I64 = -1234567890123;
+
+    std::vector<uint8_t> bloque(BLOCK_SIZE);
+    std::iota(bloque.begin(), bloque.end(), uint8_t{0});
+
+    std::stringstream stream;
+    BinaryWriter writer(stream, SMALL_BUFFER);
+    for (int i = 0; i < 3; ++i) {
+        writer.writeLE(TEST_U16);
+        writer.writeBE(TEST_U32);
+        writer.write(bloque);
+        writer.writeLE(TEST_I64);
+        writer.writeBE(TEST_I64);
+    }
+    writer.flush();
+
+    // El big-endian debe quedar con el byte más significativo primero
+    const std::string bytes = stream.str();
+    EXPECT_EQ(static_cast<uint8_t>(bytes[2]), 0x01);
+    EXPECT_EQ(static_cast<uint8_t>(bytes[0]), 0xCD);
+
+    BinaryReader reader(stream, SMALL_BUFFER);
+    std::vector<uint8_t> leido(BLOCK_SIZE);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(reader.readLE<uint16_t>(), TEST_U16);
+        EXPECT_EQ(reader.readBE<uint32_t>(), TEST_U32);
+        reader.read(leido);
+        EXPECT_EQ(leido, bloque);
+        EXPECT_EQ(reader.readLE<int64_t>(), TEST_I64);
+        EXPECT_EQ(reader.readBE<int64_t>(), TEST_I64);
+    }
+    EXPECT_TRUE(reader.atEnd());
+    EXPECT_THROW(reader.readLE<uint8_t>(), std::runtime_error);
+}
+
+TEST(BinaryIOTest, ReadBinaryFileRoundTrip) {
+    const std::string filename = "test_file.bin";
+    const std::vector<uint8_t> contenido = {0, 1, 2, 0xFF, '\n', '\r', 0x7F};
+    BinaryIO::writeBinaryFile(filename, contenido);
+    EXPECT_EQ(BinaryIO::readBinaryFile(filename), contenido);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Pruebas para PositionalWriter
+
+TEST(PositionalWriterTest, WritesEncodedBlocksAtTheirOffsets) {
+    const std::string filename = "test_positional.bin";
+    const std::string prefijo = "C6 cabecera\n";
+    constexpr std::size_t ITEMS = 3 * OUTPUT_BLOCK_SIZE / 2;
+
+    {
+        PositionalWriter writer(filename, prefijo.size() + (ITEMS * 2));
+        writer.writeAt(0, prefijo);
+        writer.writeEncoded(prefijo.size(), ITEMS, 2, [](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+            for (std::size_t i = first; i < last; ++i) {
+                out[2 * (i - first)] = static_cast<uint8_t>(i);
+                out[(2 * (i - first)) + 1] = static_cast<uint8_t>(i >> 8U);
+            }
+        });
+        writer.close();
+    }
+
+    const std::vector<uint8_t> contenido = BinaryIO::readBinaryFile(filename);
+    ASSERT_EQ(contenido.size(), prefijo.size() + (ITEMS * 2));
+    EXPECT_TRUE(std::equal(prefijo.begin(), prefijo.end(), contenido.begin()));
+    for (std::size_t i = 0; i < ITEMS; ++i) {
+        ASSERT_EQ(contenido[prefijo.size() + (2 * i)], static_cast<uint8_t>(i));
+        ASSERT_EQ(contenido[prefijo.size() + (2 * i) + 1], static_cast<uint8_t>(i >> 8U));
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Pruebas para el analizador decimal de P3
+TEST(DecimalParserTest, ParsesAcrossBlocksAndChunks) {
+    // Números de longitud variable con separadores variados que cruzan bloques y trozos
+    std::string texto = "\n";
+    std::vector<uint8_t> esperado;
+    for (int i = 0; i < 1000; ++i) {
+        const int valor = (i * 37) % 256;
+        texto += std::to_string(valor) + (i % 7 == 0 ? "\r\n" : (i % 3 == 0 ? "\t " : " "));
+        esperado.push_back(static_cast<uint8_t>(valor));
+    }
+    const std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t *>(texto.data()), texto.size());
+
+    EXPECT_EQ(parseDecimalRaster(bytes, esperado.size(), 255), esperado);
+    EXPECT_EQ(parseDecimalRaster(bytes, esperado.size(), 255, 64), esperado);
+    EXPECT_THROW(static_cast<void>(parseDecimalRaster(bytes, esperado.size() + 1, 255, 64)), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(parseDecimalRaster(bytes, esperado.size() - 1, 255, 64)), std::runtime_error);
+    EXPECT_THROW(static_cast<void>(parseDecimalRaster(bytes, esperado.size(), 254, 64)), std::runtime_error);
+
+    const std::string muestras16 = "65535 256 0x1";
+    const std::span<const uint8_t> bytes16(reinterpret_cast<const uint8_t *>(muestras16.data()), muestras16.size());
+    EXPECT_EQ(parseDecimalRaster(bytes16.first(9), 2, 65535), (std::vector<uint8_t>{255, 255, 1, 0}));
+    EXPECT_THROW(static_cast<void>(parseDecimalRaster(bytes16, 4, 65535)), std::runtime_error);
+}
+
+// Pruebas para la memoria compartida
+TEST(SharedMemoryTest, RoundTripsPPMThroughSegment) {
+    const std::string segmento = "shm:utest-common-" + std::to_string(::getpid());
+    constexpr std::size_t ANCHO = 5;
+    constexpr std::size_t ALTO = 3;
+    const std::string cabecera = "P6\n5 3\n255\n";
+
+    writeEncodedOutput(segmento, cabecera, ANCHO * ALTO, 3, [](const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+        for (std::size_t i = first; i < last; ++i) {
+            out[3 * (i - first)] = static_cast<uint8_t>(i);
+            out[(3 * (i - first)) + 1] = static_cast<uint8_t>(2 * i);
+            out[(3 * (i - first)) + 2] = static_cast<uint8_t>(3 * i);
+        }
+    });
+
+    {
+        const PPMView view(segmento);
+        EXPECT_EQ(view.header().width, static_cast<int>(ANCHO));
+        EXPECT_EQ(view.header().height, static_cast<int>(ALTO));
+        ASSERT_EQ(view.raster().size(), ANCHO * ALTO * 3);
+        for (std::size_t i = 0; i < ANCHO * ALTO; ++i) {
+            ASSERT_EQ(view.raster()[3 * i], static_cast<uint8_t>(i));
+            ASSERT_EQ(view.raster()[(3 * i) + 2], static_cast<uint8_t>(3 * i));
+        }
+    }
+
+    // Leerlo como entrada lo ha eliminado
+    EXPECT_NE(::shm_unlink(sharedMemoryName(segmento).c_str()), 0);
+    EXPECT_THROW(MappedFile{segmento}, std::runtime_error);
+    EXPECT_THROW(static_cast<void>(sharedMemoryName("shm:")), std::invalid_argument);
+}
+
+// Pruebas para la caché planar
+
+// Planos de 16 bits cuyo tamaño no es múltiplo de la alineación: cada uno debe empezar
+// alineado, con el relleno a cero, y leerse tal y como se escribió
+TEST(PlanarCacheTest, WritesAlignedPlanes) {
+    const std::string filename = "test_cache.planar";
+    const PlanarHeader cabecera{.width = 7, .height = 5, .maxColorValue = 1000, .channels = 3};
+    const auto muestra = [](const std::size_t plano, const std::size_t i) { return static_cast<uint16_t>((plano * 300) + i); };
+
+    writePlanarCache(filename, cabecera, [&](const std::size_t plano, const std::size_t first, const std::size_t last, const std::span<uint8_t> out) {
+        for (std::size_t i = first; i < last; ++i) {
+            const uint16_t valor = muestra(plano, i);
+            std::memcpy(&out[2 * (i - first)], &valor, sizeof(valor));
+        }
+    });
+
+    const std::vector<uint8_t> contenido = BinaryIO::readBinaryFile(filename);
+    ASSERT_EQ(contenido.size(), PLANAR_ALIGNMENT + (3 * 2 * PLANAR_ALIGNMENT));
+    EXPECT_TRUE(isPlanarCacheFile(filename));
+    EXPECT_TRUE(std::all_of(contenido.begin() + static_cast<std::ptrdiff_t>(PLANAR_ALIGNMENT + cabecera.planeBytes()),
+                            contenido.begin() + static_cast<std::ptrdiff_t>(PLANAR_ALIGNMENT + cabecera.planeStride()),
+                            [](const uint8_t byte) { return byte == 0; }));
+    {
+        const PlanarView view{MappedFile(filename)};
+        EXPECT_EQ(view.header().width, 7);
+        EXPECT_EQ(view.header().height, 5);
+        EXPECT_EQ(view.header().maxColorValue, 1000);
+        ASSERT_EQ(view.header().channels, 3U);
+        for (std::size_t plano = 0; plano < 3; ++plano) {
+            const std::span<const uint8_t> bytes = view.plane(plano);
+            ASSERT_EQ(bytes.size(), cabecera.planeBytes());
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(bytes.data()) % PLANAR_ALIGNMENT, 0U);
+            for (std::size_t i = 0; i < cabecera.pixelCount(); ++i) {
+                uint16_t valor = 0;
+                std::memcpy(&valor, &bytes[2 * i], sizeof(valor));
+                ASSERT_EQ(valor, muestra(plano, i));
+            }
+        }
+    }
+
+    const std::span<const uint8_t> truncado(contenido.data(), contenido.size() - 1);
+    EXPECT_THROW(static_cast<void>(parsePlanarHeader(truncado)), std::runtime_error);
+    EXPECT_FALSE(isPlanarCache(std::span<const uint8_t>(contenido).subspan(1)));
+
+    // Tres planos de 2147483647 x 1431655766 muestras de 2 bytes: sin comprobar, el tamaño
+    // da la vuelta a 192 bytes, menos que el archivo
+    std::vector<uint8_t> desbordado = contenido;
+    std::ranges::copy(std::array<uint8_t, 8>{0xFF, 0xFF, 0xFF, 0x7F, 0x56, 0x55, 0x55, 0x55}, desbordado.begin() + 12);
+    EXPECT_THROW(static_cast<void>(parsePlanarHeader(desbordado)), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Pruebas para CPPMView
+
+TEST(CPPMViewTest, ExpandsIndicesAndRejectsBadOnes) {
+    const std::string filename = "test_view.cppm";
+    const std::string cabecera = "C6 3 1 1000 2\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    // Tabla de 16 bits big-endian: (1, 256, 1000) y (0, 0, 999)
+    contenido.insert(contenido.end(), {0, 1, 1, 0, 3, 232, 0, 0, 0, 0, 3, 231});
+    contenido.insert(contenido.end(), {1, 0, 1});
+    BinaryIO::writeBinaryFile(filename, contenido);
+
+    {
+        const CPPMView view(filename);
+        EXPECT_EQ(view.header().colorCount, 2);
+        EXPECT_EQ(view.indexBytes(), 1U);
+        ASSERT_EQ(view.palette().size(), 2U);
+        EXPECT_EQ(view.palette()[0], (PaletteColor{1, 256, 1000}));
+        EXPECT_EQ(view.palette()[1], (PaletteColor{0, 0, 999}));
+        std::vector<std::size_t> indices;
+        EXPECT_TRUE(view.expand(0, 3, [&](const std::size_t, const std::size_t indice) { indices.push_back(indice); }));
+        EXPECT_EQ(indices, (std::vector<std::size_t>{1, 0, 1}));
+    }
+
+    contenido.back() = 2;
+    BinaryIO::writeBinaryFile(filename, contenido);
+    {
+        const CPPMView view(filename);
+        EXPECT_FALSE(view.expand(0, 3, [](const std::size_t, const std::size_t) {}));
+    }
+
+    contenido.pop_back();
+    BinaryIO::writeBinaryFile(filename, contenido);
+    EXPECT_THROW(CPPMView{filename}, std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Más de un bloque de la pasada paralela: los índices deben seguir el orden de primera
+// aparición de toda la imagen y expandirse al raster original
+TEST(CPPMCompressTest, MappedCompressionKeepsFirstOccurrenceOrder) {
+    const std::string inputFile = "test_compress.ppm";
+    const std::string outputFile = "test_compress.cppm";
+    constexpr std::size_t PIXELES = (2 * PARALLEL_GRAIN_PIXELS) + 17;
+    const std::string cabecera = "P6\n" + std::to_string(PIXELES) + " 1\n1000\n";
+
+    // Colores de 16 bits que comparten el byte bajo: solo se distinguen con la clave completa
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    for (std::size_t i = 0; i < PIXELES; ++i) {
+        const auto nivel = static_cast<uint16_t>((i * 7919) % 1001);
+        contenido.insert(contenido.end(), {static_cast<uint8_t>(nivel >> 8U), static_cast<uint8_t>(nivel), 0, 1,
+                                           static_cast<uint8_t>(nivel >> 8U), 2});
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    for (const bool packed : {false, true}) {
+        ASSERT_NO_THROW(compressMapped(inputFile, outputFile, CPPMOptions{.packed = packed}));
+        const CPPMView view(outputFile);
+        ASSERT_EQ(view.palette().size(), 1001U);
+        EXPECT_EQ(view.indexBytes(), 2U);
+        EXPECT_EQ(view.packedBits(), packed ? 10U : 0U);
+        std::size_t siguiente = 0;
+        bool ordenado = true;
+        const bool valido = view.expand(0, PIXELES, [&](const std::size_t pixel, const std::size_t indice) {
+            const auto nivel = static_cast<uint16_t>((pixel * 7919) % 1001);
+            ordenado = ordenado && indice <= siguiente && view.palette()[indice] == PaletteColor{nivel, 1, static_cast<uint16_t>((nivel & 0xFF00U) | 2U)};
+            siguiente = std::max(siguiente, indice + 1);
+        });
+        EXPECT_TRUE(valido);
+        EXPECT_TRUE(ordenado);
+    }
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        std::perror("Error al eliminar los archivos temporales");
+    }
+}
+
+// Comprimir sobre el propio archivo de entrada: la salida se escribe en un temporal que
+// se renombra al terminar, así que el raster proyectado no se trunca mientras se lee
+TEST(CPPMCompressTest, CompressesOverItsOwnInput) {
+    const std::string inputFile = "test_inplace.ppm";
+    const std::string referenceFile = "test_inplace_ref.cppm";
+    constexpr int ANCHO = 301;
+    constexpr int ALTO = 257;
+    const std::string cabecera = "P6\n" + std::to_string(ANCHO) + " " + std::to_string(ALTO) + "\n255\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    for (int i = 0; i < ANCHO * ALTO; ++i) {
+        contenido.insert(contenido.end(), {static_cast<uint8_t>(i % 251), static_cast<uint8_t>(i % 7), static_cast<uint8_t>(i % 3)});
+    }
+
+    for (const CPPMOptions &opciones : {CPPMOptions{}, CPPMOptions{.packed = false, .tileSize = 16, .lz = true}}) {
+        BinaryIO::writeBinaryFile(inputFile, contenido);
+        EXPECT_TRUE(isSameFile(inputFile, inputFile));
+        EXPECT_FALSE(isSameFile(inputFile, referenceFile));
+        EXPECT_FALSE(isSameFile(inputFile, std::string(STANDARD_STREAM_PATH)));
+        ASSERT_NO_THROW(compressMapped(inputFile, referenceFile, opciones));
+        ASSERT_NO_THROW(compressMapped(inputFile, inputFile, opciones));
+        EXPECT_EQ(BinaryIO::readBinaryFile(inputFile), BinaryIO::readBinaryFile(referenceFile));
+    }
+
+    // No queda ningún temporal junto al archivo
+    for (const auto &entrada : std::filesystem::directory_iterator(".")) {
+        EXPECT_FALSE(entrada.path().filename().string().starts_with(inputFile + "."));
+    }
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(referenceFile.c_str()) != 0) {
+        std::perror("Error al eliminar los archivos temporales");
+    }
+}
+
+// En mosaico (con teselas de borde incompletas) o comprimida, la imagen completa y cualquier
+// región deben expandirse a los mismos índices que sin mosaico
+TEST(CPPMCompressTest, TiledRegionsMatchUntiled) {
+    const std::string inputFile = "test_tiles.ppm";
+    const std::string plainFile = "test_tiles_plain.cppm";
+    const std::string tiledFile = "test_tiles.cppm";
+    constexpr int ANCHO = 37;
+    constexpr int ALTO = 23;
+    const std::string cabecera = "P6\n" + std::to_string(ANCHO) + " " + std::to_string(ALTO) + "\n255\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    for (int i = 0; i < ANCHO * ALTO; ++i) {
+        contenido.insert(contenido.end(), {static_cast<uint8_t>((i * 31) % 300 / 2), static_cast<uint8_t>(i % 5), 7});
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+    ASSERT_NO_THROW(compressMapped(inputFile, plainFile));
+    const CPPMView plano(plainFile);
+
+    for (const CPPMOptions &opciones : {CPPMOptions{.packed = false, .tileSize = 8, .lz = false},
+                                        CPPMOptions{.packed = true, .tileSize = 8, .lz = false},
+                                        CPPMOptions{.packed = false, .tileSize = 8, .lz = true},
+                                        CPPMOptions{.packed = true, .tileSize = 0, .lz = true}}) {
+        ASSERT_NO_THROW(compressMapped(inputFile, tiledFile, opciones));
+        const CPPMView mosaico(tiledFile);
+        EXPECT_EQ(mosaico.tileSize(), opciones.tileSize);
+        EXPECT_EQ(mosaico.compressed(), opciones.lz);
+        EXPECT_EQ(mosaico.tileCount(), opciones.tileSize > 0 ? 15U : 1U);
+        for (const CPPMRegion &region : {mosaico.fullRegion(), CPPMRegion{.x = 5, .y = 9, .width = 30, .height = 3},
+                                         CPPMRegion{.x = 36, .y = 22, .width = 1, .height = 1}}) {
+            std::vector<std::size_t> esperado(static_cast<std::size_t>(region.width * region.height));
+            std::vector<std::size_t> obtenido(esperado.size());
+            plano.expandRegion(region, [&](const std::size_t x, const std::size_t y, const std::size_t indice) {
+                esperado[(y * static_cast<std::size_t>(region.width)) + x] = indice;
+            });
+            mosaico.expandRegion(region, [&](const std::size_t x, const std::size_t y, const std::size_t indice) {
+                obtenido[(y * static_cast<std::size_t>(region.width)) + x] = indice;
+            });
+            EXPECT_EQ(obtenido, esperado);
+        }
+        EXPECT_THROW(mosaico.expandRegion(CPPMRegion{.x = 30, .y = 0, .width = 8, .height = 1}, [](auto, auto, auto) {}),
+                     std::runtime_error);
+    }
+
+    EXPECT_THROW(static_cast<void>(parseRegion("1,2,0,4")), std::invalid_argument);
+    EXPECT_THROW(static_cast<void>(parseRegion("1,2,3")), std::invalid_argument);
+    EXPECT_EQ(parseRegion("1,2,3,4").height, 4);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(plainFile.c_str()) != 0 || std::remove(tiledFile.c_str()) != 0) {
+        std::perror("Error al eliminar los archivos temporales");
+    }
+}
+
+// maxlevel sobre CPPM: la tabla se escala (pasando de 8 a 16 bits por muestra) y los
+// índices, con su tabla de desplazamientos, se copian sin tocar
+TEST(CPPMPaletteTest, ScalesTableAndKeepsIndices) {
+    const std::string inputFile = "test_palette.ppm";
+    const std::string compressedFile = "test_palette.cppm";
+    const std::string scaledFile = "test_palette_scaled.cppm";
+    const std::string cabecera = "P6\n20 10\n255\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    for (int i = 0; i < 200; ++i) {
+        contenido.insert(contenido.end(), {static_cast<uint8_t>(i % 7), 255, static_cast<uint8_t>(i / 20)});
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    for (const CPPMOptions &opciones : {CPPMOptions{}, CPPMOptions{.packed = true, .tileSize = 8, .lz = true}}) {
+        ASSERT_NO_THROW(compressMapped(inputFile, compressedFile, opciones));
+        const auto escalar = [](const std::span<uint16_t> muestras, const int maximo) {
+            for (uint16_t &muestra : muestras) {
+                muestra = static_cast<uint16_t>(std::lround(muestra * 1000.0 / maximo));
+            }
+        };
+        ASSERT_NO_THROW(rewriteCPPMPalette(compressedFile, scaledFile, 1000, escalar));
+        const CPPMView original(compressedFile);
+        const CPPMView escalada(scaledFile);
+        EXPECT_EQ(escalada.header().magicNumber, original.header().magicNumber);
+        EXPECT_EQ(escalada.header().maxColorValue, 1000);
+        EXPECT_EQ(escalada.tileSize(), original.tileSize());
+        ASSERT_EQ(escalada.palette().size(), original.palette().size());
+        for (std::size_t color = 0; color < original.palette().size(); ++color) {
+            for (std::size_t canal = 0; canal < 3; ++canal) {
+                EXPECT_EQ(escalada.palette()[color][canal], std::lround(original.palette()[color][canal] * 1000.0 / 255.0));
+            }
+        }
+        EXPECT_TRUE(std::ranges::equal(escalada.indexStream(), original.indexStream()));
+
+        // Sobre el propio archivo el resultado es el mismo: los índices se copian de la
+        // proyección antes de sustituirlo
+        ASSERT_NO_THROW(rewriteCPPMPalette(compressedFile, compressedFile, 1000, escalar));
+        EXPECT_EQ(BinaryIO::readBinaryFile(compressedFile), BinaryIO::readBinaryFile(scaledFile));
+    }
+
+    // Un maxval que no cabe en 16 bits (o 0) se rechaza sin llegar a transformar la tabla
+    for (const int maximo : {0, 65536, 100000}) {
+        bool transformada = false;
+        EXPECT_THROW(rewriteCPPMPalette(compressedFile, scaledFile, maximo,
+                                        [&transformada](std::span<uint16_t>, int) { transformada = true; }),
+                     std::invalid_argument);
+        EXPECT_FALSE(transformada);
+    }
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0 || std::remove(scaledFile.c_str()) != 0) {
+        std::perror("Error al eliminar los archivos temporales");
+    }
+}
+
+// Rachas, filas repetidas y datos sin repeticiones deben volver intactos; una entrada
+// truncada o con una distancia imposible se rechaza sin lanzar
+TEST(IndexLZTest, RoundTripsAndRejectsDamage) {
+    constexpr std::size_t FILA = 96;
+    std::vector<uint8_t> datos(FILA * 40);
+    for (std::size_t i = 0; i < datos.size(); ++i) {
+        const std::size_t fila = i / FILA;
+        const std::size_t columna = i % FILA;
+        if (fila < 10) {
+            datos[i] = 3;
+        } else if (fila < 30) {
+            datos[i] = static_cast<uint8_t>((columna * columna) % 251);
+        } else {
+            datos[i] = static_cast<uint8_t>((i * 2654435761U) >> 24U);
+        }
+    }
+
+    const std::vector<uint8_t> comprimidos = lzCompress(datos, 1, FILA);
+    EXPECT_LT(comprimidos.size(), datos.size() / 3);
+    std::vector<uint8_t> recuperados(datos.size());
+    ASSERT_TRUE(lzDecompress(comprimidos, recuperados));
+    EXPECT_EQ(recuperados, datos);
+
+    const std::vector<uint8_t> vacio = lzCompress({}, 1, 0);
+    EXPECT_TRUE(lzDecompress(vacio, {}));
+
+    recuperados.pop_back();
+    EXPECT_FALSE(lzDecompress(comprimidos, recuperados));
+    recuperados.resize(datos.size());
+    EXPECT_FALSE(lzDecompress(std::span(comprimidos).first(comprimidos.size() - 1), recuperados));
+    // Primera secuencia sin literales con una repetición: no hay nada atrás que copiar
+    EXPECT_FALSE(lzDecompress(std::vector<uint8_t>{0, 4, 1, 0, 0}, std::span(recuperados).first(4)));
+}
+
+// Todos los anchos, con los núcleos SIMD (hasta 16 bits) y el bucle escalar, contra una
+// referencia que escribe los bits uno a uno
+TEST(BitPackTest, RoundTripsEveryWidth) {
+    constexpr std::size_t INDICES = 5 * PACK_GROUP;
+    for (unsigned bits = 1; bits <= 32; ++bits) {
+        std::vector<uint32_t> indices(INDICES);
+        for (std::size_t i = 0; i < INDICES; ++i) {
+            indices[i] = static_cast<uint32_t>(i * 2654435761U) >> (32 - bits);
+        }
+        std::vector<uint8_t> referencia(packedSize(INDICES, bits));
+        for (std::size_t bit = 0; bit < INDICES * bits; ++bit) {
+            if (((indices[bit / bits] >> (bit % bits)) & 1U) != 0) {
+                referencia[bit / 8] = static_cast<uint8_t>(referencia[bit / 8] | (1U << (bit % 8)));
+            }
+        }
+
+        std::vector<uint8_t> empaquetado(packedSize(INDICES, bits));
+        packIndices(indices, bits, empaquetado);
+        ASSERT_EQ(empaquetado, referencia) << bits << " bits";
+        std::vector<uint32_t> recuperado(INDICES);
+        unpackIndices(empaquetado, bits, recuperado);
+        ASSERT_EQ(recuperado, indices) << bits << " bits";
+    }
+    EXPECT_EQ(packedIndexBits(1), 1U);
+    EXPECT_EQ(packedIndexBits(256), 8U);
+    EXPECT_EQ(packedIndexBits(257), 9U);
+}
+
+TEST(CPPMCompressTest, ColorIndexMapGrows) {
+    ColorIndexMap mapa;
+    for (uint32_t i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(mapa.insert(static_cast<uint64_t>(i) << 24U, i));
+    }
+    EXPECT_FALSE(mapa.insert(0, 1));
+    EXPECT_EQ(mapa.size(), 10000U);
+    ASSERT_NE(mapa.find(uint64_t{9999} << 24U), nullptr);
+    EXPECT_EQ(*mapa.find(uint64_t{9999} << 24U), 9999U);
+    EXPECT_EQ(mapa.find(1), nullptr);
+}
+
+// Pruebas para PPMView
+
+TEST(PPMViewTest, ParsesHeaderInPlace) {
+    const std::string filename = "view_test.ppm";
+    {
+        std::ofstream ofs(filename, std::ios::binary);
+        ASSERT_TRUE(ofs.is_open());
+        ofs << "P6\n# comentario\n2 1\n255\n";
+        ofs.write("\x01\x02\x03\x04\x05\x06", 6);
+    }
+
+    {
+        const PPMView view(filename);
+        EXPECT_EQ(view.header().width, 2);
+        EXPECT_EQ(view.header().height, 1);
+        EXPECT_EQ(view.header().maxColorValue, 255);
+        ASSERT_EQ(view.raster().size(), 6U);
+        EXPECT_EQ(view.raster()[0], 1);
+        EXPECT_EQ(view.raster()[5], 6);
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Un P3 (o P2) que llega por una tubería se decodifica por franjas al mismo raster que la
+// vista proyectada del archivo; un número fuera de rango o una entrada corta se rechazan
+TEST(PPMStreamTest, DecodesPlainTextFromPipe) {
+    const std::string filename = "plain_pipe.ppm";
+    const auto leerTuberia = [&filename](const std::size_t bytesFranja) {
+        // La entrada estándar se sustituye por la salida de `cat` mientras dura la lectura
+        FILE *tuberia = popen(("cat " + filename).c_str(), "r");
+        const int original = ::dup(STDIN_FILENO);
+        ::dup2(::fileno(tuberia), STDIN_FILENO);
+        std::vector<uint8_t> raster;
+        std::exception_ptr error;
+        try {
+            PPMStripReader reader{std::string(STANDARD_STREAM_PATH)};
+            std::vector<uint8_t> franja(bytesFranja);
+            for (std::size_t filas = reader.readRows(franja); filas > 0; filas = reader.readRows(franja)) {
+                raster.insert(raster.end(), franja.begin(), franja.begin() + static_cast<std::ptrdiff_t>(filas * reader.rowBytes()));
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        ::dup2(original, STDIN_FILENO);
+        ::close(original);
+        pclose(tuberia);
+        std::cin.clear();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return raster;
+    };
+    const auto escribir = [&filename](const std::string &texto) {
+        BinaryIO::writeBinaryFile(filename, std::vector<uint8_t>(texto.begin(), texto.end()));
+    };
+
+    std::string p3 = "P3\n# texto\n7 5\n1000\n";
+    for (int i = 0; i < 7 * 5 * 3; ++i) {
+        p3 += std::to_string((i * 97) % 1001) + (i % 7 == 6 ? "\n" : "  ");
+    }
+    for (const std::string &texto : {p3, std::string("P2 3 2 255\n0 1 2\t3\r\n254 255")}) {
+        escribir(texto);
+        const PPMView vista(filename);
+        const std::vector<uint8_t> esperado(vista.raster().begin(), vista.raster().end());
+        EXPECT_EQ(leerTuberia(64), esperado);
+        EXPECT_EQ(leerTuberia(1 << 16), esperado);
+    }
+
+    escribir("P3 2 1 255\n1 2 3 4 5 256\n");
+    EXPECT_THROW(static_cast<void>(leerTuberia(64)), std::runtime_error);
+    escribir("P3 2 1 255\n1 2 3 4 5");
+    EXPECT_THROW(static_cast<void>(leerTuberia(64)), std::runtime_error);
+    escribir("P3 2 1 255\n1 2 3 4 5 x6\n");
+    EXPECT_THROW(static_cast<void>(leerTuberia(64)), std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Un comentario más largo que el primer bloque leído no corta el encabezado: el lector por
+// franjas sigue leyendo hasta que termina, igual que la vista proyectada
+TEST(PPMStreamTest, ReadsHeaderLongerThanFirstBlock) {
+    const std::string filename = "long_header.ppm";
+    const std::string cabecera = "P6\n#" + std::string(10000, 'x') + "\n2 1\n255\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    contenido.insert(contenido.end(), {1, 2, 3, 4, 5, 6});
+    BinaryIO::writeBinaryFile(filename, contenido);
+
+    const std::span<const uint8_t> bytes(contenido);
+    EXPECT_TRUE(isTruncatedPPMHeader(bytes.first(4096)));
+    EXPECT_TRUE(isTruncatedPPMHeader(bytes.first(cabecera.size() - 1)));
+    EXPECT_FALSE(isTruncatedPPMHeader(bytes.first(cabecera.size())));
+    EXPECT_FALSE(isTruncatedPPMHeader(std::span(reinterpret_cast<const uint8_t *>("P6 x"), 4)));
+
+    {
+        PPMStripReader reader(filename);
+        EXPECT_EQ(reader.header().width, 2);
+        EXPECT_EQ(reader.header().maxColorValue, 255);
+        std::vector<uint8_t> fila(reader.rowBytes());
+        ASSERT_EQ(reader.readRows(fila), 1U);
+        EXPECT_EQ(fila, (std::vector<uint8_t>{1, 2, 3, 4, 5, 6}));
+        EXPECT_EQ(PPMView(filename).header().dataOffset, cabecera.size());
+    }
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+TEST(PPMViewTest, RejectsTruncatedRaster) {
+    const std::string filename = "view_truncated.ppm";
+    {
+        std::ofstream ofs(filename, std::ios::binary);
+        ASSERT_TRUE(ofs.is_open());
+        ofs << "P6 2 2 255\n" << "abc";
+    }
+
+    EXPECT_THROW(PPMView{filename}, std::runtime_error);
+
+    if (std::remove(filename.c_str()) != 0) {
+        std::perror("Error al eliminar el archivo temporal");
+    }
+}
+
+// Pruebas para los núcleos de separación de canales
+
+// Longitudes que no son múltiplo del bloque SIMD para ejercitar también la cola escalar
+TEST(PixelKernelsTest, DeinterleaveHandlesTails) {
+    constexpr std::size_t PIXELS = 37;
+    constexpr int BYTE_SHIFT = 8;
+    std::vector<uint8_t> raster8(PIXELS * 3);
+    std::vector<uint8_t> raster16(PIXELS * 6);
+    for (std::size_t i = 0; i < raster16.size(); ++i) {
+        raster16[i] = static_cast<uint8_t>((i * 7) + 3);
+        if (i < raster8.size()) {
+            raster8[i] = static_cast<uint8_t>((i * 5) + 1);
+        }
+    }
+
+    std::vector<uint16_t> red(PIXELS);
+    std::vector<uint16_t> green(PIXELS);
+    std::vector<uint16_t> blue(PIXELS);
+
+    deinterleaveRGB8(raster8, red, green, blue);
+    for (std::size_t i = 0; i < PIXELS; ++i) {
+        EXPECT_EQ(red[i], raster8[i * 3]);
+        EXPECT_EQ(green[i], raster8[(i * 3) + 1]);
+        EXPECT_EQ(blue[i], raster8[(i * 3) + 2]);
+    }
+
+    deinterleaveRGB16BE(raster16, red, green, blue);
+    for (std::size_t i = 0; i < PIXELS; ++i) {
+        EXPECT_EQ(red[i], (raster16[i * 6] << BYTE_SHIFT) | raster16[(i * 6) + 1]);
+        EXPECT_EQ(green[i], (raster16[(i * 6) + 2] << BYTE_SHIFT) | raster16[(i * 6) + 3]);
+        EXPECT_EQ(blue[i], (raster16[(i * 6) + 4] << BYTE_SHIFT) | raster16[(i * 6) + 5]);
+    }
+}
+
+// El escalado vectorial redondea exactamente como std::round, también en las mitades
+TEST(PixelKernelsTest, ScaleSamplesMatchesRound) {
+    constexpr std::size_t SAMPLES = 1021;
+    std::vector<uint16_t> samples(SAMPLES);
+    std::iota(samples.begin(), samples.end(), uint16_t{0});
+    std::vector<uint16_t> esperado(SAMPLES);
+    for (const float factor : {0.5F, 0.3F, 1.5F, 64.0F}) {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            esperado[i] = static_cast<uint16_t>(std::round(static_cast<float>(i) * factor));
+        }
+        std::iota(samples.begin(), samples.end(), uint16_t{0});
+        scaleSamples(samples, factor);
+        EXPECT_EQ(samples, esperado);
+    }
+}
+
+// Los núcleos de un solo canal deben ser inversos entre sí, incluidos los restos escalares
+TEST(PixelKernelsTest, SingleChannelRoundTrip) {
+    constexpr std::size_t SAMPLES = 77;
+    std::vector<uint8_t> bytes(2 * SAMPLES);
+    std::iota(bytes.begin(), bytes.end(), uint8_t{5});
+    std::vector<uint16_t> samples(SAMPLES);
+    std::vector<uint8_t> output(2 * SAMPLES);
+
+    widenSamples8(std::span(bytes).first(SAMPLES), samples);
+    narrowSamples8(samples, std::span(output).first(SAMPLES));
+    EXPECT_TRUE(std::equal(output.begin(), output.begin() + SAMPLES, bytes.begin()));
+
+    loadSamples16BE(bytes, samples);
+    EXPECT_EQ(samples[1], (7U << 8U) | 8U);
+    storeSamples16BE(samples, output);
+    EXPECT_EQ(output, bytes);
+}
+
+// El núcleo bilineal de punto fijo redondea al más cercano: con 8 bits el resultado es
+// exacto respecto a los pesos cuantizados y con 16 bits el redondeo intermedio cuesta como
+// mucho una unidad. Se prueban 1, 3 y 4 canales con bloques vectoriales y restos.
+TEST(PixelKernelsTest, FixedPointBilinearRounds) {
+    constexpr std::size_t WIDTH = 21;
+    constexpr std::size_t NEW_WIDTH = 37;
+    for (const int maxColorValue : {255, 65535}) {
+        const unsigned bits = resizeWeightBits(maxColorValue);
+        const double escala = std::ldexp(1.0, static_cast<int>(bits));
+        std::vector<ResizeColumn> columnas(NEW_WIDTH);
+        for (std::size_t x = 0; x < NEW_WIDTH; ++x) {
+            const double original = static_cast<double>(x * WIDTH) / NEW_WIDTH;
+            const auto base = static_cast<std::size_t>(original);
+            columnas[x] = fixedResizeColumn(base, std::min(base + 1, WIDTH - 1),
+                                            static_cast<float>(original - static_cast<double>(base)), bits);
+        }
+        EXPECT_EQ(columnas.back().left + 1, WIDTH - 1);
+
+        for (const std::size_t canales : {std::size_t{1}, std::size_t{3}, std::size_t{4}}) {
+            std::vector<uint16_t> arriba(WIDTH * canales);
+            std::vector<uint16_t> abajo(WIDTH * canales);
+            for (std::size_t i = 0; i < arriba.size(); ++i) {
+                arriba[i] = static_cast<uint16_t>(((i * 7919) + 13) % static_cast<std::size_t>(maxColorValue + 1));
+                abajo[i] = static_cast<uint16_t>(((i * 104729) + 71) % static_cast<std::size_t>(maxColorValue + 1));
+            }
+            const auto pesoY = static_cast<uint32_t>(escala * 0.3);
+            std::vector<uint16_t> salida(NEW_WIDTH * canales);
+            interpolateRow(arriba, abajo, columnas, pesoY, bits, canales, salida);
+
+            for (std::size_t x = 0; x < NEW_WIDTH; ++x) {
+                const double dx = columnas[x].weight / escala;
+                const double dy = pesoY / escala;
+                for (std::size_t canal = 0; canal < canales; ++canal) {
+                    const std::size_t izquierda = (columnas[x].left * canales) + canal;
+                    const double fila0 = (arriba[izquierda] * (1 - dx)) + (arriba[izquierda + canales] * dx);
+                    const double fila1 = (abajo[izquierda] * (1 - dx)) + (abajo[izquierda + canales] * dx);
+                    const double exacto = (fila0 * (1 - dy)) + (fila1 * dy);
+                    const double error = std::abs(salida[(x * canales) + canal] - std::floor(exacto + 0.5));
+                    EXPECT_LE(error, maxColorValue == 255 ? 0.0 : 1.0) << canales << " canales, x = " << x;
+                }
+            }
+        }
+    }
+
+    // Una mitad exacta se redondea hacia arriba en lugar de truncarse
+    const std::vector<uint16_t> fila = {0, 1, 0, 1, 0, 1, 0, 1, 0, 1};
+    const std::vector<ResizeColumn> mitades(8, ResizeColumn{.left = 0, .weight = 128});
+    std::vector<uint16_t> salida(mitades.size());
+    interpolateRow(fila, fila, mitades, 0, resizeWeightBits(255), 1, salida);
+    EXPECT_TRUE(std::ranges::all_of(salida, [](const uint16_t valor) { return valor == 1; }));
+}
+
+TEST(PixelKernelsTest, BoxReduceAveragesBlocks) {
+    // Ancho impar con más de 16 parejas: pasa por el camino vectorial, su cola escalar y el
+    // bloque incompleto del borde
+    constexpr std::size_t WIDTH = 45;
+    constexpr std::array<std::pair<std::size_t, std::size_t>, 5> FACTORES = {{{2, 2}, {3, 2}, {4, 4}, {2, 1}, {1, 3}}};
+    for (const std::size_t canales : {std::size_t{1}, std::size_t{3}, std::size_t{4}}) {
+        for (const auto &[factorX, factorY] : FACTORES) {
+            std::vector<std::vector<uint16_t>> origen(factorY, std::vector<uint16_t>(WIDTH * canales));
+            std::vector<std::span<const uint16_t>> filas;
+            for (std::size_t fila = 0; fila < factorY; ++fila) {
+                for (std::size_t i = 0; i < WIDTH * canales; ++i) {
+                    origen[fila][i] = static_cast<uint16_t>(((i * 7919) + (fila * 104729) + 13) % 65536);
+                }
+                filas.emplace_back(origen[fila]);
+            }
+            const std::size_t nuevoAncho = (WIDTH + factorX - 1) / factorX;
+            std::vector<uint16_t> salida(nuevoAncho * canales);
+            boxReduceRow(filas, factorX, canales, salida);
+
+            const std::size_t muestras = factorX * factorY;
+            for (std::size_t x = 0; x < nuevoAncho; ++x) {
+                for (std::size_t canal = 0; canal < canales; ++canal) {
+                    std::size_t suma = 0;
+                    for (const std::vector<uint16_t> &fila : origen) {
+                        for (std::size_t paso = 0; paso < factorX; ++paso) {
+                            suma += fila[(std::min((x * factorX) + paso, WIDTH - 1) * canales) + canal];
+                        }
+                    }
+                    EXPECT_EQ(salida[(x * canales) + canal], (suma + (muestras / 2)) / muestras)
+                            << canales << " canales, factor " << factorX << "x" << factorY << ", x = " << x;
+                }
+            }
+        }
+    }
+}
+
+TEST(ResamplerTest, ConstantImageIsPreserved) {
+    constexpr int WIDTH = 13;
+    constexpr int HEIGHT = 9;
+    constexpr int NEW_WIDTH = 5;
+    constexpr int NEW_HEIGHT = 17;
+    for (const ResizeFilter filtro : {ResizeFilter::area, ResizeFilter::bicubic, ResizeFilter::lanczos}) {
+        const Resampler::AxisWeights pesos = Resampler::axisWeights(WIDTH, NEW_WIDTH, filtro);
+        for (std::size_t salida = 0; salida < pesos.first.size(); ++salida) {
+            const auto inicio = pesos.weights.begin() + static_cast<std::ptrdiff_t>(salida * pesos.taps);
+            EXPECT_NEAR(std::accumulate(inicio, inicio + static_cast<std::ptrdiff_t>(pesos.taps), 0.0), 1.0, 1e-5);
+            EXPECT_LE(pesos.first[salida] + pesos.taps, static_cast<std::size_t>(WIDTH));
+        }
+
+        const Resampler remuestreo(WIDTH, HEIGHT, NEW_WIDTH, NEW_HEIGHT, filtro);
+        for (const int maxColorValue : {255, 65535}) {
+            for (const std::size_t canales : {std::size_t{1}, std::size_t{3}, std::size_t{4}}) {
+                const auto valor = static_cast<uint16_t>(maxColorValue / 3);
+                const std::vector<uint16_t> origen(static_cast<std::size_t>(WIDTH * HEIGHT) * canales, valor);
+                std::vector<uint16_t> destino(static_cast<std::size_t>(NEW_WIDTH * NEW_HEIGHT) * canales);
+                remuestreo.resample(origen, canales, maxColorValue, destino);
+                EXPECT_TRUE(std::ranges::all_of(destino, [valor](const uint16_t muestra) { return muestra == valor; }))
+                        << canales << " canales, maxval " << maxColorValue;
+            }
+        }
+    }
+    EXPECT_THROW(parseResizeFilter("nearest"), std::invalid_argument);
+}
+
+TEST(ResamplerTest, AreaHalvingAveragesBlocks) {
+    // El intermedio en float conserva la media horizontal exacta, así que cada salida es la
+    // media de su bloque 2x2 redondeada al más cercano
+    constexpr std::size_t WIDTH = 22;
+    constexpr std::size_t HEIGHT = 18;
+    std::vector<uint16_t> origen(WIDTH * HEIGHT);
+    for (std::size_t i = 0; i < origen.size(); ++i) {
+        origen[i] = static_cast<uint16_t>(((i * 7919) + 13) % 256);
+    }
+    const Resampler remuestreo(WIDTH, HEIGHT, WIDTH / 2, HEIGHT / 2, ResizeFilter::area);
+    std::vector<uint16_t> destino((WIDTH / 2) * (HEIGHT / 2));
+    remuestreo.resample(origen, 1, 255, destino);
+    for (std::size_t y = 0; y < HEIGHT / 2; ++y) {
+        for (std::size_t x = 0; x < WIDTH / 2; ++x) {
+            const std::size_t esquina = (2 * y * WIDTH) + (2 * x);
+            const int suma = origen[esquina] + origen[esquina + 1] + origen[esquina + WIDTH] +
+                             origen[esquina + WIDTH + 1];
+            EXPECT_EQ(destino[(y * (WIDTH / 2)) + x], (suma + 2) / 4) << "x = " << x << ", y = " << y;
+        }
+    }
+}
+
+// Con una imagen alta las filas de salida se reparten en varias bandas y el anillo de filas
+// da varias vueltas: cada salida sigue a menos de media unidad (más el error de float) de
+// la convolución separable en double con las mismas tablas de pesos
+TEST(ResamplerTest, MatchesSeparableReference) {
+    constexpr std::size_t WIDTH = 2000;
+    constexpr std::size_t HEIGHT = 600;
+    constexpr std::size_t NEW_WIDTH = 1000;
+    constexpr std::size_t NEW_HEIGHT = 290;
+    constexpr std::size_t CANALES = 3;
+    std::vector<uint16_t> origen(WIDTH * HEIGHT * CANALES);
+    for (std::size_t i = 0; i < origen.size(); ++i) {
+        origen[i] = static_cast<uint16_t>(((i * 7919) + (i / 4099 * 31)) % 256);
+    }
+    const ResizeFilter filtro = ResizeFilter::lanczos;
+    const Resampler remuestreo(WIDTH, HEIGHT, NEW_WIDTH, NEW_HEIGHT, filtro);
+    std::vector<uint16_t> destino(NEW_WIDTH * NEW_HEIGHT * CANALES);
+    remuestreo.resample(origen, CANALES, 255, destino);
+
+    const Resampler::AxisWeights columnas = Resampler::axisWeights(WIDTH, NEW_WIDTH, filtro);
+    const Resampler::AxisWeights filas = Resampler::axisWeights(HEIGHT, NEW_HEIGHT, filtro);
+    std::vector<double> horizontal(NEW_WIDTH * HEIGHT * CANALES, 0.0);
+    for (std::size_t y = 0; y < HEIGHT; ++y) {
+        for (std::size_t x = 0; x < NEW_WIDTH; ++x) {
+            for (std::size_t tap = 0; tap < columnas.taps; ++tap) {
+                const double peso = columnas.weights[(x * columnas.taps) + tap];
+                for (std::size_t canal = 0; canal < CANALES; ++canal) {
+                    horizontal[(((y * NEW_WIDTH) + x) * CANALES) + canal] +=
+                            peso * origen[(((y * WIDTH) + columnas.first[x] + tap) * CANALES) + canal];
+                }
+            }
+        }
+    }
+    double error = 0.0;
+    for (std::size_t y = 0; y < NEW_HEIGHT; ++y) {
+        for (std::size_t muestra = 0; muestra < NEW_WIDTH * CANALES; ++muestra) {
+            double suma = 0.0;
+            for (std::size_t tap = 0; tap < filas.taps; ++tap) {
+                suma += filas.weights[(y * filas.taps) + tap] * horizontal[((filas.first[y] + tap) * NEW_WIDTH * CANALES) + muestra];
+            }
+            error = std::max(error, std::abs(destino[(y * NEW_WIDTH * CANALES) + muestra] - std::clamp(suma, 0.0, 255.0)));
+        }
+    }
+    EXPECT_LT(error, 0.501);
+}
+
+TEST(ResamplerTest, CascadeReusesExactReductions) {
+    const std::vector<ResizeTarget> targets{{.width = 100, .height = 75, .outputFile = "a"},
+                                            {.width = 400, .height = 300, .outputFile = "b"},
+                                            {.width = 200, .height = 150, .outputFile = "c"},
+                                            {.width = 300, .height = 225, .outputFile = "d"},
+                                            {.width = 200, .height = 150, .outputFile = "e"}};
+
+    // Con el filtro de área cada tamaño parte del menor que lo reduce por factores enteros;
+    // 300x225 no reduce 800x600 por factores enteros y no sirve de origen
+    const ResizeCascade area = planResizeCascade(800, 600, targets, ResizeFilter::area);
+    EXPECT_EQ(area.sources, (std::vector<std::optional<std::size_t>>{2, std::nullopt, 1, std::nullopt, 2}));
+    ASSERT_EQ(area.stages.size(), 3U);
+    EXPECT_EQ(area.stages[0], (std::vector<std::size_t>{1, 3}));
+    EXPECT_EQ(area.stages[1], (std::vector<std::size_t>{2}));
+    EXPECT_EQ(area.stages[2], (std::vector<std::size_t>{0, 4}));
+
+    // Con el resto de filtros solo se copian los tamaños repetidos
+    const ResizeCascade bilineal = planResizeCascade(800, 600, targets, ResizeFilter::bilinear);
+    EXPECT_EQ(bilineal.sources, (std::vector<std::optional<std::size_t>>{std::nullopt, std::nullopt, std::nullopt, std::nullopt, 2}));
+    ASSERT_EQ(bilineal.stages.size(), 2U);
+    EXPECT_EQ(bilineal.stages[1], (std::vector<std::size_t>{4}));
+}
+
+// Las tareas que lanzan no interrumpen a las demás y se relanza la del menor índice
+TEST(ParallelTest, ForEachRethrowsFirstError) {
+    std::vector<int> hechas(8, 0);
+    try {
+        parallelForEach(hechas.size(), [&hechas](const std::size_t indice) {
+            hechas[indice] = 1;
+            if (indice == 3 || indice == 6) {
+                throw std::runtime_error(std::to_string(indice));
+            }
+        });
+        FAIL() << "parallelForEach no relanzó la excepción";
+    } catch (const std::runtime_error &error) {
+        EXPECT_STREQ(error.what(), "3");
+    }
+    EXPECT_EQ(std::accumulate(hechas.begin(), hechas.end(), 0), 8);
+}
+
 // Ejecutar todas las pruebas
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
@@ -1,7 +1,12 @@
 #include "./imgaos/imageaos.hpp"
+#include "./common/binaryio.hpp"
+#include "./common/cppmcompress.hpp"
 #include <gtest/gtest.h>
+#include <array>
 #include <fstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Namespace anónimo para limitar el alcance de getInputFile a este archivo D
 namespace {
@@ -9,6 +14,15 @@ namespace {
         static const std::string inputFile = "../../../archivos_entrada/sabatini.ppm";
         return inputFile;
     }
+
+    // Raster P6 de toda la imagen, para comparar los píxeles de dos imágenes
+    std::vector<uint8_t> raster(const Image &image) {
+        const auto pixeles = static_cast<std::size_t>(image.getWidth()) * static_cast<std::size_t>(image.getHeight());
+        const std::size_t bytesMuestra = image.getMaxColorValue() > 255 ? 2 : 1;
+        std::vector<uint8_t> salida(pixeles * (image.getHasAlpha() ? 4 : 3) * bytesMuestra);
+        image.encodePixels(0, pixeles, salida);
+        return salida;
+    }
 }
 
 // Prueba de carga de imagen en formato PPM
@@ -52,6 +66,143 @@ TEST(ImageAosTest, SavePPM) {
     }
 }
 
+// Las muestras de 16 bits son big-endian en el archivo: cargar y guardar debe reproducirlo igual
+TEST(ImageAosTest, RoundTrip16BitPPM) {
+    const std::string inputFile = "photo_16bit.ppm";
+    const std::string outputFile = "photo_16bit_copy.ppm";
+    constexpr int WIDTH = 7;
+    constexpr int HEIGHT = 3;
+    constexpr int BYTES_PER_PIXEL = 6;
+
+    const std::string header = "P6\n" + std::to_string(WIDTH) + " " + std::to_string(HEIGHT) + "\n65535\n";
+    std::vector<uint8_t> contenido(header.begin(), header.end());
+    for (int i = 0; i < WIDTH * HEIGHT * BYTES_PER_PIXEL; ++i) {
+        contenido.push_back(static_cast<uint8_t>((i * 37) + 11));
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    ASSERT_NO_THROW(image.savePPM(outputFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), contenido);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Un P3 se carga igual que el P6 equivalente
+TEST(ImageAosTest, LoadPlainPPM) {
+    const std::string inputFile = "photo_plain.ppm";
+    const std::string outputFile = "photo_plain_copy.ppm";
+
+    const std::string texto = "P3\n# comentario\n2 1\n1000\n0 12 1000\t256\r\n 7  9\n";
+    BinaryIO::writeBinaryFile(inputFile, std::vector<uint8_t>(texto.begin(), texto.end()));
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    ASSERT_NO_THROW(image.savePPM(outputFile));
+    const std::string cabecera = "P6\n2 1\n1000\n";
+    std::vector<uint8_t> esperado(cabecera.begin(), cabecera.end());
+    esperado.insert(esperado.end(), {0, 0, 0, 12, 3, 232, 1, 0, 0, 7, 0, 9});
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), esperado);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Un PAM RGB_ALPHA conserva el canal alfa al cargarlo, guardarlo, escalarlo y redimensionarlo
+TEST(ImageAosTest, RoundTripPAMWithAlpha) {
+    const std::string inputFile = "photo_alpha.pam";
+    const std::string outputFile = "photo_alpha_copy.pam";
+    constexpr int WIDTH = 9;
+    constexpr int HEIGHT = 5;
+    constexpr uint8_t ALPHA = 200;
+
+    const std::string header = "P7\nWIDTH 9\nHEIGHT 5\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+    std::vector<uint8_t> contenido(header.begin(), header.end());
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        contenido.insert(contenido.end(), {static_cast<uint8_t>(i * 5), static_cast<uint8_t>(i * 3), static_cast<uint8_t>(i), ALPHA});
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    EXPECT_TRUE(image.getHasAlpha());
+    ASSERT_NO_THROW(image.savePPM(outputFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), contenido);
+
+    // Ida y vuelta por la caché planar, con un plano de alfa
+    ASSERT_NO_THROW(image.savePlanar(outputFile));
+    Image planar;
+    ASSERT_NO_THROW(planar.loadPPM(outputFile));
+    EXPECT_TRUE(planar.getHasAlpha());
+    ASSERT_NO_THROW(planar.savePPM(outputFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), contenido);
+
+    image.scaleIntensity(510.0F);
+    EXPECT_EQ(image.getPixelsRGBA()[3].red, 30);
+    EXPECT_EQ(image.getPixelsRGBA()[3].alpha, 2 * ALPHA);
+
+    image.resize(4, 11);
+    ASSERT_EQ(image.getPixelsRGBA().size(), 44U);
+    for (const PixelRGBA &pixel : image.getPixelsRGBA()) {
+        EXPECT_EQ(pixel.alpha, 2 * ALPHA);
+    }
+    EXPECT_THROW(image.compress(outputFile), std::runtime_error);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Reducción por bloques de un P6 de tamaño impar: el tamaño se redondea hacia arriba y los
+// bloques del borde promedian solo los píxeles que existen
+TEST(ImageAosTest, ReduceBoxAveragesEdges) {
+    const std::string inputFile = "photo_box.ppm";
+    const std::string outputFile = "photo_box_half.ppm";
+    const std::string header = "P6\n3 3\n255\n";
+    std::vector<uint8_t> contenido(header.begin(), header.end());
+    for (int i = 0; i < 9; ++i) {
+        contenido.insert(contenido.end(), {static_cast<uint8_t>(i * 10), static_cast<uint8_t>(i), 255});
+    }
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    image.reduceBox(2, 2);
+    EXPECT_EQ(image.getWidth(), 2);
+    EXPECT_EQ(image.getHeight(), 2);
+    ASSERT_NO_THROW(image.savePPM(outputFile));
+    const std::string esperado = "P6\n2 2\n255\n";
+    std::vector<uint8_t> reducida(esperado.begin(), esperado.end());
+    reducida.insert(reducida.end(), {20, 2, 255, 35, 4, 255, 65, 7, 255, 80, 8, 255});
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), reducida);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// resized() da lo mismo que resize() sin modificar el origen, que puede reutilizarse
+TEST(ImageAosTest, ResizedKeepsSource) {
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(getInputFile()));
+    const Image original = image;
+
+    const Image reducida = image.resized(50, 50, ResizeFilter::area);
+    const Image bilineal = image.resized(50, 50);
+    EXPECT_EQ(raster(image), raster(original));
+
+    image.resize(50, 50, ResizeFilter::area);
+    EXPECT_EQ(raster(reducida), raster(image));
+    Image copia = original;
+    copia.resize(50, 50);
+    EXPECT_EQ(raster(bilineal), raster(copia));
+    EXPECT_NE(raster(bilineal), raster(reducida));
+}
+
 // Prueba de escala de intensidad
 TEST(ImageAosTest, ScaleIntensity) {
     Image image;
@@ -65,6 +216,98 @@ TEST(ImageAosTest, ScaleIntensity) {
     EXPECT_EQ(image.getMaxColorValue(), static_cast<int>(newMaxLevel));
 }
 
+// El modo por franjas debe producir exactamente el mismo archivo que el modo en memoria
+TEST(ImageAosTest, ScaleIntensityStreamingMatchesInMemory) {
+    Image image;
+    const std::string inMemoryFile = "scaled_memory.ppm";
+    const std::string streamedFile = "scaled_stream.ppm";
+    constexpr float NEW_MAX_LEVEL = 1000.0F;
+    constexpr std::size_t STRIP_BUDGET = 4096;
+
+    ASSERT_NO_THROW(image.loadPPM(getInputFile()));
+    image.scaleIntensity(NEW_MAX_LEVEL);
+    ASSERT_NO_THROW(image.savePPM(inMemoryFile));
+    ASSERT_NO_THROW(Image::scaleIntensityStreaming(getInputFile(), streamedFile, NEW_MAX_LEVEL, STRIP_BUDGET));
+
+    EXPECT_EQ(BinaryIO::readBinaryFile(inMemoryFile), BinaryIO::readBinaryFile(streamedFile));
+
+    if (std::remove(inMemoryFile.c_str()) != 0 || std::remove(streamedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// El redimensionado por filas debe producir exactamente el mismo archivo que el de memoria,
+// tanto al reducir como al ampliar
+TEST(ImageAosTest, ResizeStreamingMatchesInMemory) {
+    const std::string inMemoryFile = "resized_memory.ppm";
+    const std::string streamedFile = "resized_stream.ppm";
+    constexpr std::size_t STRIP_BUDGET = 4096;
+    constexpr std::array<std::pair<int, int>, 2> SIZES = {{{53, 41}, {700, 500}}};
+
+    for (const auto &[newWidth, newHeight] : SIZES) {
+        Image image;
+        ASSERT_NO_THROW(image.loadPPM(getInputFile()));
+        image.resize(newWidth, newHeight);
+        ASSERT_NO_THROW(image.savePPM(inMemoryFile));
+        ASSERT_NO_THROW(Image::resizeStreaming(getInputFile(), streamedFile, newWidth, newHeight, STRIP_BUDGET));
+
+        EXPECT_EQ(BinaryIO::readBinaryFile(inMemoryFile), BinaryIO::readBinaryFile(streamedFile));
+    }
+
+    if (std::remove(inMemoryFile.c_str()) != 0 || std::remove(streamedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// Por franjas sobre la misma ruta: la salida va a un temporal que se renombra al terminar,
+// así que la entrada no se trunca antes de leerla
+TEST(ImageAosTest, StreamingOverItsOwnInput) {
+    const std::string inPlaceFile = "aos_stream_inplace.ppm";
+    const std::string inMemoryFile = "aos_stream_inplace_memory.ppm";
+    constexpr std::size_t STRIP_BUDGET = 4096;
+    const std::vector<uint8_t> original = BinaryIO::readBinaryFile(getInputFile());
+
+    Image escalada;
+    ASSERT_NO_THROW(escalada.loadPPM(getInputFile()));
+    escalada.scaleIntensity(100.0F);
+    ASSERT_NO_THROW(escalada.savePPM(inMemoryFile));
+    BinaryIO::writeBinaryFile(inPlaceFile, original);
+    ASSERT_NO_THROW(Image::scaleIntensityStreaming(inPlaceFile, inPlaceFile, 100.0F, STRIP_BUDGET));
+    EXPECT_EQ(BinaryIO::readBinaryFile(inPlaceFile), BinaryIO::readBinaryFile(inMemoryFile));
+
+    Image reducida;
+    ASSERT_NO_THROW(reducida.loadPPM(getInputFile()));
+    reducida.resize(20, 10);
+    ASSERT_NO_THROW(reducida.savePPM(inMemoryFile));
+    BinaryIO::writeBinaryFile(inPlaceFile, original);
+    ASSERT_NO_THROW(Image::resizeStreaming(inPlaceFile, inPlaceFile, 20, 10, STRIP_BUDGET));
+    EXPECT_EQ(BinaryIO::readBinaryFile(inPlaceFile), BinaryIO::readBinaryFile(inMemoryFile));
+
+    if (std::remove(inPlaceFile.c_str()) != 0 || std::remove(inMemoryFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// Con una sola fila de origen la fila inferior es la misma: el redimensionado en paralelo
+// no debe leer fuera de la imagen y debe coincidir con el de franjas
+TEST(ImageAosTest, ResizeSingleRowMatchesStreaming) {
+    const std::string inputFile = "single_row.ppm";
+    const std::string inMemoryFile = "single_row_memory.ppm";
+    const std::string streamedFile = "single_row_stream.ppm";
+    BinaryIO::writeBinaryFile(inputFile, {'P', '6', '\n', '3', ' ', '1', '\n', '2', '5', '5', '\n', 0, 10, 20, 90, 100, 110, 200, 210, 220});
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    image.resize(5, 3);
+    ASSERT_NO_THROW(image.savePPM(inMemoryFile));
+    ASSERT_NO_THROW(Image::resizeStreaming(inputFile, streamedFile, 5, 3, 4096));
+    EXPECT_EQ(BinaryIO::readBinaryFile(inMemoryFile), BinaryIO::readBinaryFile(streamedFile));
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(inMemoryFile.c_str()) != 0 || std::remove(streamedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
 // Prueba de redimensionamiento de la imagen
 TEST(ImageAosTest, ResizeImage) {
     Image image;
@@ -104,6 +347,59 @@ TEST(ImageAosTest, CompressImage) {
     }
 }
 
+// Prueba de descompresión: el CPPM generado por compress se expande al mismo PPM
+TEST(ImageAosTest, DecompressRestoresCompressedImage) {
+    const std::string compressedFile = "photo_roundtrip.cppm";
+    const std::string outputFile = "photo_roundtrip.ppm";
+    const std::string header = "P6\n4 2\n255\n";
+    const std::string inputFile = "photo_roundtrip_input.ppm";
+    std::vector<uint8_t> contenido(header.begin(), header.end());
+    contenido.insert(contenido.end(), {1, 2, 3, 4, 5, 6, 1, 2, 3, 7, 8, 9, 4, 5, 6, 1, 2, 3, 7, 8, 9, 7, 8, 9});
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    ASSERT_NO_THROW(image.compress(compressedFile));
+
+    Image decompressed;
+    ASSERT_NO_THROW(decompressed.loadCPPM(compressedFile));
+    ASSERT_NO_THROW(decompressed.savePPM(outputFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), contenido);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0 ||
+        std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Con 16 bits (0, 256, 0) y (1, 0, 0) son colores distintos: compress usa la tabla de
+// compressMapped y el archivo es idéntico al suyo
+TEST(ImageAosTest, CompressMatchesMappedWith16BitColors) {
+    const std::string inputFile = "photo_cppm16.ppm";
+    const std::string compressedFile = "photo_cppm16.cppm";
+    const std::string mappedFile = "photo_cppm16_mapped.cppm";
+    const std::string header = "P6\n3 1\n65535\n";
+    std::vector<uint8_t> contenido(header.begin(), header.end());
+    contenido.insert(contenido.end(), {0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0});
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    EXPECT_EQ(image.generateColorTable().colors.size(), 2U);
+    ASSERT_NO_THROW(image.compress(compressedFile));
+    ASSERT_NO_THROW(compressMapped(inputFile, mappedFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(compressedFile), BinaryIO::readBinaryFile(mappedFile));
+
+    Image decompressed;
+    ASSERT_NO_THROW(decompressed.loadCPPM(compressedFile));
+    EXPECT_EQ(raster(decompressed), raster(image));
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0 ||
+        std::remove(mappedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
 // Prueba de cálculo de histograma de colores
 TEST(ImageAosTest, CalculateHistogram) {
     Image image;
@@ -118,9 +414,9 @@ TEST(ImageAosTest, GenerateColorTable) {
     Image image;
     ASSERT_NO_THROW(image.loadPPM(getInputFile()));
 
-    auto [colorTable, colorList] = image.generateColorTable();
-    EXPECT_FALSE(colorTable.empty());
-    EXPECT_FALSE(colorList.empty());
+    const ColorPalette palette = image.generateColorTable();
+    EXPECT_FALSE(palette.colors.empty());
+    EXPECT_EQ(palette.indices.size(), palette.colors.size());
 }
 
 // Función principal para ejecutar todas las pruebas
@@ -1,7 +1,12 @@
 #include "./imgsoa/imagesoa.hpp"
+#include "./common/binaryio.hpp"
+#include "./common/cppmcompress.hpp"
 #include <gtest/gtest.h>
+#include <array>
 #include <fstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 // Prueba de carga de imagen en formato PPM
 TEST(ImageSoaTest, LoadPPM) {
@@ -60,6 +65,202 @@ TEST(ImageSoaTest, ScaleIntensity) {
     EXPECT_EQ(image.maxColorValue, static_cast<int>(newMaxLevel));
 }
 
+// Sobre un CPPM un nivel que no cabe en 16 bits se rechaza en lugar de truncar las muestras
+TEST(ImageSoaTest, ScaleIntensityCPPMRejectsOutOfRangeLevel) {
+    const std::string inputFile = "soa_maxlevel.ppm";
+    const std::string compressedFile = "soa_maxlevel.cppm";
+    const std::string outputFile = "soa_maxlevel_scaled.cppm";
+    const std::string cabecera = "P6\n2 1\n255\n";
+    std::vector<uint8_t> ppm(cabecera.begin(), cabecera.end());
+    ppm.insert(ppm.end(), {10, 20, 30, 200, 100, 0});
+    BinaryIO::writeBinaryFile(inputFile, ppm);
+    ASSERT_NO_THROW(compressMapped(inputFile, compressedFile));
+
+    EXPECT_THROW(Image::scaleIntensityCPPM(compressedFile, outputFile, 70000.0F), std::invalid_argument);
+    EXPECT_THROW(Image::scaleIntensityCPPM(compressedFile, outputFile, 0.0F), std::invalid_argument);
+    ASSERT_NO_THROW(Image::scaleIntensityCPPM(compressedFile, outputFile, 65535.0F));
+    Image escalada;
+    ASSERT_NO_THROW(escalada.loadCPPM(outputFile));
+    EXPECT_EQ(escalada.maxColorValue, 65535);
+    EXPECT_EQ(escalada.red[1], 200 * 257);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0 ||
+        std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// El modo por franjas debe producir exactamente el mismo archivo que el modo en memoria
+TEST(ImageSoaTest, ScaleIntensityStreamingMatchesInMemory) {
+    Image image;
+    const std::string inputFile = "../../../archivos_entrada/sabatini.ppm";
+    const std::string inMemoryFile = "scaled_memory.ppm";
+    const std::string streamedFile = "scaled_stream.ppm";
+    constexpr float NEW_MAX_LEVEL = 1000.0F;
+    constexpr std::size_t STRIP_BUDGET = 4096;
+
+    ASSERT_NO_THROW(image.loadPPM(inputFile));
+    image.scaleIntensity(NEW_MAX_LEVEL);
+    ASSERT_NO_THROW(image.savePPM(inMemoryFile));
+    ASSERT_NO_THROW(Image::scaleIntensityStreaming(inputFile, streamedFile, NEW_MAX_LEVEL, STRIP_BUDGET));
+
+    EXPECT_EQ(BinaryIO::readBinaryFile(inMemoryFile), BinaryIO::readBinaryFile(streamedFile));
+
+    if (std::remove(inMemoryFile.c_str()) != 0 || std::remove(streamedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// El redimensionado por filas debe producir exactamente el mismo archivo que el de memoria,
+// tanto al reducir como al ampliar
+TEST(ImageSoaTest, ResizeStreamingMatchesInMemory) {
+    const std::string inputFile = "../../../archivos_entrada/sabatini.ppm";
+    const std::string inMemoryFile = "resized_memory.ppm";
+    const std::string streamedFile = "resized_stream.ppm";
+    constexpr std::size_t STRIP_BUDGET = 4096;
+    constexpr std::array<std::pair<int, int>, 2> SIZES = {{{53, 41}, {700, 500}}};
+
+    for (const auto &[newWidth, newHeight] : SIZES) {
+        Image image;
+        ASSERT_NO_THROW(image.loadPPM(inputFile));
+        image.resize(newWidth, newHeight);
+        ASSERT_NO_THROW(image.savePPM(inMemoryFile));
+        ASSERT_NO_THROW(Image::resizeStreaming(inputFile, streamedFile, newWidth, newHeight, STRIP_BUDGET));
+
+        EXPECT_EQ(BinaryIO::readBinaryFile(inMemoryFile), BinaryIO::readBinaryFile(streamedFile));
+    }
+
+    if (std::remove(inMemoryFile.c_str()) != 0 || std::remove(streamedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// Por franjas sobre la misma ruta: la salida va a un temporal que se renombra al terminar,
+// así que la entrada no se trunca antes de leerla
+TEST(ImageSoaTest, StreamingOverItsOwnInput) {
+    const std::string inputFile = "../../../archivos_entrada/sabatini.ppm";
+    const std::string inPlaceFile = "soa_stream_inplace.ppm";
+    const std::string inMemoryFile = "soa_stream_inplace_memory.ppm";
+    constexpr std::size_t STRIP_BUDGET = 4096;
+    const std::vector<uint8_t> original = BinaryIO::readBinaryFile(inputFile);
+
+    Image escalada;
+    ASSERT_NO_THROW(escalada.loadPPM(inputFile));
+    escalada.scaleIntensity(100.0F);
+    ASSERT_NO_THROW(escalada.savePPM(inMemoryFile));
+    BinaryIO::writeBinaryFile(inPlaceFile, original);
+    ASSERT_NO_THROW(Image::scaleIntensityStreaming(inPlaceFile, inPlaceFile, 100.0F, STRIP_BUDGET));
+    EXPECT_EQ(BinaryIO::readBinaryFile(inPlaceFile), BinaryIO::readBinaryFile(inMemoryFile));
+
+    Image reducida;
+    ASSERT_NO_THROW(reducida.loadPPM(inputFile));
+    reducida.resize(20, 10);
+    ASSERT_NO_THROW(reducida.savePPM(inMemoryFile));
+    BinaryIO::writeBinaryFile(inPlaceFile, original);
+    ASSERT_NO_THROW(Image::resizeStreaming(inPlaceFile, inPlaceFile, 20, 10, STRIP_BUDGET));
+    EXPECT_EQ(BinaryIO::readBinaryFile(inPlaceFile), BinaryIO::readBinaryFile(inMemoryFile));
+
+    if (std::remove(inPlaceFile.c_str()) != 0 || std::remove(inMemoryFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de salida";
+    }
+}
+
+// Un P5 se carga en un solo plano y cada operación da lo mismo que con el P6 equivalente
+TEST(ImageSoaTest, GrayscaleMatchesEquivalentColorImage) {
+    const std::string grayFile = "gray.pgm";
+    const std::string colorFile = "gray_as_color.ppm";
+    const std::string outputFile = "gray_output.pgm";
+    constexpr int WIDTH = 45;
+    constexpr int HEIGHT = 23;
+
+    const std::string dimensiones = std::to_string(WIDTH) + " " + std::to_string(HEIGHT) + "\n255\n";
+    const std::string cabeceraGris = "P5\n" + dimensiones;
+    const std::string cabeceraColor = "P6\n" + dimensiones;
+    std::vector<uint8_t> gris(cabeceraGris.begin(), cabeceraGris.end());
+    std::vector<uint8_t> color(cabeceraColor.begin(), cabeceraColor.end());
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        const auto nivel = static_cast<uint8_t>((i * 11) % 251);
+        gris.push_back(nivel);
+        color.insert(color.end(), 3, nivel);
+    }
+    BinaryIO::writeBinaryFile(grayFile, gris);
+    BinaryIO::writeBinaryFile(colorFile, color);
+
+    Image imagenGris;
+    Image imagenColor;
+    ASSERT_NO_THROW(imagenGris.loadPPM(grayFile));
+    ASSERT_NO_THROW(imagenColor.loadPPM(colorFile));
+    EXPECT_TRUE(imagenGris.grayscale);
+    EXPECT_TRUE(imagenGris.red.empty());
+    ASSERT_NO_THROW(imagenGris.savePPM(outputFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), gris);
+
+    imagenGris.scaleIntensity(1000.0F);
+    imagenColor.scaleIntensity(1000.0F);
+    imagenGris.resize(60, 17);
+    imagenColor.resize(60, 17);
+    EXPECT_EQ(imagenGris.gray, imagenColor.red);
+    EXPECT_EQ(imagenGris.gray, imagenColor.blue);
+
+    if (std::remove(grayFile.c_str()) != 0 || std::remove(colorFile.c_str()) != 0 ||
+        std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Una muestra mayor que maxval se rechaza al cargar: cutfreq y compress indexan por nivel
+TEST(ImageSoaTest, RejectsSamplesAboveMaxval) {
+    const std::string inputFile = "gray_out_of_range.pgm";
+    const std::string cabecera = "P5\n3 1\n10\n";
+    std::vector<uint8_t> contenido(cabecera.begin(), cabecera.end());
+    contenido.insert(contenido.end(), {0, 200, 10});
+    BinaryIO::writeBinaryFile(inputFile, contenido);
+
+    Image image;
+    EXPECT_THROW(image.loadPPM(inputFile), std::runtime_error);
+
+    if (std::remove(inputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar el archivo de prueba";
+    }
+}
+
+// PPM -> caché planar -> PPM debe dar el mismo archivo, en 8 y 16 bits
+TEST(ImageSoaTest, PlanarCacheRoundTrip) {
+    const std::string cacheFile = "soa_cache.planar";
+    const std::string outputFile = "soa_planar.ppm";
+    constexpr int WIDTH = 13;
+    constexpr int HEIGHT = 9;
+
+    for (const int maxval : {255, 4095}) {
+        const std::string cabecera = "P6\n" + std::to_string(WIDTH) + " " + std::to_string(HEIGHT) + "\n" + std::to_string(maxval) + "\n";
+        std::vector<uint8_t> ppm(cabecera.begin(), cabecera.end());
+        for (int i = 0; i < WIDTH * HEIGHT * 3; ++i) {
+            const int valor = (i * 97) % (maxval + 1);
+            if (maxval > 255) {
+                ppm.push_back(static_cast<uint8_t>(valor >> 8));
+            }
+            ppm.push_back(static_cast<uint8_t>(valor));
+        }
+        BinaryIO::writeBinaryFile(outputFile, ppm);
+
+        Image original;
+        ASSERT_NO_THROW(original.loadPPM(outputFile));
+        ASSERT_NO_THROW(original.savePlanar(cacheFile));
+
+        Image cargada;
+        ASSERT_NO_THROW(cargada.loadPPM(cacheFile));
+        EXPECT_EQ(cargada.maxColorValue, maxval);
+        EXPECT_EQ(cargada.red, original.red);
+        EXPECT_EQ(cargada.blue, original.blue);
+        ASSERT_NO_THROW(cargada.savePPM(outputFile));
+        EXPECT_EQ(BinaryIO::readBinaryFile(outputFile), ppm);
+    }
+
+    if (std::remove(cacheFile.c_str()) != 0 || std::remove(outputFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
 // Prueba de redimensionamiento de la imagen
 TEST(ImageSoaTest, ResizeImage) {
     Image image;
@@ -75,6 +276,55 @@ TEST(ImageSoaTest, ResizeImage) {
     EXPECT_EQ(image.height, originalHeight / 2);
 }
 
+// Cada nivel de la pirámide es la media de bloques 2x2; con tamaño impar el último bloque
+// solo tiene los píxeles que quedan dentro y el tamaño se redondea hacia arriba
+TEST(ImageSoaTest, ReduceBlocksAveragesEdges) {
+    Image image;
+    image.width = 5;
+    image.height = 3;
+    image.maxColorValue = 255;
+    image.grayscale = true;
+    image.gray = {0, 10, 20, 30, 40,
+                  1, 11, 21, 31, 41,
+                  7, 8, 9, 10, 200};
+    image.reducirBloques(2, 2);
+    EXPECT_EQ(image.width, 3);
+    EXPECT_EQ(image.height, 2);
+    EXPECT_EQ(image.gray, (std::vector<uint16_t>{6, 26, 41, 8, 10, 200}));
+
+    // La reducción por área con factores enteros es la misma media de bloques
+    Image color;
+    color.width = 4;
+    color.height = 2;
+    color.maxColorValue = 65535;
+    color.red = {0, 65535, 2, 3, 4, 5, 6, 7};
+    color.green = color.red;
+    color.blue = color.red;
+    color.resize(2, 1, ResizeFilter::area);
+    EXPECT_EQ(color.red, (std::vector<uint16_t>{16386, 5}));
+    EXPECT_EQ(color.blue, color.red);
+}
+
+// redimensionada() da lo mismo que resize() sin modificar el origen
+TEST(ImageSoaTest, RedimensionadaKeepsSource) {
+    Image image;
+    image.width = 4;
+    image.height = 4;
+    image.maxColorValue = 255;
+    image.grayscale = true;
+    image.gray = {0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110, 120, 130, 140, 255};
+    const Image original = image;
+
+    const Image mitad = image.redimensionada(2, 2, ResizeFilter::area);
+    EXPECT_EQ(image.gray, original.gray);
+    EXPECT_EQ(mitad.width, 2);
+    EXPECT_TRUE(mitad.grayscale);
+    EXPECT_EQ(mitad.gray, (std::vector<uint16_t>{25, 45, 105, 151}));
+
+    image.resize(3, 3);
+    EXPECT_EQ(original.redimensionada(3, 3).gray, image.gray);
+}
+
 // Prueba de eliminación de colores poco frecuentes
 TEST(ImageSoaTest, RemoveRareColors) {
     Image image;
@@ -102,6 +352,66 @@ TEST(ImageSoaTest, CompressImage) {
     }
 }
 
+// compress y loadCPPM deben ser inversos; con más de 256 colores los índices son de 2 bytes
+TEST(ImageSoaTest, DecompressRestoresCompressedImage) {
+    const std::string inputFile = "soa_cppm.ppm";
+    const std::string compressedFile = "soa_cppm.cppm";
+    constexpr int WIDTH = 40;
+    constexpr int HEIGHT = 30;
+
+    const std::string cabecera = "P6\n" + std::to_string(WIDTH) + " " + std::to_string(HEIGHT) + "\n255\n";
+    std::vector<uint8_t> ppm(cabecera.begin(), cabecera.end());
+    for (int i = 0; i < WIDTH * HEIGHT; ++i) {
+        ppm.insert(ppm.end(), {static_cast<uint8_t>(i % 251), static_cast<uint8_t>(i / 7), static_cast<uint8_t>(i % 3)});
+    }
+    BinaryIO::writeBinaryFile(inputFile, ppm);
+
+    Image original;
+    ASSERT_NO_THROW(original.loadPPM(inputFile));
+    ASSERT_NO_THROW(original.compress(compressedFile));
+
+    Image expandida;
+    ASSERT_NO_THROW(expandida.loadCPPM(compressedFile));
+    EXPECT_EQ(expandida.width, WIDTH);
+    EXPECT_EQ(expandida.red, original.red);
+    EXPECT_EQ(expandida.green, original.green);
+    EXPECT_EQ(expandida.blue, original.blue);
+    EXPECT_THROW(expandida.loadCPPM(inputFile), std::runtime_error);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
+// Con 16 bits la tabla guarda las muestras completas: (0, 256, 0) y (1, 0, 0) no se
+// confunden y el archivo es idéntico al de compressMapped
+TEST(ImageSoaTest, CompressMatchesMappedWith16BitColors) {
+    const std::string inputFile = "soa_cppm16.ppm";
+    const std::string compressedFile = "soa_cppm16.cppm";
+    const std::string mappedFile = "soa_cppm16_mapped.cppm";
+    const std::string cabecera = "P6\n3 1\n65535\n";
+    std::vector<uint8_t> ppm(cabecera.begin(), cabecera.end());
+    ppm.insert(ppm.end(), {0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0});
+    BinaryIO::writeBinaryFile(inputFile, ppm);
+
+    Image original;
+    ASSERT_NO_THROW(original.loadPPM(inputFile));
+    ASSERT_NO_THROW(original.compress(compressedFile));
+    ASSERT_NO_THROW(compressMapped(inputFile, mappedFile));
+    EXPECT_EQ(BinaryIO::readBinaryFile(compressedFile), BinaryIO::readBinaryFile(mappedFile));
+
+    Image expandida;
+    ASSERT_NO_THROW(expandida.loadCPPM(compressedFile));
+    EXPECT_EQ(expandida.red, original.red);
+    EXPECT_EQ(expandida.green, original.green);
+    EXPECT_EQ(expandida.blue, original.blue);
+
+    if (std::remove(inputFile.c_str()) != 0 || std::remove(compressedFile.c_str()) != 0 ||
+        std::remove(mappedFile.c_str()) != 0) {
+        FAIL() << "Error al eliminar los archivos de prueba";
+    }
+}
+
 // Prueba de cálculo de histograma de colores usando el nuevo método de prueba
 TEST(ImageSoaTest, CalculateHistogram) {
     Image image;